@@ -28,6 +28,30 @@ inline QUrl websocketUrl() {
     return api;
 }
 
+namespace detail {
+inline qint64 megabytesFromEnv(const char* name, qint64 fallbackMb) {
+    bool ok = false;
+    const qint64 mb = qgetenv(name).toLongLong(&ok);
+    return (ok && mb > 0 ? mb : fallbackMb) * 1024 * 1024;
+}
+} // namespace detail
+
+// Decoded pixmaps kept in memory by MediaCache.
+inline qint64 mediaMemoryBudgetBytes() {
+    return detail::megabytesFromEnv("NOVEO_MEDIA_MEMORY_MB", 96);
+}
+
+// Original media bytes kept under CacheLocation/media by MediaCache.
+inline qint64 mediaDiskBudgetBytes() {
+    return detail::megabytesFromEnv("NOVEO_MEDIA_DISK_MB", 512);
+}
+
+// NOVEO_TRACE=<file> writes Chrome trace-event JSON there on exit, in
+// builds configured with NOVEO_ENABLE_TRACING.
+inline QString traceOutputPath() {
+    return QString::fromLocal8Bit(qgetenv("NOVEO_TRACE"));
+}
+
 } // namespace AppConfig
 
 #endif // APPCONFIG_H
@@ -0,0 +1,424 @@
+#include "ChatStore.h"
+
+#include "AppConfig.h"
+#include "WebSocketClient.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+QString absoluteFileUrl(const QString& rawUrl)
+{
+    if (rawUrl.isEmpty() || rawUrl.startsWith(QStringLiteral("http://")) || rawUrl.startsWith(QStringLiteral("https://"))) {
+        return rawUrl;
+    }
+    const QString base = AppConfig::apiBaseUrl();
+    return rawUrl.startsWith(QLatin1Char('/')) ? base + rawUrl : base + QLatin1Char('/') + rawUrl;
+}
+}
+
+ChatStore::ChatStore(QObject* parent)
+    : QObject(parent)
+{
+}
+
+void ChatStore::attach(WebSocketClient* client)
+{
+    m_client = client;
+    connect(client, &WebSocketClient::userListUpdated, this, &ChatStore::setUsers);
+    connect(client, &WebSocketClient::userUpdated, this, &ChatStore::updateUser);
+    connect(client, &WebSocketClient::messageReceived, this, &ChatStore::applyMessage);
+    connect(client, &WebSocketClient::messageSeenUpdate, this, &ChatStore::applySeen);
+    connect(client, &WebSocketClient::messageUpdated, this, &ChatStore::applyEdit);
+    connect(client, &WebSocketClient::messageDeleted, this, &ChatStore::applyDelete);
+    connect(client, &WebSocketClient::presenceUpdated, this, &ChatStore::applyPresence);
+}
+
+QString ChatStore::currentUserId() const
+{
+    return m_client ? m_client->currentUserId() : QString();
+}
+
+const Chat& ChatStore::chat(const QString& chatId) const
+{
+    static const Chat empty;
+    const auto it = m_chats.constFind(chatId);
+    return it != m_chats.constEnd() ? *it : empty;
+}
+
+const User& ChatStore::user(const QString& userId) const
+{
+    static const User empty;
+    const auto it = m_users.constFind(userId);
+    return it != m_users.constEnd() ? *it : empty;
+}
+
+void ChatStore::clear()
+{
+    m_chats.clear();
+    m_users.clear();
+    m_pendingMessages.clear();
+    m_pendingIdByClientMessageId.clear();
+}
+
+void ChatStore::trackPending(const Message& pending)
+{
+    m_pendingMessages.insert(pending.messageId, pending);
+    if (!pending.clientMessageId.isEmpty()) {
+        m_pendingIdByClientMessageId.insert(pending.clientMessageId, pending.messageId);
+    }
+}
+
+MessageStatus ChatStore::messageStatus(const Message& msg, const Chat& chat) const
+{
+    const QString me = currentUserId();
+    if (msg.senderId != me) {
+        return MessageStatus::Sent;
+    }
+    if (msg.messageId.startsWith(QStringLiteral("temp_"))) {
+        return MessageStatus::Pending;
+    }
+    for (const QString& memberId : chat.members) {
+        if (memberId != me && msg.seenBy.contains(memberId)) {
+            return MessageStatus::Seen;
+        }
+    }
+    return MessageStatus::Sent;
+}
+
+ChatStore::HistoryResult ChatStore::applyHistory(const std::vector<Chat>& incoming, bool reconcile)
+{
+    HistoryResult result;
+    result.initialLoad = m_chats.isEmpty() || reconcile;
+
+    if (reconcile) {
+        QSet<QString> serverChatIds;
+        for (const Chat& inChat : incoming) {
+            serverChatIds.insert(inChat.chatId);
+        }
+        for (auto it = m_chats.begin(); it != m_chats.end();) {
+            if (serverChatIds.contains(it.key())) {
+                ++it;
+            } else {
+                it = m_chats.erase(it);
+            }
+        }
+    }
+
+    for (const Chat& inChat : incoming) {
+        auto it = m_chats.find(inChat.chatId);
+        if (it == m_chats.end()) {
+            m_chats.insert(inChat.chatId, inChat);
+        } else if (reconcile) {
+            // The server copy is authoritative over the span it covers: a
+            // disk row inside it that the server lacks was deleted while we
+            // were away. Rows older than the page it sent are kept.
+            qint64 oldestServer = std::numeric_limits<qint64>::min();
+            if (!inChat.messages.empty()) {
+                oldestServer = std::min_element(inChat.messages.begin(), inChat.messages.end(), [](const Message& a, const Message& b) {
+                    return a.timestamp < b.timestamp;
+                })->timestamp;
+            }
+            Chat merged = inChat;
+            std::vector<Message> localOnly;
+            QStringList pruned;
+            for (const Message& m : it->messages) {
+                if (merged.findMessage(m.messageId)) {
+                    continue;
+                }
+                if (m.timestamp <= oldestServer) {
+                    localOnly.push_back(m);
+                } else {
+                    pruned.push_back(m.messageId);
+                }
+            }
+            if (!pruned.isEmpty()) {
+                result.prunedMessageIds.insert(inChat.chatId, pruned);
+            }
+            merged.mergeMessages(localOnly);
+            *it = std::move(merged);
+            result.reconciledChatIds.insert(inChat.chatId);
+        } else {
+            std::vector<Message> added;
+            if (it->mergeMessages(inChat.messages, &added) >= 0) {
+                result.addedMessages.insert(inChat.chatId, std::move(added));
+            }
+        }
+    }
+    return result;
+}
+
+QStringList ChatStore::applyBatch(const std::vector<Chat>& batch)
+{
+    QStringList added;
+    for (const Chat& chat : batch) {
+        auto it = m_chats.find(chat.chatId);
+        if (it != m_chats.end()) {
+            // Announced separately (new_chat_info) while the history streamed in.
+            it->mergeMessages(chat.messages);
+            continue;
+        }
+        m_chats.insert(chat.chatId, chat);
+        added.push_back(chat.chatId);
+    }
+    return added;
+}
+
+ChatStore::DeltaResult ChatStore::applyDelta(const Chat& delta)
+{
+    DeltaResult result;
+    auto it = m_chats.find(delta.chatId);
+    if (it == m_chats.end()) {
+        m_chats.insert(delta.chatId, delta);
+        result.created = true;
+        return result;
+    }
+
+    Chat& chat = *it;
+    if (!delta.chatType.isEmpty()) {
+        chat.chatName = delta.chatName;
+        chat.chatType = delta.chatType;
+        chat.handle = delta.handle;
+        chat.members = delta.members;
+        chat.ownerId = delta.ownerId;
+        chat.avatarUrl = delta.avatarUrl;
+        chat.isVerified = delta.isVerified;
+        chat.hasPinnedMessage = delta.hasPinnedMessage;
+        chat.pinnedMessage = delta.pinnedMessage;
+    }
+    result.previousSize = static_cast<int>(chat.messages.size());
+    result.firstAdded = chat.mergeMessages(delta.messages);
+    return result;
+}
+
+bool ChatStore::addChat(const Chat& chat)
+{
+    if (m_chats.contains(chat.chatId)) {
+        return false;
+    }
+    m_chats.insert(chat.chatId, chat);
+    return true;
+}
+
+void ChatStore::replaceChat(const Chat& chat)
+{
+    m_chats.insert(chat.chatId, chat);
+}
+
+bool ChatStore::removeChat(const QString& chatId)
+{
+    return m_chats.remove(chatId) > 0;
+}
+
+bool ChatStore::setMembers(const QString& chatId, const QStringList& members)
+{
+    auto it = m_chats.find(chatId);
+    if (it == m_chats.end()) {
+        return false;
+    }
+    it->members = members;
+    return true;
+}
+
+bool ChatStore::setPinnedMessage(const QString& chatId, const Message& message)
+{
+    auto it = m_chats.find(chatId);
+    if (it == m_chats.end()) {
+        return false;
+    }
+    it->hasPinnedMessage = true;
+    it->pinnedMessage = message;
+    return true;
+}
+
+bool ChatStore::clearPinnedMessage(const QString& chatId)
+{
+    auto it = m_chats.find(chatId);
+    if (it == m_chats.end()) {
+        return false;
+    }
+    it->hasPinnedMessage = false;
+    return true;
+}
+
+bool ChatStore::clearHandle(const QString& chatId)
+{
+    auto it = m_chats.find(chatId);
+    if (it == m_chats.end()) {
+        return false;
+    }
+    it->handle.clear();
+    return true;
+}
+
+QStringList ChatStore::markChatSeen(const QString& chatId)
+{
+    QStringList newlySeen;
+    auto it = m_chats.find(chatId);
+    if (it == m_chats.end()) {
+        return newlySeen;
+    }
+    // Seen marks only ever advance, so everything before the newest message
+    // this user already saw was seen too: the walk stops there.
+    const QString me = currentUserId();
+    for (auto msg = it->messages.rbegin(); msg != it->messages.rend(); ++msg) {
+        if (msg->senderId == me) {
+            continue;
+        }
+        if (msg->seenBy.contains(me)) {
+            break;
+        }
+        msg->seenBy.append(me);
+        newlySeen.prepend(msg->messageId);
+    }
+    return newlySeen;
+}
+
+void ChatStore::upsertMessage(const QString& chatId, const Message& msg)
+{
+    auto it = m_chats.find(chatId);
+    if (it != m_chats.end()) {
+        it->upsertMessage(msg);
+    }
+}
+
+void ChatStore::setUsers(const std::vector<User>& users)
+{
+    m_users.clear();
+    for (const User& user : users) {
+        m_users.insert(user.userId, user);
+    }
+    emit usersReset();
+}
+
+void ChatStore::setBlockGroupInvites(const QString& userId, bool blocked)
+{
+    auto it = m_users.find(userId);
+    if (it != m_users.end()) {
+        it->blockGroupInvites = blocked;
+    }
+}
+
+void ChatStore::updateUser(const User& user)
+{
+    if (user.userId.isEmpty()) {
+        return;
+    }
+    const auto it = m_users.constFind(user.userId);
+    const bool profileChanged = (it == m_users.constEnd() || it->username != user.username || it->avatarUrl != user.avatarUrl);
+    m_users.insert(user.userId, user);
+    emit userChanged(user, profileChanged);
+}
+
+void ChatStore::applyMessage(const Message& msg)
+{
+    rememberSender(msg);
+
+    QString pendingId;
+    if (msg.senderId == currentUserId()) {
+        pendingId = takePending(msg);
+    }
+    auto it = m_chats.find(msg.chatId);
+    if (it != m_chats.end()) {
+        it->upsertMessage(msg);
+    }
+    emit messageAdded(msg, pendingId);
+}
+
+void ChatStore::applySeen(const QString& chatId, const QString& messageId, const QString& userId)
+{
+    auto it = m_chats.find(chatId);
+    if (it == m_chats.end()) {
+        return;
+    }
+    Message* msg = it->findMessage(messageId);
+    if (!msg) {
+        return;
+    }
+    if (!msg->seenBy.contains(userId)) {
+        msg->seenBy.append(userId);
+    }
+    msg->status = messageStatus(*msg, *it);
+    emit messageStatusChanged(chatId, messageId, msg->status);
+}
+
+void ChatStore::applyEdit(const QString& chatId, const QString& messageId, const QString& newContent, qint64 editedAt)
+{
+    auto it = m_chats.find(chatId);
+    if (it != m_chats.end()) {
+        if (Message* msg = it->findMessage(messageId)) {
+            msg->text = newContent;
+            msg->editedAt = editedAt;
+        }
+    }
+    emit messageEdited(chatId, messageId, newContent, editedAt);
+}
+
+void ChatStore::applyDelete(const QString& chatId, const QString& messageId)
+{
+    auto it = m_chats.find(chatId);
+    if (it != m_chats.end()) {
+        it->removeMessage(messageId);
+        if (it->hasPinnedMessage && it->pinnedMessage.messageId == messageId) {
+            it->hasPinnedMessage = false;
+        }
+    }
+    emit messageRemoved(chatId, messageId);
+}
+
+void ChatStore::applyPresence(const QString& userId, bool online)
+{
+    auto it = m_users.find(userId);
+    if (it != m_users.end()) {
+        it->online = online;
+    }
+}
+
+// Fills in what the directory does not know yet about a sender from the
+// fields the message carries.
+void ChatStore::rememberSender(const Message& msg)
+{
+    if (msg.senderId.isEmpty()) {
+        return;
+    }
+    User sender = m_users.value(msg.senderId);
+    bool changed = false;
+    if (sender.userId.isEmpty()) {
+        sender.userId = msg.senderId;
+        changed = true;
+    }
+    if (sender.username.trimmed().isEmpty() && !msg.senderName.trimmed().isEmpty()) {
+        sender.username = msg.senderName.trimmed();
+        changed = true;
+    }
+    if (sender.avatarUrl.trimmed().isEmpty() && !msg.senderAvatarUrl.trimmed().isEmpty()) {
+        sender.avatarUrl = msg.senderAvatarUrl.trimmed();
+        changed = true;
+    }
+    if (changed) {
+        m_users.insert(sender.userId, sender);
+    }
+}
+
+QString ChatStore::takePending(const Message& echo)
+{
+    QString pendingId;
+    if (!echo.clientMessageId.isEmpty()) {
+        pendingId = m_pendingIdByClientMessageId.take(echo.clientMessageId);
+    } else {
+        // Servers that do not echo the key: fall back to matching content.
+        for (auto it = m_pendingMessages.constBegin(); it != m_pendingMessages.constEnd(); ++it) {
+            const bool sameChat = (it.value().chatId == echo.chatId);
+            const bool sameText = (it.value().text == echo.text && it.value().replyToId == echo.replyToId);
+            const bool sameFile = !it.value().file.isNull() && !echo.file.isNull() &&
+                                  (absoluteFileUrl(it.value().file.url) == absoluteFileUrl(echo.file.url));
+            if (sameChat && (sameFile || sameText)) {
+                pendingId = it.key();
+                m_pendingIdByClientMessageId.remove(it.value().clientMessageId);
+                break;
+            }
+        }
+    }
+    m_pendingMessages.remove(pendingId);
+    return pendingId;
+}
@@ -0,0 +1,115 @@
+#ifndef CHATSTORE_H
+#define CHATSTORE_H
+
+#include <QHash>
+#include <QMap>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include <vector>
+
+#include "DataStructures.h"
+
+class WebSocketClient;
+
+// Chats, users and unconfirmed sends for the signed-in account. Every change
+// to them goes through this class: live server events are applied here and
+// announced through the signals below, and history snapshots, deltas and
+// REST results are applied through the methods, which report what changed so
+// the window (or a headless client) can update its own views.
+class ChatStore : public QObject
+{
+    Q_OBJECT
+public:
+    // What applyHistory() changed.
+    struct HistoryResult {
+        // Nothing was held before, or a local preload was replaced.
+        bool initialLoad = false;
+        QSet<QString> reconciledChatIds;
+        // Disk messages the reconcile dropped, per chat.
+        QHash<QString, QStringList> prunedMessageIds;
+        // Messages an older page added to chats already held, in timestamp order.
+        QHash<QString, std::vector<Message>> addedMessages;
+    };
+
+    // What applyDelta() changed.
+    struct DeltaResult {
+        bool created = false;
+        int previousSize = 0;
+        // Position of the first added message, or -1 if nothing was added.
+        int firstAdded = -1;
+    };
+
+    explicit ChatStore(QObject* parent = nullptr);
+
+    void attach(WebSocketClient* client);
+    QString currentUserId() const;
+
+    const QMap<QString, Chat>& chats() const { return m_chats; }
+    const QMap<QString, User>& users() const { return m_users; }
+    // An empty Chat / User when the id is unknown.
+    const Chat& chat(const QString& chatId) const;
+    const User& user(const QString& userId) const;
+    int pendingCount() const { return m_pendingMessages.size(); }
+
+    void clear();
+
+    // Remembers an optimistic bubble until its echo confirms it.
+    void trackPending(const Message& pending);
+    MessageStatus messageStatus(const Message& msg, const Chat& chat) const;
+
+    // A full chat list. With reconcile set the held chats came from the local
+    // store and the list is authoritative: chats it no longer names are
+    // dropped, the server copies replace the disk ones, and disk messages
+    // within the span the server sent but missing from it are pruned.
+    HistoryResult applyHistory(const std::vector<Chat>& incoming, bool reconcile);
+    // One batch of a streamed history; returns the ids it added, in order.
+    QStringList applyBatch(const std::vector<Chat>& batch);
+    DeltaResult applyDelta(const Chat& delta);
+    // Returns false when the chat is already held.
+    bool addChat(const Chat& chat);
+    void replaceChat(const Chat& chat);
+    bool removeChat(const QString& chatId);
+    bool setMembers(const QString& chatId, const QStringList& members);
+    bool setPinnedMessage(const QString& chatId, const Message& message);
+    bool clearPinnedMessage(const QString& chatId);
+    bool clearHandle(const QString& chatId);
+    // Marks the messages from others newer than the last one the current
+    // user saw as seen; returns their ids, oldest first. Costs the unread
+    // count, not the history length.
+    QStringList markChatSeen(const QString& chatId);
+    // Files a message into a chat without announcing it.
+    void upsertMessage(const QString& chatId, const Message& msg);
+
+    void setUsers(const std::vector<User>& users);
+    void setBlockGroupInvites(const QString& userId, bool blocked);
+    void updateUser(const User& user);
+    void applyMessage(const Message& msg);
+    void applySeen(const QString& chatId, const QString& messageId, const QString& userId);
+    void applyEdit(const QString& chatId, const QString& messageId, const QString& newContent, qint64 editedAt);
+    void applyDelete(const QString& chatId, const QString& messageId);
+    void applyPresence(const QString& userId, bool online);
+
+signals:
+    void usersReset();
+    void userChanged(const User& user, bool profileChanged);
+    // pendingId names the optimistic message this one confirms, if any.
+    void messageAdded(const Message& msg, const QString& pendingId);
+    void messageStatusChanged(const QString& chatId, const QString& messageId, MessageStatus status);
+    void messageEdited(const QString& chatId, const QString& messageId, const QString& newContent, qint64 editedAt);
+    void messageRemoved(const QString& chatId, const QString& messageId);
+
+private:
+    void rememberSender(const Message& msg);
+    QString takePending(const Message& echo);
+
+    WebSocketClient* m_client = nullptr;
+    QMap<QString, User> m_users;
+    QMap<QString, Chat> m_chats;
+    QMap<QString, Message> m_pendingMessages;
+    QHash<QString, QString> m_pendingIdByClientMessageId;
+};
+
+#endif // CHATSTORE_H
@@ -1,12 +1,15 @@
 #ifndef DATASTRUCTURES_H
 #define DATASTRUCTURES_H
 
+#include <QHash>
 #include <QMap>
+#include <QMetaType>
 #include <QJsonObject>
 #include <QJsonValue>
 #include <QString>
 #include <QStringList>
 
+#include <algorithm>
 #include <vector>
 
 // Message delivery status
@@ -53,8 +56,7 @@ struct Message {
     QString text;
     qint64 timestamp = 0;
 
-    // Keep raw content payload for forward compatibility with server updates.
-    QString rawContent;
+    // Normalized once by the parser; render paths read these directly.
     FileAttachment file;
     QString theme;
     ForwardedInfo forwardedInfo;
@@ -64,6 +66,9 @@ struct Message {
     qint64 editedAt = 0;
     QString replyToId;
     bool pending = false;
+    // Idempotency key of the send that produced this message, when the
+    // server echoes it back.
+    QString clientMessageId;
 };
 
 struct Chat {
@@ -80,8 +85,114 @@ struct Chat {
     qint64 createdAt = 0;
     bool hasPinnedMessage = false;
     Message pinnedMessage;
+
+    // messageId -> position in messages. Mutate messages through the helpers
+    // below (or call reindexMessages() after bulk edits) to keep it in sync.
+    QHash<QString, int> messageIndex;
+
+    Message* findMessage(const QString& messageId) {
+        const int pos = messageIndex.value(messageId, -1);
+        return pos >= 0 ? &messages[static_cast<size_t>(pos)] : nullptr;
+    }
+
+    const Message* findMessage(const QString& messageId) const {
+        const int pos = messageIndex.value(messageId, -1);
+        return pos >= 0 ? &messages[static_cast<size_t>(pos)] : nullptr;
+    }
+
+    // Appends, or replaces in place when the id is already present.
+    void upsertMessage(const Message& message) {
+        if (Message* existing = findMessage(message.messageId)) {
+            *existing = message;
+            return;
+        }
+        messageIndex.insert(message.messageId, static_cast<int>(messages.size()));
+        messages.push_back(message);
+    }
+
+    bool removeMessage(const QString& messageId) {
+        const int pos = messageIndex.value(messageId, -1);
+        if (pos < 0) {
+            return false;
+        }
+        messages.erase(messages.begin() + pos);
+        messageIndex.remove(messageId);
+        reindexMessages(pos);
+        return true;
+    }
+
+    // Merges a batch into the timestamp-ordered messages: a reconnect delta,
+    // an older history page, or anything in between. Known ids are replaced
+    // in place (deduplicated through messageIndex); new ones are sorted among
+    // themselves, appended, and merged into place with a binary-searched
+    // start and std::inplace_merge, so no pass ever re-sorts the whole chat.
+    // Newly added messages are copied to *added in timestamp order. Returns
+    // the position of the first added message, or -1 if nothing was added.
+    int mergeMessages(const std::vector<Message>& incoming, std::vector<Message>* added = nullptr) {
+        const auto byTimestamp = [](const Message& a, const Message& b) { return a.timestamp < b.timestamp; };
+        const size_t oldSize = messages.size();
+        for (const Message& message : incoming) {
+            if (Message* existing = findMessage(message.messageId)) {
+                *existing = message;
+                continue;
+            }
+            messageIndex.insert(message.messageId, static_cast<int>(messages.size()));
+            messages.push_back(message);
+        }
+        if (messages.size() == oldSize) {
+            return -1;
+        }
+
+        const auto middle = messages.begin() + static_cast<std::ptrdiff_t>(oldSize);
+        const bool batchSorted = std::is_sorted(middle, messages.end(), byTimestamp);
+        if (!batchSorted) {
+            std::stable_sort(middle, messages.end(), byTimestamp);
+        }
+        if (added) {
+            added->assign(middle, messages.end());
+        }
+        if (oldSize == 0 || !byTimestamp(*middle, *(middle - 1))) {
+            // Pure append; only a reordered batch moved indexed positions.
+            if (!batchSorted) {
+                reindexMessages(static_cast<int>(oldSize));
+            }
+            return static_cast<int>(oldSize);
+        }
+
+        const auto first = std::upper_bound(messages.begin(), middle, *middle, byTimestamp);
+        std::inplace_merge(first, middle, messages.end(), byTimestamp);
+        const int firstChanged = static_cast<int>(first - messages.begin());
+        reindexMessages(firstChanged);
+        return firstChanged;
+    }
+
+    // Timestamp of the newest message held; the resume point for delta sync.
+    // Timestamps are whole seconds, so the server answers inclusively (>=)
+    // and the messages already held come back again; mergeMessages drops
+    // them through messageIndex. An exclusive cursor would lose any message
+    // that shared the newest second.
+    qint64 syncCursor() const {
+        return messages.empty() ? 0 : messages.back().timestamp;
+    }
+
+    void reindexMessages(int fromPos = 0) {
+        if (fromPos <= 0) {
+            messageIndex.clear();
+            messageIndex.reserve(static_cast<int>(messages.size()));
+        }
+        for (int i = qMax(0, fromPos); i < static_cast<int>(messages.size()); ++i) {
+            messageIndex.insert(messages[static_cast<size_t>(i)].messageId, i);
+        }
+    }
 };
 
 using VoiceChatParticipants = QMap<QString, QStringList>;
 
+// Carried across the network thread boundary by queued signals.
+Q_DECLARE_METATYPE(User)
+Q_DECLARE_METATYPE(Message)
+Q_DECLARE_METATYPE(Chat)
+Q_DECLARE_METATYPE(std::vector<User>)
+Q_DECLARE_METATYPE(std::vector<Chat>)
+
 #endif // DATASTRUCTURES_H
@@ -0,0 +1,282 @@
+#include "ImagePipeline.h"
+
+#include "MediaCache.h"
+#include "Trace.h"
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QFile>
+#include <QImageReader>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QPainter>
+#include <QPainterPath>
+#include <QThreadPool>
+
+ImagePipeline::ImagePipeline(QObject* parent)
+    : QObject(parent),
+      m_nam(new QNetworkAccessManager(this))
+{
+}
+
+ImagePipeline* ImagePipeline::instance()
+{
+    static QPointer<ImagePipeline> pipeline;
+    if (!pipeline) {
+        pipeline = new ImagePipeline(qApp);
+    }
+    return pipeline;
+}
+
+QString ImagePipeline::jobKey(const QUrl& url, const QSize& targetSize, Shape shape)
+{
+    return QStringLiteral("%1|%2x%3|%4")
+        .arg(url.toString())
+        .arg(targetSize.width())
+        .arg(targetSize.height())
+        .arg(static_cast<int>(shape));
+}
+
+bool ImagePipeline::cachedPixmap(const QUrl& url, const QSize& targetSize, Shape shape, QPixmap* out) const
+{
+    return MediaCache::instance()->findPixmap(jobKey(url, targetSize, shape), out);
+}
+
+void ImagePipeline::load(const QUrl& url, const QSize& targetSize, Shape shape, QObject* receiver, Callback callback)
+{
+    if (!receiver || !callback) {
+        return;
+    }
+    if (!url.isValid()) {
+        callback(QPixmap());
+        return;
+    }
+
+    const QString key = jobKey(url, targetSize, shape);
+    QPixmap cached;
+    if (MediaCache::instance()->peekPixmap(key, &cached)) {
+        callback(cached);
+        return;
+    }
+
+    const bool started = m_jobs.contains(key);
+    Job& job = m_jobs[key];
+
+    Waiter waiter;
+    waiter.id = m_nextWaiterId++;
+    waiter.receiver = receiver;
+    waiter.callback = std::move(callback);
+    waiter.destroyedConnection = connect(receiver, &QObject::destroyed, this, [this, key, id = waiter.id]() {
+        dropWaiter(key, id);
+    });
+    job.waiters.append(waiter);
+    if (started) {
+        return;
+    }
+
+    job.url = url;
+    job.targetSize = targetSize;
+    job.shape = shape;
+
+    if (url.isLocalFile() || url.scheme().isEmpty()) {
+        startFileDecode(key, url.isLocalFile() ? url.toLocalFile() : url.toString(), false);
+        return;
+    }
+
+    QString diskPath;
+    bool needsRevalidation = false;
+    if (MediaCache::instance()->lookupDisk(url, &diskPath, &needsRevalidation) && !needsRevalidation) {
+        startFileDecode(key, diskPath, true);
+        return;
+    }
+    startFetch(key);
+}
+
+void ImagePipeline::startFetch(const QString& key)
+{
+    Job& job = m_jobs[key];
+    const QUrl url = job.url;
+    QNetworkRequest request(url);
+    request.setRawHeader("User-Agent", "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0.0.0 Safari/537.36");
+    request.setTransferTimeout(60000);
+    MediaCache::instance()->prepareRequest(url, &request);
+    QNetworkReply* reply = m_nam->get(request);
+    job.reply = reply;
+    connect(reply, &QNetworkReply::finished, this, [this, reply, key, url]() {
+        reply->deleteLater();
+        auto it = m_jobs.find(key);
+        if (it == m_jobs.end() || it->reply != reply) {
+            return;
+        }
+        it->reply = nullptr;
+        const QByteArray body = reply->readAll();
+        MediaCache* cache = MediaCache::instance();
+        const bool notModified = cache->handleResponse(url, reply, body);
+        if (notModified || reply->error() != QNetworkReply::NoError) {
+            // 304, or a failed revalidation: the disk copy is the best we have.
+            QString diskPath;
+            if (cache->lookupDisk(url, &diskPath, nullptr)) {
+                startFileDecode(key, diskPath, false);
+            } else {
+                finishJob(key, QImage());
+            }
+            return;
+        }
+        startDecode(key, body);
+    });
+}
+
+void ImagePipeline::startFileDecode(const QString& key, const QString& path, bool fetchOnFailure)
+{
+    const Job& job = m_jobs[key];
+    const QSize targetSize = job.targetSize;
+    const Shape shape = job.shape;
+    QPointer<ImagePipeline> self(this);
+    QThreadPool::globalInstance()->start([self, key, path, targetSize, shape, fetchOnFailure]() {
+        QFile file(path);
+        QImage image;
+        if (file.open(QIODevice::ReadOnly)) {
+            image = decode(file.readAll(), targetSize, shape);
+        }
+        if (!self) {
+            return;
+        }
+        QMetaObject::invokeMethod(self.data(), [self, key, image, fetchOnFailure]() {
+            if (image.isNull() && fetchOnFailure) {
+                // Missing or corrupt disk entry: forget it and go to the network.
+                auto it = self->m_jobs.find(key);
+                if (it != self->m_jobs.end()) {
+                    MediaCache::instance()->dropDisk(it->url);
+                    self->startFetch(key);
+                }
+                return;
+            }
+            self->finishJob(key, image);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ImagePipeline::cancel(QObject* receiver)
+{
+    if (!receiver) {
+        return;
+    }
+    QVector<QPair<QString, quint64>> dropped;
+    for (auto it = m_jobs.constBegin(); it != m_jobs.constEnd(); ++it) {
+        for (const Waiter& waiter : it->waiters) {
+            if (waiter.receiver == receiver) {
+                dropped.append(qMakePair(it.key(), waiter.id));
+            }
+        }
+    }
+    for (const auto& entry : dropped) {
+        dropWaiter(entry.first, entry.second);
+    }
+}
+
+void ImagePipeline::startDecode(const QString& key, const QByteArray& bytes)
+{
+    const Job& job = m_jobs[key];
+    const QSize targetSize = job.targetSize;
+    const Shape shape = job.shape;
+    QPointer<ImagePipeline> self(this);
+    QThreadPool::globalInstance()->start([self, key, bytes, targetSize, shape]() {
+        const QImage image = decode(bytes, targetSize, shape);
+        if (self) {
+            QMetaObject::invokeMethod(self.data(), [self, key, image]() { self->finishJob(key, image); }, Qt::QueuedConnection);
+        }
+    });
+}
+
+void ImagePipeline::finishJob(const QString& key, const QImage& image)
+{
+    NOVEO_TRACE_SCOPE("ImagePipeline::finishJob");
+    // A job whose waiters all went away was removed (and its reply aborted);
+    // a decode that was already running just lands here and is discarded.
+    auto it = m_jobs.find(key);
+    if (it == m_jobs.end()) {
+        return;
+    }
+    const QVector<Waiter> waiters = it->waiters;
+    m_jobs.erase(it);
+
+    const QPixmap pixmap = image.isNull() ? QPixmap() : QPixmap::fromImage(image);
+    MediaCache::instance()->insertPixmap(key, pixmap);
+    for (const Waiter& waiter : waiters) {
+        disconnect(waiter.destroyedConnection);
+        if (waiter.receiver) {
+            waiter.callback(pixmap);
+        }
+    }
+}
+
+void ImagePipeline::dropWaiter(const QString& key, quint64 waiterId)
+{
+    auto it = m_jobs.find(key);
+    if (it == m_jobs.end()) {
+        return;
+    }
+    for (int i = 0; i < it->waiters.size(); ++i) {
+        if (it->waiters[i].id == waiterId) {
+            disconnect(it->waiters[i].destroyedConnection);
+            it->waiters.removeAt(i);
+            break;
+        }
+    }
+    if (!it->waiters.isEmpty()) {
+        return;
+    }
+    QPointer<QNetworkReply> reply = it->reply;
+    m_jobs.erase(it);
+    if (reply) {
+        reply->abort();
+    }
+}
+
+QImage ImagePipeline::decode(const QByteArray& bytes, const QSize& targetSize, Shape shape)
+{
+    NOVEO_TRACE_SCOPE("ImagePipeline::decode");
+    QBuffer buffer;
+    buffer.setData(bytes);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer);
+    reader.setAutoTransform(true);
+
+    // Let the codec do the downscale where it can (JPEG decodes at 1/2, 1/4,
+    // 1/8 for almost free); the smooth pass below only finishes the job.
+    const QSize sourceSize = reader.size();
+    if (targetSize.isValid() && sourceSize.isValid()) {
+        const Qt::AspectRatioMode mode = (shape == Shape::Circle) ? Qt::KeepAspectRatioByExpanding : Qt::KeepAspectRatio;
+        const QSize scaled = sourceSize.scaled(targetSize, mode);
+        if (scaled.width() < sourceSize.width() || scaled.height() < sourceSize.height()) {
+            reader.setScaledSize(scaled);
+        }
+    }
+
+    QImage image = reader.read();
+    if (image.isNull() || !targetSize.isValid()) {
+        return image;
+    }
+
+    if (shape == Shape::Fit) {
+        if (image.width() > targetSize.width() || image.height() > targetSize.height()) {
+            image = image.scaled(targetSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        }
+        return image;
+    }
+
+    const int side = qMin(image.width(), image.height());
+    const QImage square = image.copy((image.width() - side) / 2, (image.height() - side) / 2, side, side)
+                              .scaled(targetSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    QImage circular(targetSize, QImage::Format_ARGB32_Premultiplied);
+    circular.fill(Qt::transparent);
+    QPainter painter(&circular);
+    painter.setRenderHint(QPainter::Antialiasing);
+    QPainterPath path;
+    path.addEllipse(0, 0, targetSize.width(), targetSize.height());
+    painter.setClipPath(path);
+    painter.drawImage(0, 0, square);
+    painter.end();
+    return circular;
+}
@@ -0,0 +1,79 @@
+#ifndef IMAGEPIPELINE_H
+#define IMAGEPIPELINE_H
+
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QPointer>
+#include <QSize>
+#include <QUrl>
+#include <QVector>
+
+#include <functional>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+// Shared fetch -> decode -> scale pipeline for every image shown by the UI.
+// Results and original bytes are cached through MediaCache. Bytes are fetched
+// on the GUI thread (network I/O is already asynchronous), decoding and
+// scaling run on QThreadPool::globalInstance(), and only the final
+// QImage -> QPixmap conversion happens back on the GUI thread.
+class ImagePipeline : public QObject
+{
+    Q_OBJECT
+public:
+    enum class Shape {
+        Fit,    // Fit inside the target size, keeping aspect ratio. Never upscales.
+        Circle  // Center-crop to a square and clip to a circle of the target size.
+    };
+
+    using Callback = std::function<void(const QPixmap&)>;
+
+    static ImagePipeline* instance();
+
+    // Identical (url, size, shape) requests share one fetch and one decode.
+    // The callback runs on the GUI thread with a null pixmap on failure, and
+    // is dropped if receiver is destroyed first; the fetch is aborted once no
+    // receiver is waiting for it. An empty targetSize decodes at full size.
+    // Callers probe cachedPixmap() first; the memory check in here is not
+    // counted again in the cache statistics.
+    void load(const QUrl& url, const QSize& targetSize, Shape shape, QObject* receiver, Callback callback);
+    // Memory-tier lookup only; never starts a fetch.
+    bool cachedPixmap(const QUrl& url, const QSize& targetSize, Shape shape, QPixmap* out) const;
+    void cancel(QObject* receiver);
+
+private:
+    explicit ImagePipeline(QObject* parent = nullptr);
+
+    struct Waiter {
+        quint64 id = 0;
+        QPointer<QObject> receiver;
+        Callback callback;
+        QMetaObject::Connection destroyedConnection;
+    };
+
+    struct Job {
+        QUrl url;
+        QSize targetSize;
+        Shape shape = Shape::Fit;
+        QPointer<QNetworkReply> reply;
+        QVector<Waiter> waiters;
+    };
+
+    static QString jobKey(const QUrl& url, const QSize& targetSize, Shape shape);
+    static QImage decode(const QByteArray& bytes, const QSize& targetSize, Shape shape);
+
+    void startFetch(const QString& key);
+    void startDecode(const QString& key, const QByteArray& bytes);
+    void startFileDecode(const QString& key, const QString& path, bool fetchOnFailure);
+    void finishJob(const QString& key, const QImage& image);
+    void dropWaiter(const QString& key, quint64 waiterId);
+
+    QNetworkAccessManager* m_nam = nullptr;
+    QHash<QString, Job> m_jobs;
+    quint64 m_nextWaiterId = 1;
+};
+
+#endif // IMAGEPIPELINE_H
@@ -0,0 +1,663 @@
+#include "LocalStore.h"
+
+#include "WebSocketClient.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMetaObject>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include <QThread>
+#include <QVariant>
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+namespace {
+constexpr int kSchemaVersion = 1;
+const QString kConnectionName = QStringLiteral("noveo-local-store");
+const QString kCurrentUserKey = QStringLiteral("currentUser");
+const QString kLastOpenChatKey = QStringLiteral("lastOpenChat");
+
+QByteArray toJsonBytes(const QJsonObject& obj)
+{
+    return QJsonDocument(obj).toJson(QJsonDocument::Compact);
+}
+
+QJsonObject fromJsonBytes(const QByteArray& bytes)
+{
+    return QJsonDocument::fromJson(bytes).object();
+}
+
+QJsonObject userToJson(const User& user)
+{
+    return QJsonObject{
+        {QStringLiteral("userId"), user.userId},
+        {QStringLiteral("username"), user.username},
+        {QStringLiteral("avatarUrl"), user.avatarUrl},
+        {QStringLiteral("blockGroupInvites"), user.blockGroupInvites},
+    };
+}
+
+User userFromJson(const QJsonObject& obj)
+{
+    User user;
+    user.userId = obj.value(QStringLiteral("userId")).toString();
+    user.username = obj.value(QStringLiteral("username")).toString();
+    user.avatarUrl = obj.value(QStringLiteral("avatarUrl")).toString();
+    user.blockGroupInvites = obj.value(QStringLiteral("blockGroupInvites")).toBool();
+    return user;
+}
+
+QJsonObject messageToJson(const Message& msg)
+{
+    QJsonObject obj{
+        {QStringLiteral("messageId"), msg.messageId},
+        {QStringLiteral("chatId"), msg.chatId},
+        {QStringLiteral("senderId"), msg.senderId},
+        {QStringLiteral("senderName"), msg.senderName},
+        {QStringLiteral("senderAvatarUrl"), msg.senderAvatarUrl},
+        {QStringLiteral("text"), msg.text},
+        {QStringLiteral("timestamp"), static_cast<double>(msg.timestamp)},
+        {QStringLiteral("theme"), msg.theme},
+        {QStringLiteral("status"), static_cast<int>(msg.status)},
+        {QStringLiteral("seenBy"), QJsonArray::fromStringList(msg.seenBy)},
+        {QStringLiteral("editedAt"), static_cast<double>(msg.editedAt)},
+        {QStringLiteral("replyToId"), msg.replyToId},
+    };
+    if (!msg.file.isNull()) {
+        obj.insert(QStringLiteral("file"), QJsonObject{
+            {QStringLiteral("url"), msg.file.url},
+            {QStringLiteral("name"), msg.file.name},
+            {QStringLiteral("type"), msg.file.type},
+            {QStringLiteral("size"), static_cast<double>(msg.file.size)},
+        });
+    }
+    if (!msg.forwardedInfo.isNull()) {
+        obj.insert(QStringLiteral("forwardedInfo"), QJsonObject{
+            {QStringLiteral("from"), msg.forwardedInfo.from},
+            {QStringLiteral("originalTs"), static_cast<double>(msg.forwardedInfo.originalTs)},
+        });
+    }
+    return obj;
+}
+
+QStringList toStringList(const QJsonValue& value)
+{
+    QStringList list;
+    const QJsonArray array = value.toArray();
+    list.reserve(array.size());
+    for (const QJsonValue& item : array) {
+        list.append(item.toString());
+    }
+    return list;
+}
+
+Message messageFromJson(const QJsonObject& obj)
+{
+    Message msg;
+    msg.messageId = obj.value(QStringLiteral("messageId")).toString();
+    msg.chatId = obj.value(QStringLiteral("chatId")).toString();
+    msg.senderId = obj.value(QStringLiteral("senderId")).toString();
+    msg.senderName = obj.value(QStringLiteral("senderName")).toString();
+    msg.senderAvatarUrl = obj.value(QStringLiteral("senderAvatarUrl")).toString();
+    msg.text = obj.value(QStringLiteral("text")).toString();
+    msg.timestamp = static_cast<qint64>(obj.value(QStringLiteral("timestamp")).toDouble());
+    msg.theme = obj.value(QStringLiteral("theme")).toString();
+    msg.status = static_cast<MessageStatus>(obj.value(QStringLiteral("status")).toInt(static_cast<int>(MessageStatus::Sent)));
+    msg.seenBy = toStringList(obj.value(QStringLiteral("seenBy")));
+    msg.editedAt = static_cast<qint64>(obj.value(QStringLiteral("editedAt")).toDouble());
+    msg.replyToId = obj.value(QStringLiteral("replyToId")).toString();
+    const QJsonObject file = obj.value(QStringLiteral("file")).toObject();
+    msg.file.url = file.value(QStringLiteral("url")).toString();
+    msg.file.name = file.value(QStringLiteral("name")).toString();
+    msg.file.type = file.value(QStringLiteral("type")).toString();
+    msg.file.size = static_cast<qint64>(file.value(QStringLiteral("size")).toDouble());
+    const QJsonObject forwarded = obj.value(QStringLiteral("forwardedInfo")).toObject();
+    msg.forwardedInfo.from = forwarded.value(QStringLiteral("from")).toString();
+    msg.forwardedInfo.originalTs = static_cast<qint64>(forwarded.value(QStringLiteral("originalTs")).toDouble());
+    return msg;
+}
+
+// Chat metadata only; messages live in their own table.
+QJsonObject chatToJson(const Chat& chat)
+{
+    QJsonObject obj{
+        {QStringLiteral("chatId"), chat.chatId},
+        {QStringLiteral("chatName"), chat.chatName},
+        {QStringLiteral("chatType"), chat.chatType},
+        {QStringLiteral("handle"), chat.handle},
+        {QStringLiteral("members"), QJsonArray::fromStringList(chat.members)},
+        {QStringLiteral("ownerId"), chat.ownerId},
+        {QStringLiteral("unreadCount"), chat.unreadCount},
+        {QStringLiteral("avatarUrl"), chat.avatarUrl},
+        {QStringLiteral("isVerified"), chat.isVerified},
+        {QStringLiteral("createdAt"), static_cast<double>(chat.createdAt)},
+    };
+    if (chat.hasPinnedMessage) {
+        obj.insert(QStringLiteral("pinnedMessage"), messageToJson(chat.pinnedMessage));
+    }
+    return obj;
+}
+
+Chat chatFromJson(const QJsonObject& obj)
+{
+    Chat chat;
+    chat.chatId = obj.value(QStringLiteral("chatId")).toString();
+    chat.chatName = obj.value(QStringLiteral("chatName")).toString();
+    chat.chatType = obj.value(QStringLiteral("chatType")).toString();
+    chat.handle = obj.value(QStringLiteral("handle")).toString();
+    chat.members = toStringList(obj.value(QStringLiteral("members")));
+    chat.ownerId = obj.value(QStringLiteral("ownerId")).toString();
+    chat.unreadCount = obj.value(QStringLiteral("unreadCount")).toInt();
+    chat.avatarUrl = obj.value(QStringLiteral("avatarUrl")).toString();
+    chat.isVerified = obj.value(QStringLiteral("isVerified")).toBool();
+    chat.createdAt = static_cast<qint64>(obj.value(QStringLiteral("createdAt")).toDouble());
+    if (obj.contains(QStringLiteral("pinnedMessage"))) {
+        chat.hasPinnedMessage = true;
+        chat.pinnedMessage = messageFromJson(obj.value(QStringLiteral("pinnedMessage")).toObject());
+    }
+    return chat;
+}
+
+QString storeDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + QStringLiteral("/store");
+}
+
+QString databasePathFor(const QString& accountId)
+{
+    const QByteArray hash = QCryptographicHash::hash(accountId.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return storeDirectory() + QLatin1Char('/') + QString::fromLatin1(hash) + QStringLiteral(".sqlite");
+}
+}
+
+// Lives on the store thread. Every failure leaves the database closed or the
+// transaction rolled back; the store is a cache, so errors are never fatal.
+class LocalStore::Database
+{
+public:
+    ~Database() { close(); }
+
+    bool open(const QString& accountId)
+    {
+        close();
+        QDir().mkpath(storeDirectory());
+        m_path = databasePathFor(accountId);
+        {
+            QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), kConnectionName);
+            db.setDatabaseName(m_path);
+            if (!db.open()) {
+                db = QSqlDatabase();
+                QSqlDatabase::removeDatabase(kConnectionName);
+                return false;
+            }
+        }
+        if (!migrate()) {
+            close();
+            QFile::remove(m_path);
+            return false;
+        }
+        m_open = true;
+        return true;
+    }
+
+    void close()
+    {
+        if (!QSqlDatabase::contains(kConnectionName)) {
+            m_open = false;
+            return;
+        }
+        {
+            QSqlDatabase db = QSqlDatabase::database(kConnectionName, false);
+            db.close();
+        }
+        QSqlDatabase::removeDatabase(kConnectionName);
+        m_open = false;
+    }
+
+    void wipe()
+    {
+        const QString path = m_path;
+        close();
+        if (!path.isEmpty()) {
+            QFile::remove(path);
+            QFile::remove(path + QStringLiteral("-wal"));
+            QFile::remove(path + QStringLiteral("-shm"));
+        }
+        m_path.clear();
+    }
+
+    bool isOpen() const { return m_open; }
+
+    void saveChats(const std::vector<Chat>& chats)
+    {
+        transaction([&]() {
+            for (const Chat& chat : chats) {
+                // Older-history pages may carry a chat stub without metadata;
+                // keep what is stored and only add the messages.
+                if (!chat.chatType.isEmpty() && !upsertChat(chat)) {
+                    return false;
+                }
+                for (const Message& msg : chat.messages) {
+                    if (!upsertMessage(msg, chat.chatId)) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        });
+    }
+
+    void saveChat(const Chat& chat)
+    {
+        saveChats(std::vector<Chat>{chat});
+    }
+
+    void saveMessage(const Message& msg)
+    {
+        transaction([&]() { return upsertMessage(msg, msg.chatId); });
+    }
+
+    void updateMessage(const QString& chatId, const QString& messageId, const std::function<void(QJsonObject&)>& mutate)
+    {
+        transaction([&]() {
+            QSqlQuery select(database());
+            select.prepare(QStringLiteral("SELECT payload FROM messages WHERE chat_id = ? AND message_id = ?"));
+            select.addBindValue(chatId);
+            select.addBindValue(messageId);
+            if (!select.exec()) {
+                return false;
+            }
+            if (!select.next()) {
+                return true;
+            }
+            QJsonObject payload = fromJsonBytes(select.value(0).toByteArray());
+            mutate(payload);
+            return upsertMessage(messageFromJson(payload), chatId);
+        });
+    }
+
+    void deleteMessage(const QString& chatId, const QString& messageId)
+    {
+        deleteMessages(chatId, QStringList{messageId});
+    }
+
+    void deleteMessages(const QString& chatId, const QStringList& messageIds)
+    {
+        transaction([&]() {
+            QSqlQuery query(database());
+            query.prepare(QStringLiteral("DELETE FROM messages WHERE chat_id = ? AND message_id = ?"));
+            for (const QString& messageId : messageIds) {
+                query.addBindValue(chatId);
+                query.addBindValue(messageId);
+                if (!query.exec()) {
+                    return false;
+                }
+            }
+            return true;
+        });
+    }
+
+    void updateChat(const QString& chatId, const std::function<void(Chat&)>& mutate)
+    {
+        transaction([&]() {
+            QSqlQuery select(database());
+            select.prepare(QStringLiteral("SELECT payload FROM chats WHERE chat_id = ?"));
+            select.addBindValue(chatId);
+            if (!select.exec()) {
+                return false;
+            }
+            if (!select.next()) {
+                return true;
+            }
+            Chat chat = chatFromJson(fromJsonBytes(select.value(0).toByteArray()));
+            mutate(chat);
+            return upsertChat(chat);
+        });
+    }
+
+    void saveUsers(const std::vector<User>& users)
+    {
+        transaction([&]() {
+            QSqlQuery clear(database());
+            if (!clear.exec(QStringLiteral("DELETE FROM users"))) {
+                return false;
+            }
+            for (const User& user : users) {
+                if (!upsertUser(user)) {
+                    return false;
+                }
+            }
+            return true;
+        });
+    }
+
+    void saveUser(const User& user)
+    {
+        transaction([&]() { return upsertUser(user); });
+    }
+
+    void setMeta(const QString& key, const QByteArray& value)
+    {
+        transaction([&]() {
+            QSqlQuery query(database());
+            query.prepare(QStringLiteral("INSERT OR REPLACE INTO meta (key, value) VALUES (?, ?)"));
+            query.addBindValue(key);
+            query.addBindValue(value);
+            return query.exec();
+        });
+    }
+
+    QByteArray meta(const QString& key)
+    {
+        QSqlQuery query(database());
+        query.prepare(QStringLiteral("SELECT value FROM meta WHERE key = ?"));
+        query.addBindValue(key);
+        if (query.exec() && query.next()) {
+            return query.value(0).toByteArray();
+        }
+        return QByteArray();
+    }
+
+    LocalStore::Snapshot loadSnapshot(int messagesPerChat)
+    {
+        LocalStore::Snapshot snapshot;
+        if (!m_open) {
+            return snapshot;
+        }
+        snapshot.currentUser = userFromJson(fromJsonBytes(meta(kCurrentUserKey)));
+        snapshot.lastOpenChatId = QString::fromUtf8(meta(kLastOpenChatKey));
+
+        QSqlQuery users(database());
+        users.setForwardOnly(true);
+        if (users.exec(QStringLiteral("SELECT payload FROM users"))) {
+            while (users.next()) {
+                snapshot.users.push_back(userFromJson(fromJsonBytes(users.value(0).toByteArray())));
+            }
+        }
+
+        QSqlQuery chats(database());
+        chats.setForwardOnly(true);
+        if (!chats.exec(QStringLiteral("SELECT payload FROM chats ORDER BY last_activity DESC"))) {
+            return snapshot;
+        }
+        QSqlQuery messages(database());
+        messages.setForwardOnly(true);
+        messages.prepare(QStringLiteral("SELECT payload FROM messages WHERE chat_id = ? ORDER BY timestamp DESC LIMIT ?"));
+        while (chats.next()) {
+            Chat chat = chatFromJson(fromJsonBytes(chats.value(0).toByteArray()));
+            messages.bindValue(0, chat.chatId);
+            messages.bindValue(1, messagesPerChat);
+            if (messages.exec()) {
+                while (messages.next()) {
+                    chat.messages.push_back(messageFromJson(fromJsonBytes(messages.value(0).toByteArray())));
+                }
+            }
+            std::reverse(chat.messages.begin(), chat.messages.end());
+            chat.reindexMessages();
+            snapshot.chats.push_back(std::move(chat));
+        }
+        return snapshot;
+    }
+
+private:
+    QSqlDatabase database() const
+    {
+        return QSqlDatabase::database(kConnectionName, false);
+    }
+
+    bool migrate()
+    {
+        QSqlDatabase db = database();
+        QSqlQuery query(db);
+        query.exec(QStringLiteral("PRAGMA journal_mode=WAL"));
+        query.exec(QStringLiteral("PRAGMA synchronous=NORMAL"));
+        if (!query.exec(QStringLiteral("PRAGMA user_version")) || !query.next()) {
+            return false;
+        }
+        const int version = query.value(0).toInt();
+        if (version == kSchemaVersion) {
+            return true;
+        }
+        if (version != 0) {
+            // Unknown layout (newer build or corrupt file): start over.
+            return false;
+        }
+        const QStringList statements = {
+            QStringLiteral("CREATE TABLE IF NOT EXISTS meta (key TEXT PRIMARY KEY, value BLOB)"),
+            QStringLiteral("CREATE TABLE IF NOT EXISTS users (user_id TEXT PRIMARY KEY, payload BLOB NOT NULL)"),
+            QStringLiteral("CREATE TABLE IF NOT EXISTS chats (chat_id TEXT PRIMARY KEY, last_activity INTEGER NOT NULL DEFAULT 0, payload BLOB NOT NULL)"),
+            QStringLiteral("CREATE TABLE IF NOT EXISTS messages (chat_id TEXT NOT NULL, message_id TEXT NOT NULL, timestamp INTEGER NOT NULL, payload BLOB NOT NULL, PRIMARY KEY (chat_id, message_id))"),
+            QStringLiteral("CREATE INDEX IF NOT EXISTS messages_by_time ON messages (chat_id, timestamp)"),
+            QStringLiteral("PRAGMA user_version = %1").arg(kSchemaVersion),
+        };
+        for (const QString& statement : statements) {
+            if (!query.exec(statement)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool transaction(const std::function<bool()>& body)
+    {
+        if (!m_open) {
+            return false;
+        }
+        QSqlDatabase db = database();
+        if (!db.transaction()) {
+            return false;
+        }
+        if (!body()) {
+            db.rollback();
+            return false;
+        }
+        return db.commit();
+    }
+
+    bool upsertChat(const Chat& chat)
+    {
+        qint64 lastActivity = 0;
+        for (const Message& msg : chat.messages) {
+            lastActivity = qMax(lastActivity, msg.timestamp);
+        }
+        QSqlQuery query(database());
+        query.prepare(QStringLiteral(
+            "INSERT INTO chats (chat_id, last_activity, payload) VALUES (?, ?, ?) "
+            "ON CONFLICT(chat_id) DO UPDATE SET payload = excluded.payload, "
+            "last_activity = MAX(last_activity, excluded.last_activity)"));
+        query.addBindValue(chat.chatId);
+        query.addBindValue(lastActivity);
+        query.addBindValue(toJsonBytes(chatToJson(chat)));
+        return query.exec();
+    }
+
+    bool upsertMessage(const Message& msg, const QString& chatId)
+    {
+        if (chatId.isEmpty() || msg.messageId.isEmpty() || msg.pending) {
+            return true;
+        }
+        Message stored = msg;
+        stored.chatId = chatId;
+        QSqlQuery query(database());
+        query.prepare(QStringLiteral("INSERT OR REPLACE INTO messages (chat_id, message_id, timestamp, payload) VALUES (?, ?, ?, ?)"));
+        query.addBindValue(chatId);
+        query.addBindValue(stored.messageId);
+        query.addBindValue(stored.timestamp);
+        query.addBindValue(toJsonBytes(messageToJson(stored)));
+        if (!query.exec()) {
+            return false;
+        }
+        QSqlQuery touch(database());
+        touch.prepare(QStringLiteral("UPDATE chats SET last_activity = MAX(last_activity, ?) WHERE chat_id = ?"));
+        touch.addBindValue(stored.timestamp);
+        touch.addBindValue(chatId);
+        return touch.exec();
+    }
+
+    bool upsertUser(const User& user)
+    {
+        if (user.userId.isEmpty()) {
+            return true;
+        }
+        QSqlQuery query(database());
+        query.prepare(QStringLiteral("INSERT OR REPLACE INTO users (user_id, payload) VALUES (?, ?)"));
+        query.addBindValue(user.userId);
+        query.addBindValue(toJsonBytes(userToJson(user)));
+        return query.exec();
+    }
+
+    QString m_path;
+    bool m_open = false;
+};
+
+LocalStore::LocalStore(QObject* parent)
+    : QObject(parent)
+{
+    m_thread = new QThread(this);
+    m_thread->setObjectName(QStringLiteral("NoveoStore"));
+    m_context = new QObject();
+    m_context->moveToThread(m_thread);
+    connect(m_thread, &QThread::finished, m_context, &QObject::deleteLater);
+    m_db = new Database();
+    m_thread->start();
+}
+
+LocalStore::~LocalStore()
+{
+    post([db = m_db]() { delete db; });
+    m_thread->quit();
+    m_thread->wait();
+}
+
+template <typename Fn>
+void LocalStore::post(Fn&& fn)
+{
+    QMetaObject::invokeMethod(m_context, std::forward<Fn>(fn), Qt::QueuedConnection);
+}
+
+void LocalStore::attach(WebSocketClient* client)
+{
+    connect(client, &WebSocketClient::loginSuccess, this, [this](const User& user) {
+        if (user.userId.isEmpty()) {
+            return;
+        }
+        if (user.userId != m_accountId) {
+            open(user.userId);
+        }
+        post([db = m_db, user]() { db->setMeta(kCurrentUserKey, toJsonBytes(userToJson(user))); });
+    });
+    connect(client, &WebSocketClient::chatHistoryReceived, this, [this](const std::vector<Chat>& chats) {
+        post([db = m_db, chats]() { db->saveChats(chats); });
+    });
+    connect(client, &WebSocketClient::chatDeltaReceived, this, [this](const std::vector<Chat>& chats) {
+        post([db = m_db, chats]() { db->saveChats(chats); });
+    });
+    connect(client, &WebSocketClient::chatHistoryBatchReceived, this, [this](const std::vector<Chat>& chats) {
+        post([db = m_db, chats]() { db->saveChats(chats); });
+    });
+    connect(client, &WebSocketClient::newChatCreated, this, [this](const Chat& chat) {
+        post([db = m_db, chat]() { db->saveChat(chat); });
+    });
+    connect(client, &WebSocketClient::channelInfoReceived, this, [this](const Chat& chat) {
+        post([db = m_db, chat]() { db->saveChat(chat); });
+    });
+    connect(client, &WebSocketClient::messageReceived, this, [this](const Message& msg) {
+        post([db = m_db, msg]() { db->saveMessage(msg); });
+    });
+    connect(client, &WebSocketClient::messageUpdated, this, [this](const QString& chatId, const QString& messageId, const QString& newContent, qint64 editedAt) {
+        post([db = m_db, chatId, messageId, newContent, editedAt]() {
+            db->updateMessage(chatId, messageId, [&](QJsonObject& payload) {
+                payload.insert(QStringLiteral("text"), newContent);
+                payload.insert(QStringLiteral("editedAt"), static_cast<double>(editedAt));
+            });
+        });
+    });
+    connect(client, &WebSocketClient::messageDeleted, this, [this](const QString& chatId, const QString& messageId) {
+        post([db = m_db, chatId, messageId]() { db->deleteMessage(chatId, messageId); });
+    });
+    connect(client, &WebSocketClient::messageSeenUpdate, this, [this](const QString& chatId, const QString& messageId, const QString& userId) {
+        post([db = m_db, chatId, messageId, userId]() {
+            db->updateMessage(chatId, messageId, [&](QJsonObject& payload) {
+                QJsonArray seenBy = payload.value(QStringLiteral("seenBy")).toArray();
+                if (!seenBy.contains(userId)) {
+                    seenBy.append(userId);
+                    payload.insert(QStringLiteral("seenBy"), seenBy);
+                }
+            });
+        });
+    });
+    connect(client, &WebSocketClient::memberJoined, this, [this](const QString& chatId, const QStringList& members) {
+        post([db = m_db, chatId, members]() {
+            db->updateChat(chatId, [&](Chat& chat) { chat.members = members; });
+        });
+    });
+    connect(client, &WebSocketClient::messagePinned, this, [this](const QString& chatId, const Message& message) {
+        post([db = m_db, chatId, message]() {
+            db->updateChat(chatId, [&](Chat& chat) {
+                chat.hasPinnedMessage = true;
+                chat.pinnedMessage = message;
+            });
+        });
+    });
+    connect(client, &WebSocketClient::messageUnpinned, this, [this](const QString& chatId) {
+        post([db = m_db, chatId]() {
+            db->updateChat(chatId, [](Chat& chat) { chat.hasPinnedMessage = false; });
+        });
+    });
+    connect(client, &WebSocketClient::userListUpdated, this, [this](const std::vector<User>& users) {
+        post([db = m_db, users]() { db->saveUsers(users); });
+    });
+    connect(client, &WebSocketClient::userUpdated, this, [this](const User& user) {
+        post([db = m_db, user]() { db->saveUser(user); });
+    });
+}
+
+void LocalStore::open(const QString& accountId)
+{
+    m_accountId = accountId;
+    post([db = m_db, accountId]() { db->open(accountId); });
+}
+
+void LocalStore::close()
+{
+    m_accountId.clear();
+    post([db = m_db]() { db->close(); });
+}
+
+void LocalStore::wipe()
+{
+    m_accountId.clear();
+    post([db = m_db]() { db->wipe(); });
+}
+
+void LocalStore::loadSnapshot(int messagesPerChat)
+{
+    post([this, db = m_db, messagesPerChat, accountId = m_accountId]() {
+        LocalStore::Snapshot snapshot = db->loadSnapshot(messagesPerChat);
+        snapshot.accountId = accountId;
+        QMetaObject::invokeMethod(this, [this, snapshot]() {
+            // Drop results for an account that was closed or switched meanwhile.
+            if (snapshot.accountId == m_accountId) {
+                emit snapshotLoaded(snapshot);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void LocalStore::setLastOpenChat(const QString& chatId)
+{
+    post([db = m_db, chatId]() { db->setMeta(kLastOpenChatKey, chatId.toUtf8()); });
+}
+
+void LocalStore::removeMessages(const QString& chatId, const QStringList& messageIds)
+{
+    post([db = m_db, chatId, messageIds]() { db->deleteMessages(chatId, messageIds); });
+}
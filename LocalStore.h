@@ -0,0 +1,67 @@
+#ifndef LOCALSTORE_H
+#define LOCALSTORE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include <vector>
+
+#include "DataStructures.h"
+
+class QThread;
+class WebSocketClient;
+
+// On-disk copy of chats, messages and users for the signed-in account, kept
+// in a per-account SQLite database under AppLocalDataLocation/store. It is
+// fed directly by WebSocketClient events so it mirrors what the server sent,
+// and is read back at startup so the UI can render before the server answers.
+// All SQL runs on a dedicated thread; calls here only queue work.
+class LocalStore : public QObject
+{
+    Q_OBJECT
+public:
+    struct Snapshot {
+        QString accountId;
+        User currentUser;
+        std::vector<User> users;
+        std::vector<Chat> chats; // Most recently active first.
+        QString lastOpenChatId;
+    };
+
+    explicit LocalStore(QObject* parent = nullptr);
+    ~LocalStore() override;
+
+    // Mirrors the client's events into the open database. loginSuccess opens
+    // the database for that account.
+    void attach(WebSocketClient* client);
+
+    void open(const QString& accountId);
+    void close();
+    // Closes and deletes the open account's database.
+    void wipe();
+
+    // Emits snapshotLoaded with every chat and its newest messages.
+    void loadSnapshot(int messagesPerChat = 50);
+    void setLastOpenChat(const QString& chatId);
+    // Drops messages found to be gone from the server.
+    void removeMessages(const QString& chatId, const QStringList& messageIds);
+
+    QString accountId() const { return m_accountId; }
+
+signals:
+    void snapshotLoaded(const LocalStore::Snapshot& snapshot);
+
+private:
+    class Database;
+
+    template <typename Fn>
+    void post(Fn&& fn);
+
+    QThread* m_thread = nullptr;
+    QObject* m_context = nullptr;
+    Database* m_db = nullptr; // Only touched on m_thread.
+    QString m_accountId;
+};
+
+#endif // LOCALSTORE_H
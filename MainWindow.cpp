@@ -1,9 +1,16 @@
 #include "MainWindow.h"
 #include "AppConfig.h"
 #include "ChatSettingsDialog.h"
+#include "ImagePipeline.h"
+#include "MediaCache.h"
 #include "MediaViewerDialog.h"
+#include "MessageDelegate.h"
 #include "MessageItemWidget.h"
+#include "MessageListModel.h"
+#include "MessageWidgetPool.h"
+#include "Metrics.h"
 #include "SettingsDialog.h"
+#include "Trace.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGridLayout>
@@ -11,6 +18,7 @@
 #include <QLineEdit>
 #include <QPushButton>
 #include <QToolButton>
+#include <QListView>
 #include <QListWidget>
 #include <QStackedWidget>
 #include <QSizePolicy>
@@ -23,8 +31,6 @@
 #include <QRegularExpression>
 #include <QCheckBox>
 #include <QApplication>
-#include <QTextDocument>
-#include <QAbstractTextDocumentLayout>
 #include <QDateTime>
 #include <QScrollBar> 
 #include <QSet>
@@ -34,7 +40,6 @@
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
-#include <QCryptographicHash>
 #include <QUuid>
 #include <QMenu>
 #include <QDebug>
@@ -73,85 +78,14 @@
 #include <QLayoutItem>
 
 const int AvatarUrlRole = Qt::UserRole + 10;
-const int FileUrlRole = Qt::UserRole + 12;
-const int FileTypeRole = Qt::UserRole + 13;
+const int DiagnosticsSampleIntervalMs = 250;
+// Parked bubbles kept for reuse; a screenful plus overscan is ~30.
+const int MessageWidgetPoolSize = 64;
+// Rows a chat opens with. Reaching the top reveals the next page from the
+// store before older history is fetched from the server.
+const int MessageWindowRows = 200;
 const QString API_BASE_URL = AppConfig::apiBaseUrl();
 
-namespace {
-QJsonObject parsePossiblyNestedContentObject(const QString& text)
-{
-    QString raw = text.trimmed();
-    for (int depth = 0; depth < 3 && !raw.isEmpty(); ++depth) {
-        QJsonParseError error;
-        const QJsonDocument parsed = QJsonDocument::fromJson(raw.toUtf8(), &error);
-        if (error.error != QJsonParseError::NoError) {
-            return QJsonObject();
-        }
-        if (parsed.isObject()) {
-            return parsed.object();
-        }
-        if (parsed.isArray() || parsed.isNull()) {
-            return QJsonObject();
-        }
-        const QVariant variant = parsed.toVariant();
-        if (variant.type() == QVariant::String) {
-            const QString nested = variant.toString().trimmed();
-            if (nested == raw) {
-                return QJsonObject();
-            }
-            raw = nested;
-            continue;
-        }
-        return QJsonObject();
-    }
-    return QJsonObject();
-}
-
-FileAttachment parseFileAttachmentValue(const QJsonValue& value)
-{
-    FileAttachment file;
-    if (value.isObject()) {
-        const QJsonObject obj = value.toObject();
-        file.url = obj.value(QStringLiteral("url")).toString();
-        file.name = obj.value(QStringLiteral("name")).toString();
-        file.type = obj.value(QStringLiteral("type")).toString();
-        file.size = static_cast<qint64>(obj.value(QStringLiteral("size")).toDouble());
-    } else if (value.isString()) {
-        file.url = value.toString();
-    }
-    return file;
-}
-
-QString extractRenderableMessageText(const Message& msg, FileAttachment* effectiveFile = nullptr)
-{
-    FileAttachment resolvedFile = msg.file;
-    QString text = msg.text.trimmed();
-    const QJsonObject parsedContent = parsePossiblyNestedContentObject(text);
-    if (!parsedContent.isEmpty() &&
-        (parsedContent.contains(QStringLiteral("text")) ||
-         parsedContent.contains(QStringLiteral("file")) ||
-         parsedContent.contains(QStringLiteral("theme")))) {
-        const QJsonValue parsedText = parsedContent.value(QStringLiteral("text"));
-        if (parsedText.isString()) {
-            text = parsedText.toString().trimmed();
-        } else if (parsedText.isBool() || parsedText.isDouble()) {
-            text = parsedText.toVariant().toString().trimmed();
-        } else {
-            text.clear();
-        }
-
-        if (resolvedFile.isNull() && parsedContent.contains(QStringLiteral("file"))) {
-            resolvedFile = parseFileAttachmentValue(parsedContent.value(QStringLiteral("file")));
-        }
-    }
-
-    if (effectiveFile) {
-        *effectiveFile = resolvedFile;
-    }
-    return text;
-}
-}
-
 void UserListDelegate::paint(QPainter* painter,
                              const QStyleOptionViewItem& option,
                              const QModelIndex& index) const
@@ -234,427 +168,17 @@ QSize UserListDelegate::sizeHint(const QStyleOptionViewItem& option,
     return QSize(option.rect.width(), 60);
 }
 
-class MessageDelegate : public QStyledItemDelegate {
-    bool m_isDarkMode = false;
-    MainWindow* m_mainWindow = nullptr;
-    QString m_highlightedMessageId;
-
-public:
-    explicit MessageDelegate(MainWindow* mainWindow, QObject* parent = nullptr)
-        : QStyledItemDelegate(parent), m_mainWindow(mainWindow) {}
-
-    void setTheme(bool isDarkMode) {
-        m_isDarkMode = isDarkMode;
-    }
-
-    void setHighlightedMessage(const QString& messageId) {
-        m_highlightedMessageId = messageId;
-    }
-
-    void getBubbleLayout(const QString& text, const QString& sender, bool isMe, int viewWidth,
-                         QRect& bubbleRect, QRect& textRect, QRect& nameRect, QRect& avatarRect,
-                         int& neededHeight, bool hasReply, const QString& replyText, QRect& replyQuoteRect) const
-    {
-        const int safeViewWidth = (viewWidth > 0) ? viewWidth : 420;
-        const int maxBubbleWidth = qBound(220, static_cast<int>(safeViewWidth * 0.72), 720);
-        int nameHeight = isMe ? 0 : 18;
-        int replyQuoteHeight = hasReply ? 48 : 0;
-        int timeHeight = 12;
-        int bubblePadding = 16;
-        int avatarSize = 38;
-        int avatarGap = 10;
-        int sideMargin = 10;
-
-        static QRegularExpression regex("^(.*)\\s\\[#([a-fA-F0-9]{6}),\\s*\\\"(.*)\\\"\\]$");
-        QRegularExpressionMatch match = regex.match(sender);
-
-        QString displayName = sender;
-        QString tagText;
-        bool hasTag = false;
-
-        if (match.hasMatch()) {
-            displayName = match.captured(1).trimmed();
-            tagText = match.captured(3);
-            hasTag = true;
-        }
-
-        int totalNameWidth = 0;
-        if (!isMe) {
-            QFont nameFont("Segoe UI", 11);
-            nameFont.setBold(true);
-            QFontMetrics fm(nameFont);
-            int nameTextW = fm.horizontalAdvance(displayName);
-            int tagW = 0;
-            if (hasTag) {
-                QFont tagFont("Segoe UI", 9);
-                tagFont.setBold(true);
-                QFontMetrics tagFm(tagFont);
-                tagW = tagFm.horizontalAdvance(tagText) + 12;
-            }
-            totalNameWidth = nameTextW + (hasTag ? (tagW + 8) : 0);
-        }
-
-        int replyQuoteWidth = 0;
-        if (hasReply && !replyText.isEmpty()) {
-            QFont replyFont("Segoe UI", 9);
-            replyFont.setItalic(true);
-            QFontMetrics replyFm(replyFont);
-            QString replyPreview = replyText.length() > 40 ? replyText.left(40) + "..." : replyText;
-            replyQuoteWidth = replyFm.horizontalAdvance(replyPreview) + 30;
-        }
-
-        QTextDocument doc;
-        QTextOption wrapOption;
-        wrapOption.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
-        doc.setDefaultTextOption(wrapOption);
-        doc.setDefaultFont(QFont("Segoe UI", 10));
-        doc.setPlainText(text);
-        doc.setTextWidth(qMax(140, maxBubbleWidth - 20));
-
-        int textWidth = doc.idealWidth();
-        int textHeight = doc.size().height();
-
-        int contentWidth = isMe ? qMax(textWidth + 20, replyQuoteWidth)
-                                : qMax(textWidth + 20, qMax(totalNameWidth + 30, replyQuoteWidth));
-
-        int bubbleW = qMax(contentWidth, 100);
-        int bubbleH = textHeight + nameHeight + replyQuoteHeight + timeHeight + bubblePadding;
-
-        neededHeight = bubbleH + 10;
-
-        int x;
-        if (isMe) {
-            x = safeViewWidth - bubbleW - sideMargin;
-            avatarRect = QRect();
-        } else {
-            x = sideMargin + avatarSize + avatarGap;
-            avatarRect = QRect(sideMargin, 5 + bubbleH - avatarSize, avatarSize, avatarSize);
-        }
-
-        bubbleRect = QRect(x, 5, bubbleW, bubbleH);
-
-        if (!isMe) {
-            nameRect = QRect(x + 10, 5 + 5, bubbleW - 20, 15);
-            if (hasReply) {
-                replyQuoteRect = QRect(x + 10, 5 + 23, bubbleW - 20, replyQuoteHeight - 8);
-                textRect = QRect(x + 10, 5 + 23 + replyQuoteHeight, bubbleW - 20, textHeight);
-            } else {
-                textRect = QRect(x + 10, 5 + 23, bubbleW - 20, textHeight);
-            }
-        } else {
-            if (hasReply) {
-                replyQuoteRect = QRect(x + 10, 5 + 8, bubbleW - 20, replyQuoteHeight - 8);
-                textRect = QRect(x + 10, 5 + 8 + replyQuoteHeight, bubbleW - 20, textHeight);
-            } else {
-                textRect = QRect(x + 10, 5 + 8, bubbleW - 20, textHeight);
-            }
-        }
-    }
-
-    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override {
-        painter->save();
-        painter->setRenderHint(QPainter::Antialiasing);
-        painter->setClipRect(option.rect);
-
-        QString text = index.data(Qt::UserRole + 1).toString();
-        QString sender = index.data(Qt::UserRole + 2).toString();
-        qint64 timestamp = index.data(Qt::UserRole + 3).toLongLong();
-        bool isMe = index.data(Qt::UserRole + 4).toBool();
-        QIcon avatar = index.data(Qt::DecorationRole).value<QIcon>();
-        QString replyToId = index.data(Qt::UserRole + 9).toString();
-        QString messageId = index.data(Qt::UserRole + 6).toString();
-        bool hasReply = !replyToId.isEmpty();
-
-        QRect bubbleRect, textRect, nameRect, avatarRect, replyQuoteRect;
-        int neededHeight;
-        QString replyText;
-        if (hasReply) {
-            replyText = index.data(Qt::UserRole + 10).toString();
-        }
-
-        const int viewWidth = option.widget ? option.widget->width() : option.rect.width();
-        getBubbleLayout(text, sender, isMe, viewWidth,
-                        bubbleRect, textRect, nameRect, avatarRect, neededHeight,
-                        hasReply, replyText, replyQuoteRect);
-
-        bubbleRect.translate(0, option.rect.top());
-        textRect.translate(0, option.rect.top());
-        nameRect.translate(0, option.rect.top());
-        avatarRect.translate(0, option.rect.top());
-        replyQuoteRect.translate(0, option.rect.top());
-
-        if (!isMe && !avatar.isNull()) {
-            avatar.paint(painter, avatarRect);
-        }
-
-        QColor bubbleColor;
-        QColor borderColor;
-        QColor textColor;
-        QColor timeColor;
-
-        bool isHighlighted = (messageId == m_highlightedMessageId);
-
-        if (m_isDarkMode) {
-            bubbleColor = isMe ? QColor("#2b5278") : QColor("#2d2d2d");
-            borderColor = Qt::transparent;
-            textColor = Qt::white;
-            timeColor = QColor("#a0a0a0");
-        } else {
-            bubbleColor = isMe ? QColor("#EEFFDE") : Qt::white;
-            borderColor = QColor("#d0d0d0");
-            textColor = Qt::black;
-            timeColor = QColor("#888888");
-        }
-
-        if (isHighlighted) {
-            borderColor = QColor("#FFD700");
-            painter->setBrush(bubbleColor);
-            painter->setPen(QPen(borderColor, 3));
-        } else {
-            painter->setBrush(bubbleColor);
-            painter->setPen(borderColor == Qt::transparent ? Qt::NoPen : QPen(borderColor, 1));
-        }
-
-        painter->drawRoundedRect(bubbleRect, 12, 12);
-
-        if (!isMe) {
-            static QRegularExpression regex("^(.*)\\s\\[#([a-fA-F0-9]{6}),\\s*\\\"(.*)\\\"\\]$");
-            QRegularExpressionMatch match = regex.match(sender);
-            QString displayName = sender;
-            QString tagText;
-            QColor tagColor;
-            bool hasTag = false;
-
-            if (match.hasMatch()) {
-                displayName = match.captured(1).trimmed();
-                tagColor = QColor("#" + match.captured(2));
-                tagText = match.captured(3);
-                hasTag = true;
-            }
-
-            painter->setPen(QColor("#E35967"));
-            QFont nameFont = option.font;
-            nameFont.setPixelSize(11);
-            nameFont.setBold(true);
-            painter->setFont(nameFont);
-            QFontMetrics fm(nameFont);
-
-            int nameW = fm.horizontalAdvance(displayName);
-            painter->drawText(nameRect.left(), nameRect.top() + fm.ascent(), displayName);
-
-            if (hasTag) {
-                int tagX = nameRect.left() + nameW + 6;
-                int tagY = nameRect.top();
-                int tagW = fm.horizontalAdvance(tagText) + 10;
-                int tagH = 14;
-
-                painter->setBrush(tagColor);
-                painter->setPen(Qt::NoPen);
-                painter->drawRoundedRect(tagX, tagY, tagW, tagH, 3, 3);
-
-                painter->setPen(Qt::white);
-                QFont tagFont = nameFont;
-                tagFont.setPixelSize(9);
-                painter->setFont(tagFont);
-                painter->drawText(QRect(tagX, tagY, tagW, tagH), Qt::AlignCenter, tagText);
-            }
-        }
-
-        if (!replyToId.isEmpty()) {
-            QString replySenderName = index.data(Qt::UserRole + 11).toString();
-            int replyX = replyQuoteRect.left();
-            int replyY = replyQuoteRect.top();
-
-            if (!replySenderName.isEmpty()) {
-                QFont senderFont("Segoe UI", 9);
-                senderFont.setBold(true);
-                painter->setFont(senderFont);
-                painter->setPen(m_isDarkMode ? QColor("#60A5FA") : QColor("#2563EB"));
-                QFontMetrics senderFm(senderFont);
-                painter->drawText(replyX + 6, replyY + senderFm.ascent(), replySenderName);
-                replyY += senderFm.height() + 2;
-            }
-
-            painter->setPen(m_isDarkMode ? QColor("#666") : QColor("#ccc"));
-            painter->drawLine(replyX, replyY, replyX, replyY + 20);
-
-            QFont replyFont("Segoe UI", 9);
-            replyFont.setItalic(true);
-            painter->setFont(replyFont);
-            painter->setPen(m_isDarkMode ? QColor("#aaa") : QColor("#666"));
-
-            if (replyText.isEmpty()) {
-                replyText = "[Original message]";
-            }
-            QString replyPreview = replyText.length() > 40 ? replyText.left(40) + "..." : replyText;
-            QFontMetrics replyFm(replyFont);
-            painter->drawText(replyX + 6, replyY + replyFm.ascent() + 2, replyPreview);
-        }
-
-        painter->setPen(textColor);
-        QTextDocument doc;
-        QTextOption wrapOption;
-        wrapOption.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
-        doc.setDefaultTextOption(wrapOption);
-        QFont textFont("Segoe UI", 10);
-        doc.setDefaultFont(textFont);
-
-        QString html = QString("<div style=\"color:%1; white-space:pre-wrap; word-wrap:break-word;\">%2</div>")
-                           .arg(textColor.name(), text.toHtmlEscaped().replace("\n", "<br>"));
-        doc.setHtml(html);
-        doc.setTextWidth(textRect.width());
-
-        painter->translate(textRect.topLeft());
-        doc.drawContents(painter);
-        painter->translate(-textRect.topLeft());
-
-        QDateTime dt;
-        dt.setSecsSinceEpoch(timestamp);
-        QString timeStr = dt.toString("hh:mm AP");
-
-        painter->setPen(timeColor);
-        QFont timeFont = option.font;
-        timeFont.setPixelSize(9);
-        painter->setFont(timeFont);
-        QFontMetrics timeFm(timeFont);
-        int timeWidth = timeFm.horizontalAdvance(timeStr);
-
-        if (isMe) {
-            int statusInt = index.data(Qt::UserRole + 5).toInt();
-            MessageStatus status = static_cast<MessageStatus>(statusInt);
-
-            QFont statusFont("Segoe UI", 9);
-            painter->setFont(statusFont);
-            QFontMetrics fm(statusFont);
-
-            QString checkmark = QString(QChar(0x2713));
-            QString circle = QString(QChar(0x25CB));
-            bool hasCheckmark = fm.horizontalAdvance(checkmark) > 0;
-
-            QString statusIcon;
-            QColor statusColor = timeColor;
-            int iconX = 0;
-
-            if (status == MessageStatus::Pending) {
-                statusIcon = circle;
-                statusColor = QColor("#999999");
-            } else if (status == MessageStatus::Sent) {
-                statusIcon = hasCheckmark ? checkmark : "v";
-                statusColor = QColor("#999999");
-            } else if (status == MessageStatus::Seen) {
-                if (hasCheckmark) {
-                    painter->setPen(m_isDarkMode ? QColor("#93C5FD") : QColor("#60A5FA"));
-                    int singleWidth = fm.horizontalAdvance(checkmark);
-                    int overlapOffset = singleWidth / 2;
-                    iconX = bubbleRect.right() - 8 - timeWidth - 4 - singleWidth - overlapOffset;
-                    int iconY = bubbleRect.bottom() - 5 - timeFm.height();
-                    painter->drawText(iconX, iconY + fm.ascent(), checkmark);
-                    painter->drawText(iconX + overlapOffset, iconY + fm.ascent(), checkmark);
-                    statusIcon.clear();
-                } else {
-                    statusIcon = "vv";
-                    statusColor = m_isDarkMode ? QColor("#93C5FD") : QColor("#60A5FA");
-                }
-            }
-
-            if (!statusIcon.isEmpty()) {
-                painter->setPen(statusColor);
-                int iconWidth = fm.horizontalAdvance(statusIcon);
-                iconX = bubbleRect.right() - 8 - timeWidth - 4 - iconWidth;
-                int iconY = bubbleRect.bottom() - 5 - timeFm.height();
-                painter->drawText(iconX, iconY + fm.ascent(), statusIcon);
-            }
-        }
-
-        painter->setPen(timeColor);
-        painter->setFont(timeFont);
-        painter->drawText(bubbleRect.adjusted(0, 0, -8, -5), Qt::AlignBottom | Qt::AlignRight, timeStr);
-
-        qint64 editedAt = index.data(Qt::UserRole + 7).toLongLong();
-        if (editedAt > 0) {
-            QFont editedFont = timeFont;
-            editedFont.setItalic(true);
-            editedFont.setPixelSize(8);
-            painter->setFont(editedFont);
-            painter->setPen(QColor("#888888"));
-            QFontMetrics editedFm(editedFont);
-            QString editedText = "edited";
-            int editedWidth = editedFm.horizontalAdvance(editedText);
-            int editedX = bubbleRect.right() - 8 - editedWidth;
-            int editedY = bubbleRect.bottom() - 5 - timeFm.height() - editedFm.height() - 2;
-            painter->drawText(editedX, editedY + editedFm.ascent(), editedText);
-        }
-
-        painter->restore();
-    }
-
-    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override {
-        QString text = index.data(Qt::UserRole + 1).toString();
-        QString sender = index.data(Qt::UserRole + 2).toString();
-        bool isMe = index.data(Qt::UserRole + 4).toBool();
-        QString replyToId = index.data(Qt::UserRole + 9).toString();
-        bool hasReply = !replyToId.isEmpty();
-
-        QString replyText;
-        if (hasReply) {
-            replyText = index.data(Qt::UserRole + 10).toString();
-        }
-
-        QRect b, t, n, a, r;
-        int h;
-        int widthHint = option.rect.width();
-        if (widthHint <= 0 && option.widget) {
-            widthHint = option.widget->width();
-        }
-        if (widthHint <= 0) {
-            widthHint = 420;
-        }
-        getBubbleLayout(text, sender, isMe, widthHint, b, t, n, a, h, hasReply, replyText, r);
-        return QSize(widthHint, h);
-    }
-
-    bool editorEvent(QEvent* event, QAbstractItemModel* model, const QStyleOptionViewItem& option, const QModelIndex& index) override {
-        if (event->type() == QEvent::MouseButtonPress) {
-            QMouseEvent* mouseEvent = static_cast<QMouseEvent*>(event);
-            if (mouseEvent->button() == Qt::LeftButton) {
-                QString replyToId = index.data(Qt::UserRole + 9).toString();
-                if (!replyToId.isEmpty()) {
-                    QString text = index.data(Qt::UserRole + 1).toString();
-                    QString sender = index.data(Qt::UserRole + 2).toString();
-                    bool isMe = index.data(Qt::UserRole + 4).toBool();
-
-                    QRect bubbleRect, textRect, nameRect, avatarRect, replyQuoteRect;
-                    int neededHeight;
-                    QString replyText = index.data(Qt::UserRole + 10).toString();
-                    bool hasReply = true;
-
-                    const int viewWidth = option.widget ? option.widget->width() : option.rect.width();
-                    getBubbleLayout(text, sender, isMe, viewWidth,
-                                    bubbleRect, textRect, nameRect, avatarRect, neededHeight,
-                                    hasReply, replyText, replyQuoteRect);
-
-                    replyQuoteRect.translate(0, option.rect.top());
-                    if (replyQuoteRect.contains(mouseEvent->pos())) {
-                        if (m_mainWindow) {
-                            m_mainWindow->focusOnMessage(replyToId);
-                        }
-                        return true;
-                    }
-                }
-            }
-        }
-        return QStyledItemDelegate::editorEvent(event, model, option, index);
-    }
-};
-
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent),
       m_client(new WebSocketClient(this)),
+      m_store(new ChatStore(this)),
       m_nam(new QNetworkAccessManager(this)),
       m_restClient(new RestClient(this)),
       m_updaterService(new UpdaterService(this)),
-      m_voiceAudio(new VoiceAudioBridge(this))
+      m_voiceAudio(new VoiceAudioBridge(this)),
+      m_localStore(new LocalStore(this))
 {
+    m_startupClock.start();
     QSettings settings("Noveo", "MessengerClient");
     m_isDarkMode = settings.value("darkMode", false).toBool();
     m_notificationsEnabled = settings.value("notificationsEnabled", true).toBool();
@@ -669,6 +193,20 @@ MainWindow::MainWindow(QWidget* parent)
     m_messageResizeDebounceTimer->setSingleShot(true);
     m_messageResizeDebounceTimer->setInterval(45);
     connect(m_messageResizeDebounceTimer, &QTimer::timeout, this, &MainWindow::refreshMessageWidgetSizes);
+    m_messageMaterializeTimer = new QTimer(this);
+    m_messageMaterializeTimer->setSingleShot(true);
+    m_messageMaterializeTimer->setInterval(0);
+    connect(m_messageMaterializeTimer, &QTimer::timeout, this, &MainWindow::materializeVisibleMessageWidgets);
+    m_diagnosticsTimer = new QTimer(this);
+    m_diagnosticsTimer->setTimerType(Qt::PreciseTimer);
+    m_diagnosticsTimer->setInterval(DiagnosticsSampleIntervalMs);
+    connect(m_diagnosticsTimer, &QTimer::timeout, this, [this]() {
+        const qint64 lagMs = qMax<qint64>(0, m_diagnosticsTickClock.restart() - DiagnosticsSampleIntervalMs);
+        m_eventLoopLagPeakMs = qMax(m_eventLoopLagPeakMs, lagMs);
+        Metrics::set(Metrics::Gauge::EventLoopLagMs, lagMs);
+        Metrics::set(Metrics::Gauge::EventLoopLagPeakMs, m_eventLoopLagPeakMs);
+        sampleDiagnostics();
+    });
     m_reconnectTimer = new QTimer(this);
     m_reconnectTimer->setSingleShot(true);
     connect(m_reconnectTimer, &QTimer::timeout, this, [this]() {
@@ -677,59 +215,71 @@ MainWindow::MainWindow(QWidget* parent)
         }
     });
 
+    // Attached before the UI handlers so the store opens the account's
+    // database before MainWindow reacts to loginSuccess.
+    m_localStore->attach(m_client);
+    m_store->attach(m_client);
+    connect(m_localStore, &LocalStore::snapshotLoaded, this, &MainWindow::onLocalSnapshotLoaded);
+
     connect(m_client, &WebSocketClient::connected, this, &MainWindow::onConnected);
     connect(m_client, &WebSocketClient::disconnected, this, &MainWindow::onDisconnected);
     connect(m_client, &WebSocketClient::loginSuccess, this, &MainWindow::onLoginSuccess);
     connect(m_client, &WebSocketClient::authFailed, this, &MainWindow::onAuthFailed);
     connect(m_client, &WebSocketClient::chatHistoryReceived, this, &MainWindow::onChatHistoryReceived);
-    connect(m_client, &WebSocketClient::messageReceived, this, &MainWindow::onMessageReceived);
-    connect(m_client, &WebSocketClient::userListUpdated, this, &MainWindow::onUserListUpdated);
+    connect(m_client, &WebSocketClient::chatHistoryReceived, this, [this]() {
+        recordFirstRender(false);
+    });
+    connect(m_client, &WebSocketClient::chatDeltaReceived, this, &MainWindow::onChatDeltaReceived);
+    connect(m_client, &WebSocketClient::chatHistoryBatchReceived, this, &MainWindow::onChatHistoryBatchReceived);
+    connect(m_client, &WebSocketClient::outboxChanged, this, [this](const Outbox::Stats& stats) {
+        const int waiting = stats.queued + stats.inFlight;
+        if (waiting > 0 && !m_client->isConnected()) {
+            statusBar()->showMessage(QString("Offline: %1 change(s) will be sent when the connection returns.").arg(waiting), 5000);
+        }
+    });
+    connect(m_store, &ChatStore::messageAdded, this, &MainWindow::onMessageAdded);
+    connect(m_store, &ChatStore::usersReset, this, &MainWindow::onUsersReset);
+    connect(m_store, &ChatStore::userChanged, this, &MainWindow::onUserChanged);
+    connect(m_store, &ChatStore::messageStatusChanged, this, &MainWindow::updateMessageStatus);
+    connect(m_store, &ChatStore::messageEdited, this, &MainWindow::onMessageEdited);
+    connect(m_store, &ChatStore::messageRemoved, this, &MainWindow::onMessageRemoved);
     connect(m_client, &WebSocketClient::newChatCreated, this, &MainWindow::onNewChatCreated);
-    connect(m_client, &WebSocketClient::messageSeenUpdate, this, &MainWindow::onMessageSeenUpdate);
-    connect(m_client, &WebSocketClient::messageUpdated, this, &MainWindow::onMessageUpdated);
-    connect(m_client, &WebSocketClient::messageDeleted, this, &MainWindow::onMessageDeleted);
-    connect(m_client, &WebSocketClient::presenceUpdated, this, &MainWindow::onPresenceUpdated);
     connect(m_client, &WebSocketClient::typingReceived, this, &MainWindow::onTypingReceived);
     connect(m_client, &WebSocketClient::passwordChanged, this, &MainWindow::onPasswordChanged);
-    connect(m_client, &WebSocketClient::userUpdated, this, &MainWindow::onUserUpdated);
     connect(m_client, &WebSocketClient::channelInfoReceived, this, [this](const Chat& chat) {
-        const bool existed = m_chats.contains(chat.chatId);
-        m_chats[chat.chatId] = chat;
+        const bool existed = m_store->chats().contains(chat.chatId);
+        m_store->replaceChat(chat);
         if (!existed) {
             onNewChatCreated(chat);
         }
         m_currentChatId = chat.chatId;
-        m_chatTitle->setText(resolveChatName(m_chats[chat.chatId]));
+        m_chatTitle->setText(resolveChatName(m_store->chat(chat.chatId)));
         renderMessages(chat.chatId);
         updateComposerStateForCurrentChat();
         updatePinnedMessageBar();
     });
     connect(m_client, &WebSocketClient::memberJoined, this, [this](const QString& chatId, const QStringList& members) {
-        if (!m_chats.contains(chatId)) {
+        if (!m_store->setMembers(chatId, members)) {
             return;
         }
-        m_chats[chatId].members = members;
         if (m_currentChatId == chatId) {
-            m_chatTitle->setText(resolveChatName(m_chats[chatId]));
+            m_chatTitle->setText(resolveChatName(m_store->chat(chatId)));
             updateComposerStateForCurrentChat();
         }
     });
     connect(m_client, &WebSocketClient::messagePinned, this, [this](const QString& chatId, const Message& message) {
-        if (!m_chats.contains(chatId)) {
+        if (!m_store->setPinnedMessage(chatId, message)) {
             return;
         }
-        m_chats[chatId].hasPinnedMessage = true;
-        m_chats[chatId].pinnedMessage = message;
         if (m_currentChatId == chatId) {
             updatePinnedMessageBar();
             statusBar()->showMessage("Pinned message updated.", 2000);
         }
     });
     connect(m_client, &WebSocketClient::messageUnpinned, this, [this](const QString& chatId) {
-        if (!m_chats.contains(chatId)) {
+        if (!m_store->clearPinnedMessage(chatId)) {
             return;
         }
-        m_chats[chatId].hasPinnedMessage = false;
         if (m_currentChatId == chatId) {
             updatePinnedMessageBar();
             statusBar()->showMessage("Message unpinned.", 2000);
@@ -768,9 +318,9 @@ MainWindow::MainWindow(QWidget* parent)
         if (answer != QMessageBox::Yes) {
             return;
         }
-        if (m_chats.contains(chatId)) {
+        if (m_store->chats().contains(chatId)) {
             m_currentChatId = chatId;
-            m_chatTitle->setText(resolveChatName(m_chats[chatId]));
+            m_chatTitle->setText(resolveChatName(m_store->chat(chatId)));
             renderMessages(chatId);
             updateComposerStateForCurrentChat();
             updatePinnedMessageBar();
@@ -784,9 +334,9 @@ MainWindow::MainWindow(QWidget* parent)
             m_voiceCallBtn->setText("Leave Voice");
         }
     });
-    connect(m_client, &WebSocketClient::binaryAudioReceived, this, [this](const QString&, const QByteArray& payload) {
+    connect(m_client, &WebSocketClient::binaryAudioReceived, this, [this](const QString& userId, const QByteArray& payload) {
         if (m_voiceAudio && !m_currentVoiceChatId.isEmpty()) {
-            m_voiceAudio->playPcm(payload);
+            m_voiceAudio->playPcm(userId, payload);
         }
     });
     connect(m_voiceAudio, &VoiceAudioBridge::pcmCaptured, this, [this](const QByteArray& payload) {
@@ -799,6 +349,15 @@ MainWindow::MainWindow(QWidget* parent)
     });
 
     m_statusLabel->setText("Connecting to server...");
+
+    // A session that will be resumed can show its chats from disk right away;
+    // chat_history reconciles them once the server answers.
+    const SessionData savedSession = SessionStore::load();
+    if (savedSession.isPresent() && autoSessionReconnectEnabled()) {
+        m_localStore->open(savedSession.userId);
+        m_localStore->loadSnapshot();
+    }
+
     m_client->connectToServer();
 }
 
@@ -1051,10 +610,10 @@ void MainWindow::setupUi() {
             return;
         }
         const QString chatId = item->data(Qt::UserRole).toString();
-        if (!m_chats.contains(chatId)) {
+        if (!m_store->chats().contains(chatId)) {
             return;
         }
-        const Chat& chat = m_chats[chatId];
+        const Chat& chat = m_store->chat(chatId);
         const bool canManage = (chat.ownerId == m_client->currentUserId()) &&
                                (chat.chatType == "group" || chat.chatType == "channel");
         if (!canManage) {
@@ -1250,14 +809,23 @@ void MainWindow::setupUi() {
     pinnedLayout->addWidget(m_openPinnedBtn);
     pinnedLayout->addWidget(m_unpinPinnedBtn);
 
-    m_chatList = new QListWidget();
+    m_chatList = new QListView();
     m_chatList->setObjectName("chatList");
+    m_messageModel = new MessageListModel(m_store, m_chatList);
+    m_messageModel->setRowDecorator([this](const Message& msg) { return buildMessageRow(msg); });
+    m_messageDelegate = new MessageDelegate(m_chatList);
+    m_chatList->setModel(m_messageModel);
+    m_chatList->setItemDelegate(m_messageDelegate);
+    m_messageWidgetPool = new MessageWidgetPool(m_chatList->viewport(), MessageWidgetPoolSize, m_chatList);
+    m_messageDelegate->setWidgetPool(m_messageWidgetPool);
     m_chatList->setFrameShape(QFrame::NoFrame);
     m_chatList->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
     m_chatList->setUniformItemSizes(false);
     m_chatList->setResizeMode(QListView::Adjust);
-    m_chatList->setLayoutMode(QListView::Batched);
-    m_chatList->setBatchSize(36);
+    // The model holds a bounded window of rows (MessageWindowRows plus what
+    // was scrolled into), so one synchronous pass stays cheap and keeps the
+    // bottom anchoring below exact.
+    m_chatList->setLayoutMode(QListView::SinglePass);
     m_chatList->setSelectionMode(QAbstractItemView::NoSelection);
     m_chatList->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     m_chatList->setSpacing(2);
@@ -1266,9 +834,13 @@ void MainWindow::setupUi() {
     m_chatList->setWordWrap(true);
 
     m_chatList->setContextMenuPolicy(Qt::CustomContextMenu);
-    connect(m_chatList, &QListWidget::customContextMenuRequested, this, &MainWindow::onChatListContextMenu);
-    connect(m_chatList, &QListWidget::clicked, this, &MainWindow::onChatListItemClicked);
+    connect(m_chatList, &QListView::customContextMenuRequested, this, &MainWindow::onChatListContextMenu);
+    connect(m_chatList, &QListView::clicked, this, &MainWindow::onChatListItemClicked);
     connect(m_chatList->verticalScrollBar(), &QScrollBar::valueChanged, this, &MainWindow::onScrollValueChanged);
+    connect(m_chatList->verticalScrollBar(), &QScrollBar::valueChanged, this, &MainWindow::scheduleMessageWidgetMaterialization);
+    connect(m_chatList->verticalScrollBar(), &QScrollBar::rangeChanged, this, &MainWindow::scheduleMessageWidgetMaterialization);
+    connect(m_messageModel, &QAbstractItemModel::rowsInserted, this, &MainWindow::scheduleMessageWidgetMaterialization);
+    connect(m_messageModel, &QAbstractItemModel::modelReset, this, &MainWindow::scheduleMessageWidgetMaterialization);
 
     m_replyBar = new QWidget();
     m_replyBar->setObjectName("replyBar");
@@ -1552,8 +1124,8 @@ void MainWindow::setupUi() {
         statusBar()->showMessage("Join request sent.", 2000);
     });
     connect(m_openPinnedBtn, &QPushButton::clicked, this, [this]() {
-        if (!m_currentChatId.isEmpty() && m_chats.contains(m_currentChatId) && m_chats[m_currentChatId].hasPinnedMessage) {
-            focusOnMessage(m_chats[m_currentChatId].pinnedMessage.messageId);
+        if (!m_currentChatId.isEmpty() && m_store->chats().contains(m_currentChatId) && m_store->chat(m_currentChatId).hasPinnedMessage) {
+            focusOnMessage(m_store->chat(m_currentChatId).pinnedMessage.messageId);
         }
     });
     connect(m_unpinPinnedBtn, &QPushButton::clicked, this, [this]() {
@@ -1561,7 +1133,18 @@ void MainWindow::setupUi() {
             m_client->unpinMessage(m_currentChatId);
         }
     });
+    connect(m_restClient, &RestClient::uploadProgress, this, [this](QNetworkReply* reply, qint64 bytesSent, qint64 bytesTotal) {
+        if (reply != m_activeUpload || bytesTotal <= 0) {
+            return;
+        }
+        const int percent = static_cast<int>((bytesSent * 100) / bytesTotal);
+        statusBar()->showMessage(QString("Uploading file... %1% (click + to cancel)").arg(percent));
+    });
     connect(m_attachBtn, &QPushButton::clicked, this, [this]() {
+        if (m_activeUpload) {
+            m_restClient->cancelUpload(m_activeUpload);
+            return;
+        }
         if (m_currentChatId.isEmpty()) {
             return;
         }
@@ -1586,9 +1169,19 @@ void MainWindow::setupUi() {
             statusBar()->showMessage("Could not open selected file.", 4000);
             return;
         }
+        m_activeUpload = reply;
+        m_attachBtn->setToolTip("Cancel upload");
 
         connect(reply, &QNetworkReply::finished, this, [this, reply, targetChatId, targetReplyId, typedText]() {
             reply->deleteLater();
+            if (m_activeUpload == reply) {
+                m_activeUpload = nullptr;
+                m_attachBtn->setToolTip("Attach file");
+            }
+            if (reply->error() == QNetworkReply::OperationCanceledError) {
+                statusBar()->showMessage("Upload cancelled.", 3000);
+                return;
+            }
             if (reply->error() != QNetworkReply::NoError) {
                 statusBar()->showMessage("Upload failed: " + reply->errorString(), 5000);
                 return;
@@ -1613,7 +1206,7 @@ void MainWindow::setupUi() {
 
             const QString recipientId = resolveRecipientIdForChat(targetChatId);
 
-            m_client->sendMessagePayload(targetChatId, content, targetReplyId, recipientId);
+            const QString clientMessageId = m_client->sendMessagePayload(targetChatId, content, targetReplyId, recipientId);
 
             Message pendingMsg;
             pendingMsg.messageId = "temp_" + QUuid::createUuid().toString(QUuid::WithoutBraces);
@@ -1629,7 +1222,9 @@ void MainWindow::setupUi() {
             pendingMsg.file.size = static_cast<qint64>(fileObj.value("size").toDouble());
             pendingMsg.text = typedText;
 
-            m_pendingMessages[pendingMsg.messageId] = pendingMsg;
+            pendingMsg.clientMessageId = clientMessageId;
+
+            m_store->trackPending(pendingMsg);
             if (m_currentChatId == targetChatId) {
                 addMessageBubble(pendingMsg, false, false);
                 smoothScrollToBottom();
@@ -1709,7 +1304,7 @@ void MainWindow::setupUi() {
             content.insert("theme", QJsonValue::Null);
 
             const QString recipientId = resolveRecipientIdForChat(targetChatId);
-            m_client->sendMessagePayload(targetChatId, content, targetReplyId, recipientId);
+            const QString clientMessageId = m_client->sendMessagePayload(targetChatId, content, targetReplyId, recipientId);
 
             Message pendingMsg;
             pendingMsg.messageId = "temp_" + QUuid::createUuid().toString(QUuid::WithoutBraces);
@@ -1725,7 +1320,9 @@ void MainWindow::setupUi() {
             pendingMsg.file.size = static_cast<qint64>(fileObj.value("size").toDouble());
             pendingMsg.text = typedText;
 
-            m_pendingMessages[pendingMsg.messageId] = pendingMsg;
+            pendingMsg.clientMessageId = clientMessageId;
+
+            m_store->trackPending(pendingMsg);
             if (m_currentChatId == targetChatId) {
                 addMessageBubble(pendingMsg, false, false);
                 smoothScrollToBottom();
@@ -1887,8 +1484,8 @@ void MainWindow::setupUi() {
     connect(m_settingsDialog, &SettingsDialog::notificationsToggled, this, &MainWindow::onNotificationsToggled);
     connect(m_settingsDialog, &SettingsDialog::blockGroupInvitesToggled, this, [this](bool checked) {
         const QString selfId = m_client ? m_client->currentUserId() : QString();
-        if (!selfId.isEmpty() && m_users.contains(selfId)) {
-            m_users[selfId].blockGroupInvites = checked;
+        if (!selfId.isEmpty()) {
+            m_store->setBlockGroupInvites(selfId, checked);
         }
         QNetworkReply* reply = m_restClient->updatePrivacy(checked);
         if (!reply) {
@@ -1904,6 +1501,16 @@ void MainWindow::setupUi() {
             statusBar()->showMessage("Privacy updated.", 2000);
         });
     });
+    connect(m_settingsDialog, &SettingsDialog::diagnosticsActiveChanged, this, [this](bool active) {
+        if (!active) {
+            m_diagnosticsTimer->stop();
+            return;
+        }
+        m_eventLoopLagPeakMs = 0;
+        sampleDiagnostics();
+        m_diagnosticsTickClock.start();
+        m_diagnosticsTimer->start();
+    });
     connect(m_settingsDialog, &SettingsDialog::checkForUpdatesRequested, m_updaterService, &UpdaterService::checkForUpdates);
     connect(m_settingsDialog, &SettingsDialog::downloadUpdateRequested, m_updaterService, &UpdaterService::downloadUpdate);
     connect(m_settingsDialog, &SettingsDialog::installUpdateRequested, m_updaterService, &UpdaterService::restartAndInstall);
@@ -1949,6 +1556,7 @@ void MainWindow::setupUi() {
 }
 
 void MainWindow::applyTheme() {
+    NOVEO_TRACE_SCOPE("MainWindow::applyTheme");
     QString bg = m_isDarkMode ? "#1e1e1e" : "#f5f5f5";
     QString panelBg = m_isDarkMode ? "#2d2d2d" : "#ffffff";
     QString text = m_isDarkMode ? "#ffffff" : "#000000";
@@ -2045,6 +1653,9 @@ void MainWindow::applyTheme() {
         m_settingsOverlay->setStyleSheet(QStringLiteral("QWidget#settingsOverlay { background: rgba(15, 23, 42, 120); }"));
     }
 
+    if (m_messageDelegate) {
+        m_messageDelegate->setTheme(m_isDarkMode);
+    }
     for (auto it = m_messageWidgetsById.begin(); it != m_messageWidgetsById.end(); ++it) {
         if (it.value()) {
             it.value()->setTheme(m_isDarkMode);
@@ -2054,9 +1665,13 @@ void MainWindow::applyTheme() {
 }
 
 void MainWindow::onScrollValueChanged(int value) {
+    NOVEO_TRACE_SCOPE("MainWindow::onScrollValueChanged");
     if (value == 0 && !m_isLoadingHistory && !m_currentChatId.isEmpty()) {
-        if (m_chats.contains(m_currentChatId)) {
-            const auto& msgs = m_chats[m_currentChatId].messages;
+        if (revealOlderMessages()) {
+            return;
+        }
+        if (m_store->chats().contains(m_currentChatId)) {
+            const auto& msgs = m_store->chat(m_currentChatId).messages;
             if (!msgs.empty()) {
                 qint64 oldestTime = msgs.front().timestamp;
                 m_isLoadingHistory = true;
@@ -2067,6 +1682,7 @@ void MainWindow::onScrollValueChanged(int value) {
 }
 
 void MainWindow::onDarkModeToggled(bool checked) {
+    NOVEO_TRACE_SCOPE("MainWindow::onDarkModeToggled");
     m_isDarkMode = checked;
     QSettings settings("Noveo", "MessengerClient");
     settings.setValue("darkMode", m_isDarkMode);
@@ -2094,6 +1710,7 @@ void MainWindow::onDarkModeToggled(bool checked) {
 }
 
 void MainWindow::onLogoutClicked() {
+    NOVEO_TRACE_SCOPE("MainWindow::onLogoutClicked");
     m_manualDisconnect = true;
     if (m_reconnectTimer) {
         m_reconnectTimer->stop();
@@ -2113,6 +1730,9 @@ void MainWindow::onLogoutClicked() {
         m_voiceCallBtn->setText("Voice");
         m_voiceCallBtn->setEnabled(false);
     }
+    if (m_activeUpload) {
+        m_restClient->cancelUpload(m_activeUpload);
+    }
     if (m_attachBtn) {
         m_attachBtn->setEnabled(false);
     }
@@ -2152,6 +1772,8 @@ void MainWindow::onLogoutClicked() {
     }
 
     SessionStore::clear();
+    m_localStore->wipe();
+    m_chatsFromLocalStore = false;
     m_authToken.clear();
     m_authExpiresAt = 0;
     m_restClient->clearAuthContext();
@@ -2167,22 +1789,16 @@ void MainWindow::onLogoutClicked() {
     if (m_authFormsStack) {
         m_authFormsStack->setCurrentIndex(0);
     }
-    m_chats.clear();
-    m_users.clear();
+    m_store->clear();
     m_stickerCache.clear();
     m_currentChatId.clear();
     m_isLoadingHistory = false;
-    m_avatarCache.clear();
+    MediaCache::instance()->clearMemory();
     m_pendingDownloads.clear();
 
     m_chatListWidget->clear();
     m_contactListWidget->clear();
-    m_chatList->clear();
-    m_messageItemsById.clear();
-    m_messageWidgetsById.clear();
-    m_currentMessagePreviewById.clear();
-    m_currentMessageSenderById.clear();
-    m_lastMessageViewportWidth = -1;
+    clearMessageView();
     m_chatTitle->setText("Select a chat");
     if (m_chatSettingsBtn) {
         m_chatSettingsBtn->setVisible(false);
@@ -2200,10 +1816,14 @@ void MainWindow::onLogoutClicked() {
     });
 }
 
+bool MainWindow::autoSessionReconnectEnabled() const
+{
+    return qEnvironmentVariableIntValue("NOVEO_ENABLE_AUTO_SESSION_RECONNECT") == 1;
+}
+
 void MainWindow::tryReconnectWithSavedSession()
 {
-    const bool autoSessionReconnectEnabled = qEnvironmentVariableIntValue("NOVEO_ENABLE_AUTO_SESSION_RECONNECT") == 1;
-    if (!autoSessionReconnectEnabled) {
+    if (!autoSessionReconnectEnabled()) {
         return;
     }
 
@@ -2219,11 +1839,22 @@ void MainWindow::tryReconnectWithSavedSession()
     m_waitingForSessionReconnectResult = true;
     m_blockAutoSessionReconnect = true; // one-shot until explicit auth succeeds
     m_statusLabel->setText("Reconnecting session...");
-    m_client->reconnectWithToken(session.userId, session.token);
+    m_client->reconnectWithToken(session.userId, session.token, syncCursors());
+}
+
+QHash<QString, qint64> MainWindow::syncCursors() const
+{
+    QHash<QString, qint64> cursors;
+    cursors.reserve(m_store->chats().size());
+    for (auto it = m_store->chats().constBegin(); it != m_store->chats().constEnd(); ++it) {
+        cursors.insert(it.key(), it->syncCursor());
+    }
+    return cursors;
 }
 
 void MainWindow::onDisconnected()
 {
+    NOVEO_TRACE_SCOPE("MainWindow::onDisconnected");
     if (m_manualDisconnect) {
         return;
     }
@@ -2233,6 +1864,7 @@ void MainWindow::onDisconnected()
         m_hasAuthenticatedSession = false;
         m_blockAutoSessionReconnect = true;
         SessionStore::clear();
+        discardLocalPreload();
         m_restClient->clearAuthContext();
         m_authToken.clear();
         m_authExpiresAt = 0;
@@ -2296,6 +1928,7 @@ void MainWindow::onDisconnected()
         m_statusLabel->setStyleSheet("color: #ef4444;");
         m_statusLabel->setText("Connection lost. Please log in again.");
         SessionStore::clear();
+        discardLocalPreload();
         m_restClient->clearAuthContext();
         m_authToken.clear();
         m_authExpiresAt = 0;
@@ -2332,6 +1965,7 @@ void MainWindow::onDisconnected()
 }
 
 void MainWindow::onConnected() {
+    NOVEO_TRACE_SCOPE("MainWindow::onConnected");
     if (m_reconnectTimer) {
         m_reconnectTimer->stop();
     }
@@ -2354,6 +1988,7 @@ void MainWindow::onConnected() {
 }
 
 void MainWindow::onLoginBtnClicked() {
+    NOVEO_TRACE_SCOPE("MainWindow::onLoginBtnClicked");
     QString user = m_usernameInput->text().trimmed();
     QString pass = m_passwordInput->text();
 
@@ -2380,6 +2015,7 @@ void MainWindow::onLoginBtnClicked() {
 
 void MainWindow::onRegisterBtnClicked()
 {
+    NOVEO_TRACE_SCOPE("MainWindow::onRegisterBtnClicked");
     const QString user = m_registerUsernameInput->text().trimmed();
     const QString pass = m_registerPasswordInput->text();
     if (user.isEmpty() || pass.isEmpty()) {
@@ -2409,6 +2045,7 @@ void MainWindow::onRegisterBtnClicked()
 }
 
 void MainWindow::onLoginSuccess(const User& user, const QString& token, qint64 expiresAt) {
+    NOVEO_TRACE_SCOPE("MainWindow::onLoginSuccess");
     m_manualDisconnect = false;
     m_reconnectAttempts = 0;
     m_waitingForSessionReconnectResult = false;
@@ -2448,9 +2085,13 @@ void MainWindow::onLoginSuccess(const User& user, const QString& token, qint64 e
     m_stackedWidget->setCurrentWidget(m_appPage);
     updateComposerStateForCurrentChat();
     updatePinnedMessageBar();
+    if (m_store->chats().isEmpty()) {
+        m_localStore->loadSnapshot();
+    }
 }
 
 void MainWindow::onAuthFailed(const QString& msg) {
+    NOVEO_TRACE_SCOPE("MainWindow::onAuthFailed");
     if (m_reconnectTimer) {
         m_reconnectTimer->stop();
     }
@@ -2460,6 +2101,7 @@ void MainWindow::onAuthFailed(const QString& msg) {
     m_hasAuthenticatedSession = false;
     m_blockAutoSessionReconnect = reconnectFailure;
     SessionStore::clear();
+    discardLocalPreload();
     m_restClient->clearAuthContext();
     m_authToken.clear();
     m_authExpiresAt = 0;
@@ -2479,14 +2121,7 @@ void MainWindow::onAuthFailed(const QString& msg) {
     if (m_chatSettingsDialog) {
         m_chatSettingsDialog->hide();
     }
-    if (m_chatList) {
-        m_chatList->clear();
-    }
-    m_messageItemsById.clear();
-    m_messageWidgetsById.clear();
-    m_currentMessagePreviewById.clear();
-    m_currentMessageSenderById.clear();
-    m_lastMessageViewportWidth = -1;
+    clearMessageView();
     updateComposerStateForCurrentChat();
     updatePinnedMessageBar();
     m_statusLabel->setStyleSheet("color: #ef4444;");
@@ -2502,17 +2137,16 @@ void MainWindow::onAuthFailed(const QString& msg) {
     }
 }
 
-void MainWindow::onUserListUpdated(const std::vector<User>& users) {
-    m_users.clear();
+void MainWindow::onUsersReset() {
+    NOVEO_TRACE_SCOPE("MainWindow::onUsersReset");
     m_contactListWidget->clear();
 
-    std::vector<User> sortedUsers = users;
+    std::vector<User> sortedUsers(m_store->users().cbegin(), m_store->users().cend());
     std::sort(sortedUsers.begin(), sortedUsers.end(), [](const User& a, const User& b) {
         return a.username.toLower() < b.username.toLower();
     });
 
     for (const auto& u : sortedUsers) {
-        m_users.insert(u.userId, u);
         if (u.userId == m_client->currentUserId()) continue;
 
         QListWidgetItem* item = new QListWidgetItem(m_contactListWidget);
@@ -2530,9 +2164,9 @@ void MainWindow::onUserListUpdated(const std::vector<User>& users) {
     for (int i = 0; i < m_chatListWidget->count(); i++) {
         QListWidgetItem* item = m_chatListWidget->item(i);
         QString chatId = item->data(Qt::UserRole).toString();
-        if (m_chats.contains(chatId)) {
-            QString name = resolveChatName(m_chats[chatId]);
-            QString fullUrl = m_chats[chatId].avatarUrl;
+        if (m_store->chats().contains(chatId)) {
+            QString name = resolveChatName(m_store->chat(chatId));
+            QString fullUrl = m_store->chat(chatId).avatarUrl;
             if (!fullUrl.startsWith("http")) {
                  fullUrl = API_BASE_URL + fullUrl;
             }
@@ -2542,90 +2176,119 @@ void MainWindow::onUserListUpdated(const std::vector<User>& users) {
         }
     }
 
-    if (m_settingsDialog && m_users.contains(m_client->currentUserId())) {
-        m_settingsDialog->setBlockGroupInvites(m_users[m_client->currentUserId()].blockGroupInvites);
+    if (m_settingsDialog && m_store->users().contains(m_client->currentUserId())) {
+        m_settingsDialog->setBlockGroupInvites(m_store->user(m_client->currentUserId()).blockGroupInvites);
     }
-    if (!m_currentChatId.isEmpty() && m_chats.contains(m_currentChatId)) {
+    if (!m_currentChatId.isEmpty() && m_store->chats().contains(m_currentChatId)) {
         renderMessages(m_currentChatId);
     }
 }
 
 void MainWindow::onChatHistoryReceived(const std::vector<Chat>& incomingChats) {
-    bool initialLoad = m_chats.isEmpty();
-
-    for (const auto& inChat : incomingChats) {
-        if (m_chats.contains(inChat.chatId)) {
-            Chat& existingChat = m_chats[inChat.chatId];
-            QSet<QString> existingIds;
-            for (const auto& m : existingChat.messages) existingIds.insert(m.messageId);
-
-            std::vector<Message> newMessages;
-            for (const auto& m : inChat.messages) {
-                if (!existingIds.contains(m.messageId)) {
-                    newMessages.push_back(m);
-                }
-            }
+    NOVEO_TRACE_SCOPE("MainWindow::onChatHistoryReceived");
+    // The first history after a local preload is authoritative: server
+    // metadata and message copies replace the disk ones, chats and messages
+    // the server no longer has are dropped, and the chat list is rebuilt.
+    const bool reconciling = m_chatsFromLocalStore;
+    m_chatsFromLocalStore = false;
+    const ChatStore::HistoryResult result = m_store->applyHistory(incomingChats, reconciling);
+    for (auto it = result.prunedMessageIds.constBegin(); it != result.prunedMessageIds.constEnd(); ++it) {
+        m_localStore->removeMessages(it.key(), it.value());
+    }
+    const bool currentChatReconciled = result.reconciledChatIds.contains(m_currentChatId);
+
+    const auto added = result.addedMessages.constFind(m_currentChatId);
+    if (added != result.addedMessages.constEnd() && m_isLoadingHistory) {
+        m_isLoadingHistory = false;
 
-            if (!newMessages.empty()) {
-                existingChat.messages.insert(existingChat.messages.end(), newMessages.begin(), newMessages.end());
-                std::sort(existingChat.messages.begin(), existingChat.messages.end(), [](const Message& a, const Message& b) {
-                    return a.timestamp < b.timestamp;
-                });
+        prependMessageBubbles(*added);
+    }
 
-                if (m_currentChatId == inChat.chatId && m_isLoadingHistory) {
-                    m_isLoadingHistory = false;
+    if (result.initialLoad) {
+        m_chatListWidget->clear();
+        std::vector<const Chat*> sortedChats;
+        for (const Chat& chat : m_store->chats()) sortedChats.push_back(&chat);
 
-                    std::sort(newMessages.begin(), newMessages.end(), [](const Message& a, const Message& b) {
-                        return a.timestamp < b.timestamp;
-                    });
+        std::sort(sortedChats.begin(), sortedChats.end(), [](const Chat* a, const Chat* b) {
+            qint64 timeA = a->messages.empty() ? 0 : a->messages.back().timestamp;
+            qint64 timeB = b->messages.empty() ? 0 : b->messages.back().timestamp;
+            return timeA > timeB;
+        });
 
-                    int oldMax = m_chatList->verticalScrollBar()->maximum();
-                    m_chatList->setUpdatesEnabled(false);
-                    for (auto it = newMessages.rbegin(); it != newMessages.rend(); ++it) {
-                        prependMessageBubble(*it);
-                    }
-                    m_chatList->setUpdatesEnabled(true);
-                    int newMax = m_chatList->verticalScrollBar()->maximum();
-                    m_chatList->verticalScrollBar()->setValue(newMax - oldMax);
-                }
+        for (const Chat* chatPtr : sortedChats) {
+            const Chat& chat = *chatPtr;
+            QListWidgetItem* item = createChatListItem(chat);
+            m_chatListWidget->addItem(item);
+            if (chat.chatId == m_currentChatId) {
+                m_chatListWidget->setCurrentItem(item);
             }
-        } else {
-            m_chats.insert(inChat.chatId, inChat);
         }
+        recordFirstChatRow();
     }
 
-    if (initialLoad) {
-        m_chatListWidget->clear();
-        std::vector<Chat> sortedChats;
-        for (auto k : m_chats.keys()) sortedChats.push_back(m_chats[k]);
+    if (reconciling && !m_currentChatId.isEmpty()) {
+        if (!m_store->chats().contains(m_currentChatId)) {
+            m_currentChatId.clear();
+            m_chatTitle->setText("Select a chat");
+            clearMessageView();
+        } else if (currentChatReconciled) {
+            m_chatTitle->setText(resolveChatName(m_store->chat(m_currentChatId)));
+            renderMessages(m_currentChatId);
+        }
+    }
 
-        std::sort(sortedChats.begin(), sortedChats.end(), [](const Chat& a, const Chat& b) {
-            qint64 timeA = a.messages.empty() ? 0 : a.messages.back().timestamp;
-            qint64 timeB = b.messages.empty() ? 0 : b.messages.back().timestamp;
-            return timeA > timeB;
-        });
+    if (!m_currentChatId.isEmpty()) {
+        updateComposerStateForCurrentChat();
+        updatePinnedMessageBar();
+    }
+    if (m_isLoadingHistory) {
+        m_isLoadingHistory = false;
+    }
+}
 
-        for (const auto& chat : sortedChats) {
-            QListWidgetItem* item = new QListWidgetItem(m_chatListWidget);
-            QString name = resolveChatName(chat);
-            QString url = chat.avatarUrl;
+void MainWindow::onChatDeltaReceived(const std::vector<Chat>& deltas)
+{
+    NOVEO_TRACE_SCOPE("MainWindow::onChatDeltaReceived");
+    // A delta confirms the held state, so any local preload counts as reconciled.
+    m_chatsFromLocalStore = false;
 
-            if (chat.chatType == "private" && url.isEmpty()) {
-                for (const auto& memberId : chat.members) {
-                    if (memberId != m_client->currentUserId() && m_users.contains(memberId)) {
-                        url = m_users[memberId].avatarUrl;
-                        break;
-                    }
-                }
-            }
+    for (const Chat& delta : deltas) {
+        if (!m_store->chats().contains(delta.chatId)) {
+            onNewChatCreated(delta);
+            continue;
+        }
 
-            if (url.startsWith("/")) url = API_BASE_URL + url;
+        const ChatStore::DeltaResult result = m_store->applyDelta(delta);
+        if (result.firstAdded < 0) {
+            continue;
+        }
 
-            item->setText(name);
-            item->setData(Qt::UserRole, chat.chatId);
-            item->setData(AvatarUrlRole, url);
-            item->setIcon(getAvatar(name, url));
-            m_chatListWidget->addItem(item);
+        for (int i = 0; i < m_chatListWidget->count(); ++i) {
+            if (m_chatListWidget->item(i)->data(Qt::UserRole).toString() == delta.chatId) {
+                m_chatListWidget->insertItem(0, m_chatListWidget->takeItem(i));
+                break;
+            }
+        }
+
+        if (delta.chatId != m_currentChatId) {
+            continue;
+        }
+        if (result.firstAdded < result.previousSize) {
+            // Something landed before already-rendered rows.
+            renderMessages(delta.chatId);
+            continue;
+        }
+        const Chat& chat = m_store->chat(delta.chatId);
+        const bool wasAtBottom = isScrolledToBottom();
+        for (int i = result.firstAdded; i < static_cast<int>(chat.messages.size()); ++i) {
+            const Message msg = chat.messages[static_cast<size_t>(i)];
+            addMessageBubble(msg, false, false);
+            if (msg.senderId != m_client->currentUserId()) {
+                m_client->sendMessageSeen(msg.chatId.isEmpty() ? delta.chatId : msg.chatId, msg.messageId);
+            }
+        }
+        if (wasAtBottom) {
+            smoothScrollToBottom();
         }
     }
 
@@ -2633,33 +2296,185 @@ void MainWindow::onChatHistoryReceived(const std::vector<Chat>& incomingChats) {
         updateComposerStateForCurrentChat();
         updatePinnedMessageBar();
     }
-    if (m_isLoadingHistory) {
-        m_isLoadingHistory = false;
+}
+
+void MainWindow::onLocalSnapshotLoaded(const LocalStore::Snapshot& snapshot)
+{
+    NOVEO_TRACE_SCOPE("MainWindow::onLocalSnapshotLoaded");
+    // Too late (the server already delivered) or nothing stored yet.
+    if (!m_store->chats().isEmpty() || snapshot.chats.empty()) {
+        return;
+    }
+    if (m_client->currentUserId().isEmpty()) {
+        if (snapshot.currentUser.userId != snapshot.accountId) {
+            return;
+        }
+        m_client->setCachedUser(snapshot.currentUser);
+    }
+
+    m_store->setUsers(snapshot.users);
+    onChatHistoryReceived(snapshot.chats);
+    m_chatsFromLocalStore = true;
+    m_stackedWidget->setCurrentWidget(m_appPage);
+
+    for (int i = 0; i < m_chatListWidget->count(); ++i) {
+        QListWidgetItem* item = m_chatListWidget->item(i);
+        if (item->data(Qt::UserRole).toString() == snapshot.lastOpenChatId) {
+            m_chatListWidget->setCurrentItem(item);
+            onChatSelected(item);
+            break;
+        }
     }
+    recordFirstRender(true);
 }
 
-void MainWindow::onNewChatCreated(const Chat& chat) {
-    if (!m_chats.contains(chat.chatId)) {
-        m_chats.insert(chat.chatId, chat);
-        QListWidgetItem* item = new QListWidgetItem(m_chatListWidget);
-
-        QString name = resolveChatName(chat);
-        QString url = chat.avatarUrl;
-        if (chat.chatType == "private" && url.isEmpty()) {
-            for (const auto& memberId : chat.members) {
-                if (memberId != m_client->currentUserId() && m_users.contains(memberId)) {
-                    url = m_users[memberId].avatarUrl;
-                    break;
-                }
+void MainWindow::discardLocalPreload()
+{
+    m_localStore->close();
+    if (!m_chatsFromLocalStore) {
+        return;
+    }
+    m_chatsFromLocalStore = false;
+    m_store->clear();
+    m_currentChatId.clear();
+    m_chatListWidget->clear();
+    m_contactListWidget->clear();
+    clearMessageView();
+    m_chatTitle->setText("Select a chat");
+}
+
+QListWidgetItem* MainWindow::createChatListItem(const Chat& chat)
+{
+    const QString name = resolveChatName(chat);
+    QString url = chat.avatarUrl;
+    if (chat.chatType == "private" && url.isEmpty()) {
+        for (const auto& memberId : chat.members) {
+            if (memberId != m_client->currentUserId() && m_store->users().contains(memberId)) {
+                url = m_store->user(memberId).avatarUrl;
+                break;
             }
         }
-        if (url.startsWith("/")) url = API_BASE_URL + url;
+    }
+    if (url.startsWith("/")) url = API_BASE_URL + url;
 
-        item->setText(name);
-        item->setData(Qt::UserRole, chat.chatId);
-        item->setData(AvatarUrlRole, url);
-        item->setIcon(getAvatar(name, url));
-        m_chatListWidget->insertItem(0, item);
+    auto* item = new QListWidgetItem();
+    item->setText(name);
+    item->setData(Qt::UserRole, chat.chatId);
+    item->setData(AvatarUrlRole, url);
+    item->setIcon(getAvatar(name, url));
+    return item;
+}
+
+void MainWindow::onChatHistoryBatchReceived(const std::vector<Chat>& batch, bool first, bool last)
+{
+    NOVEO_TRACE_SCOPE("MainWindow::onChatHistoryBatchReceived");
+    if (first) {
+        // Only a cold start fills the sidebar batch by batch. Reconciling a
+        // local preload, or merging into chats already held, needs the
+        // complete list, so those batches are collected and applied at once.
+        m_progressiveHistory = m_store->chats().isEmpty() && !m_chatsFromLocalStore;
+        m_deferredHistory.clear();
+        if (m_progressiveHistory) {
+            m_chatListWidget->clear();
+        }
+    }
+
+    if (!m_progressiveHistory) {
+        m_deferredHistory.insert(m_deferredHistory.end(), batch.begin(), batch.end());
+        if (last) {
+            std::vector<Chat> chats;
+            chats.swap(m_deferredHistory);
+            onChatHistoryReceived(chats);
+            recordFirstRender(false);
+        }
+        return;
+    }
+
+    // Batches come most recently active first, so appending keeps the
+    // sidebar ordered.
+    const QStringList addedChatIds = m_store->applyBatch(batch);
+    for (const QString& chatId : addedChatIds) {
+        QListWidgetItem* item = createChatListItem(m_store->chat(chatId));
+        m_chatListWidget->addItem(item);
+        if (chatId == m_currentChatId) {
+            m_chatListWidget->setCurrentItem(item);
+            renderMessages(chatId);
+        }
+    }
+    recordFirstChatRow();
+
+    if (!last) {
+        return;
+    }
+    m_progressiveHistory = false;
+    recordFirstRender(false);
+    if (!m_currentChatId.isEmpty()) {
+        updateComposerStateForCurrentChat();
+        updatePinnedMessageBar();
+    }
+    m_isLoadingHistory = false;
+}
+
+void MainWindow::recordFirstChatRow()
+{
+    if (m_firstChatRowMs >= 0 || m_chatListWidget->count() == 0) {
+        return;
+    }
+    m_firstChatRowMs = m_startupClock.elapsed();
+}
+
+void MainWindow::recordFirstRender(bool fromLocalStore)
+{
+    if (m_firstRenderMs >= 0) {
+        return;
+    }
+    m_firstRenderMs = m_startupClock.elapsed();
+    m_firstRenderFromLocalStore = fromLocalStore;
+}
+
+void MainWindow::sampleDiagnostics()
+{
+    using Metrics::Gauge;
+    const Outbox::Stats outbox = m_client->outboxStats();
+    Metrics::set(Gauge::PendingMessages, m_store->pendingCount());
+    Metrics::set(Gauge::OutboxQueued, outbox.queued);
+    Metrics::set(Gauge::OutboxInFlight, outbox.inFlight);
+    Metrics::set(Gauge::MessageWidgets, m_messageWidgetsById.size());
+    const MessageWidgetPool::Stats pool = m_messageWidgetPool->stats();
+    Metrics::set(Gauge::MessageWidgetsCreated, static_cast<qint64>(pool.created));
+    Metrics::set(Gauge::MessageWidgetsReused, static_cast<qint64>(pool.reused));
+    Metrics::set(Gauge::MessageWidgetsIdle, pool.idle);
+    Metrics::set(Gauge::ChatSwitchMs, m_lastChatSwitchMs);
+
+    const MediaCache::Stats media = MediaCache::instance()->stats();
+    Metrics::set(Gauge::MediaMemoryHits, static_cast<qint64>(media.memoryHits));
+    Metrics::set(Gauge::MediaMemoryMisses, static_cast<qint64>(media.memoryMisses));
+    Metrics::set(Gauge::MediaDiskHits, static_cast<qint64>(media.diskHits));
+    Metrics::set(Gauge::MediaDiskMisses, static_cast<qint64>(media.diskMisses));
+    Metrics::set(Gauge::MediaMemoryBytes, media.memoryBytes);
+    Metrics::set(Gauge::MediaMemoryBudgetBytes, media.memoryBudgetBytes);
+    Metrics::set(Gauge::MediaDiskBytes, media.diskBytes);
+
+    if (m_voiceAudio->isRunning()) {
+        const VoiceAudioBridge::Stats voice = m_voiceAudio->stats();
+        Metrics::set(Gauge::VoiceBufferFillPercent, voice.outputBufferFillPercent);
+        Metrics::set(Gauge::VoiceQueuedMs, voice.outputQueuedMs);
+    } else {
+        Metrics::set(Gauge::VoiceBufferFillPercent, -1);
+        Metrics::set(Gauge::VoiceQueuedMs, -1);
+    }
+
+    Metrics::set(Gauge::FirstRenderMs, m_firstRenderMs);
+    if (m_firstRenderMs >= 0) {
+        Metrics::set(Gauge::FirstRenderFromLocalStore, m_firstRenderFromLocalStore ? 1 : 0);
+    }
+    Metrics::set(Gauge::FirstChatRowMs, m_firstChatRowMs);
+}
+
+void MainWindow::onNewChatCreated(const Chat& chat) {
+    NOVEO_TRACE_SCOPE("MainWindow::onNewChatCreated");
+    if (m_store->addChat(chat)) {
+        m_chatListWidget->insertItem(0, createChatListItem(chat));
     }
     if (m_currentChatId == chat.chatId) {
         updateComposerStateForCurrentChat();
@@ -2672,7 +2487,7 @@ QString MainWindow::resolveChatName(const Chat& chat) {
     if (chat.chatType == "private") {
         for (const auto& memberId : chat.members) {
             if (memberId != m_client->currentUserId()) {
-                if (m_users.contains(memberId)) return m_users[memberId].username;
+                if (m_store->users().contains(memberId)) return m_store->user(memberId).username;
             }
         }
         return "Unknown User";
@@ -2717,6 +2532,7 @@ QIcon MainWindow::generateGenericAvatar(const QString& name) {
 }
 
 QIcon MainWindow::getAvatar(const QString& name, const QString& urlIn) {
+    NOVEO_TRACE_SCOPE("MainWindow::getAvatar");
     if (urlIn.isEmpty() || urlIn == "default.png" || urlIn == "/default.png" || urlIn.endsWith("/default.png")) {
         return generateGenericAvatar(name);
     }
@@ -2728,63 +2544,18 @@ QIcon MainWindow::getAvatar(const QString& name, const QString& urlIn) {
         fullUrl = API_BASE_URL + "/" + fullUrl;
     }
 
-    if (m_avatarCache.contains(fullUrl)) {
-        return QIcon(m_avatarCache[fullUrl]);
-    }
-
-    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/avatars";
-    QDir().mkpath(cacheDir);
-    QString urlHash = QString(QCryptographicHash::hash(fullUrl.toUtf8(), QCryptographicHash::Md5).toHex());
-    QString cachedFilePath = cacheDir + "/" + urlHash + ".png";
-
-    if (QFile::exists(cachedFilePath)) {
-        QPixmap pixmap;
-        if (pixmap.load(cachedFilePath)) {
-            m_avatarCache.insert(fullUrl, pixmap);
-            return QIcon(pixmap);
-        }
+    const QUrl avatarUrl(fullUrl);
+    QPixmap cached;
+    if (ImagePipeline::instance()->cachedPixmap(avatarUrl, QSize(42, 42), ImagePipeline::Shape::Circle, &cached)) {
+        return QIcon(cached);
     }
 
     if (!m_pendingDownloads.contains(fullUrl)) {
         m_pendingDownloads.insert(fullUrl);
-        QUrl qurl(fullUrl);
-        QNetworkRequest request(qurl);
-        request.setRawHeader("User-Agent", "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0.0.0 Safari/537.36");
-        request.setTransferTimeout(60000);
-
-        QNetworkReply* reply = m_nam->get(request);
-        connect(reply, &QNetworkReply::finished, this, [this, reply, fullUrl, name]() {
-            reply->deleteLater();
+        ImagePipeline::instance()->load(avatarUrl, QSize(42, 42), ImagePipeline::Shape::Circle, this, [this, fullUrl](const QPixmap& circular) {
             m_pendingDownloads.remove(fullUrl);
-
-            if (reply->error() == QNetworkReply::NoError) {
-                QByteArray data = reply->readAll();
-                QPixmap pixmap;
-                if (pixmap.loadFromData(data)) {
-                    QPixmap circular(42, 42);
-                    circular.fill(Qt::transparent);
-                    QPainter p(&circular);
-                    p.setRenderHint(QPainter::Antialiasing);
-                    QPainterPath path;
-                    path.addEllipse(0, 0, 42, 42);
-                    p.setClipPath(path);
-
-                    int sourceSize = qMin(pixmap.width(), pixmap.height());
-                    int x = (pixmap.width() - sourceSize) / 2;
-                    int y = (pixmap.height() - sourceSize) / 2;
-                    QPixmap cropped = pixmap.copy(x, y, sourceSize, sourceSize);
-
-                    p.drawPixmap(0, 0, 42, 42, cropped.scaled(42, 42, Qt::KeepAspectRatio, Qt::SmoothTransformation));
-                    m_avatarCache.insert(fullUrl, circular);
-
-                    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/avatars";
-                    QString urlHash = QString(QCryptographicHash::hash(fullUrl.toUtf8(), QCryptographicHash::Md5).toHex());
-                    QString cachedFilePath = cacheDir + "/" + urlHash + ".png";
-                    circular.save(cachedFilePath, "PNG");
-
-                    updateAvatarOnItems(fullUrl, circular);
-                }
-            } else {
+            if (!circular.isNull()) {
+                updateAvatarOnItems(fullUrl, circular);
             }
         });
     }
@@ -2810,7 +2581,6 @@ void MainWindow::updateAvatarOnItems(const QString& url, const QPixmap& pixmap)
 
     updateList(m_chatListWidget);
     updateList(m_contactListWidget);
-    updateList(m_chatList);
     for (auto it = m_messageWidgetsById.begin(); it != m_messageWidgetsById.end(); ++it) {
         MessageItemWidget* widget = it.value();
         if (widget && widget->representsSenderAvatarUrl(url)) {
@@ -2820,12 +2590,12 @@ void MainWindow::updateAvatarOnItems(const QString& url, const QPixmap& pixmap)
 }
 
 void MainWindow::scrollToBottom() {
-    if (m_chatList->count() > 0)
+    if (m_messageModel->rowCount() > 0)
         m_chatList->scrollToBottom();
 }
 
 void MainWindow::smoothScrollToBottom() {
-    if (m_chatList->count() > 0)
+    if (m_messageModel->rowCount() > 0)
         m_chatList->scrollToBottom();
 }
 
@@ -2835,8 +2605,10 @@ bool MainWindow::isScrolledToBottom() const {
 }
 
 void MainWindow::onChatSelected(QListWidgetItem* item) {
+    NOVEO_TRACE_SCOPE("MainWindow::onChatSelected");
     QString chatId = item->data(Qt::UserRole).toString();
     m_currentChatId = chatId;
+    m_localStore->setLastOpenChat(chatId);
     m_highlightedMessageId.clear();
     hideStickerPanel();
     hideSidebarMenu();
@@ -2847,8 +2619,8 @@ void MainWindow::onChatSelected(QListWidgetItem* item) {
         m_chatSettingsDialog->hide();
     }
 
-    if (m_chats.contains(chatId)) {
-        Chat chat = m_chats[chatId];
+    if (m_store->chats().contains(chatId)) {
+        Chat chat = m_store->chat(chatId);
         m_chatTitle->setText(resolveChatName(chat));
         const bool isOwnerSettingsChat = (chat.ownerId == m_client->currentUserId()) &&
                                          (chat.chatType == "group" || chat.chatType == "channel");
@@ -2869,6 +2641,7 @@ void MainWindow::onChatSelected(QListWidgetItem* item) {
 }
 
 void MainWindow::onContactSelected(QListWidgetItem* item) {
+    NOVEO_TRACE_SCOPE("MainWindow::onContactSelected");
     QString userId = item->data(Qt::UserRole).toString();
     QString selfId = m_client->currentUserId();
     hideStickerPanel();
@@ -2886,10 +2659,10 @@ void MainWindow::onContactSelected(QListWidgetItem* item) {
         m_chatSettingsBtn->setVisible(false);
     }
 
-    if (m_chats.contains(potentialChatId)) {
+    if (m_store->chats().contains(potentialChatId)) {
         m_currentChatId = potentialChatId;
         m_highlightedMessageId.clear();
-        m_chatTitle->setText(resolveChatName(m_chats[potentialChatId]));
+        m_chatTitle->setText(resolveChatName(m_store->chat(potentialChatId)));
         if (!m_currentVoiceChatId.isEmpty() && m_currentVoiceChatId != potentialChatId) {
             m_voiceCallBtn->setEnabled(false);
             m_voiceCallBtn->setText("In Other Call");
@@ -2913,13 +2686,7 @@ void MainWindow::onContactSelected(QListWidgetItem* item) {
         }
         updateComposerStateForCurrentChat();
         updatePinnedMessageBar();
-        m_chatList->clear();
-        m_currentAudioSourceWidget = nullptr;
-        m_messageItemsById.clear();
-        m_messageWidgetsById.clear();
-        m_currentMessagePreviewById.clear();
-        m_currentMessageSenderById.clear();
-        m_lastMessageViewportWidth = -1;
+        clearMessageView();
     }
 }
 
@@ -2951,10 +2718,10 @@ QString MainWindow::resolveFileUrl(const QString& rawUrl) const
     return API_BASE_URL + "/" + rawUrl;
 }
 
-QString MainWindow::displayTextForMessage(const Message& msg) const
+QString MainWindow::displayTextForMessage(const Message& msg)
 {
-    FileAttachment effectiveFile;
-    QString text = extractRenderableMessageText(msg, &effectiveFile);
+    const FileAttachment& effectiveFile = msg.file;
+    QString text = msg.text;
 
     if (text.isEmpty() && !effectiveFile.isNull()) {
         const QString type = effectiveFile.type.toLower();
@@ -3014,8 +2781,8 @@ void MainWindow::updateComposerStateForCurrentChat()
     if (!m_currentChatId.isEmpty()) {
         canSend = true;
         placeholder = "Write a message...";
-        if (m_chats.contains(m_currentChatId)) {
-            const Chat& chat = m_chats[m_currentChatId];
+        if (m_store->chats().contains(m_currentChatId)) {
+            const Chat& chat = m_store->chat(m_currentChatId);
             const bool isOwner = (chat.ownerId == m_client->currentUserId());
             const bool isChannel = (chat.chatType == "channel");
             const bool isMember = !isChannel || isOwner || chat.members.contains(m_client->currentUserId());
@@ -3063,12 +2830,12 @@ void MainWindow::updatePinnedMessageBar()
     if (!m_pinnedBar || !m_pinnedLabel) {
         return;
     }
-    if (m_currentChatId.isEmpty() || !m_chats.contains(m_currentChatId)) {
+    if (m_currentChatId.isEmpty() || !m_store->chats().contains(m_currentChatId)) {
         m_pinnedBar->hide();
         return;
     }
 
-    const Chat& chat = m_chats[m_currentChatId];
+    const Chat& chat = m_store->chat(m_currentChatId);
     if (!chat.hasPinnedMessage || chat.pinnedMessage.messageId.isEmpty()) {
         m_pinnedBar->hide();
         return;
@@ -3078,8 +2845,8 @@ void MainWindow::updatePinnedMessageBar()
     if (sender.isEmpty()) {
         sender = chat.pinnedMessage.senderId;
     }
-    if (m_users.contains(chat.pinnedMessage.senderId) && !m_users[chat.pinnedMessage.senderId].username.trimmed().isEmpty()) {
-        sender = m_users[chat.pinnedMessage.senderId].username.trimmed();
+    if (m_store->users().contains(chat.pinnedMessage.senderId) && !m_store->user(chat.pinnedMessage.senderId).username.trimmed().isEmpty()) {
+        sender = m_store->user(chat.pinnedMessage.senderId).username.trimmed();
     }
     QString preview = displayTextForMessage(chat.pinnedMessage);
     if (preview.size() > 80) {
@@ -3235,7 +3002,7 @@ void MainWindow::createGroupFromSidebar()
 
     auto* list = new QListWidget(&dialog);
     int candidateCount = 0;
-    for (auto it = m_users.constBegin(); it != m_users.constEnd(); ++it) {
+    for (auto it = m_store->users().constBegin(); it != m_store->users().constEnd(); ++it) {
         if (it.key() == m_client->currentUserId()) {
             continue;
         }
@@ -3361,8 +3128,8 @@ void MainWindow::showSettingsDialog()
         m_contactsOverlay->hide();
     }
     const QString selfId = m_client->currentUserId();
-    if (!selfId.isEmpty() && m_users.contains(selfId)) {
-        const User& self = m_users[selfId];
+    if (!selfId.isEmpty() && m_store->users().contains(selfId)) {
+        const User& self = m_store->user(selfId);
         m_settingsDialog->setUserInfo(self.username, self.userId);
         m_settingsDialog->setBlockGroupInvites(self.blockGroupInvites);
     }
@@ -3381,17 +3148,17 @@ void MainWindow::showSettingsDialog()
 
 void MainWindow::openChatSettingsDialog(const QString& chatId)
 {
-    if (chatId.isEmpty() || !m_chats.contains(chatId) || !m_chatSettingsDialog) {
+    if (chatId.isEmpty() || !m_store->chats().contains(chatId) || !m_chatSettingsDialog) {
         return;
     }
     hideStickerPanel();
-    const Chat& chat = m_chats[chatId];
+    const Chat& chat = m_store->chat(chatId);
     if (chat.ownerId != m_client->currentUserId()) {
         statusBar()->showMessage("Only the chat owner can manage chat settings.", 3000);
         return;
     }
     m_chatSettingsDialog->setDarkMode(m_isDarkMode);
-    m_chatSettingsDialog->setChatData(chat, m_users, m_client->currentUserId());
+    m_chatSettingsDialog->setChatData(chat, m_store->users(), m_client->currentUserId());
     m_chatSettingsDialog->show();
     m_chatSettingsDialog->raise();
     m_chatSettingsDialog->activateWindow();
@@ -3399,10 +3166,10 @@ void MainWindow::openChatSettingsDialog(const QString& chatId)
 
 void MainWindow::openAddMembersDialogForChat(const QString& chatId)
 {
-    if (chatId.isEmpty() || !m_chats.contains(chatId)) {
+    if (chatId.isEmpty() || !m_store->chats().contains(chatId)) {
         return;
     }
-    const Chat& chat = m_chats[chatId];
+    const Chat& chat = m_store->chat(chatId);
     if (chat.chatType != "group") {
         statusBar()->showMessage("Add members is available for groups.", 3000);
         return;
@@ -3417,7 +3184,7 @@ void MainWindow::openAddMembersDialogForChat(const QString& chatId)
     auto* layout = new QVBoxLayout(&dialog);
     auto* list = new QListWidget(&dialog);
     bool hasCandidates = false;
-    for (auto it = m_users.constBegin(); it != m_users.constEnd(); ++it) {
+    for (auto it = m_store->users().constBegin(); it != m_store->users().constEnd(); ++it) {
         const QString uid = it.key();
         if (uid == m_client->currentUserId() || chat.members.contains(uid)) {
             continue;
@@ -3459,16 +3226,10 @@ void MainWindow::openAddMembersDialogForChat(const QString& chatId)
 
 void MainWindow::startReplyToMessage(const QString& messageId)
 {
-    if (messageId.isEmpty() || !m_chats.contains(m_currentChatId)) {
+    if (messageId.isEmpty() || !m_store->chats().contains(m_currentChatId)) {
         return;
     }
-    Message* replyMsg = nullptr;
-    for (auto& msg : m_chats[m_currentChatId].messages) {
-        if (msg.messageId == messageId) {
-            replyMsg = &msg;
-            break;
-        }
-    }
+    const Message* replyMsg = m_store->chat(m_currentChatId).findMessage(messageId);
     if (!replyMsg) {
         return;
     }
@@ -3476,8 +3237,8 @@ void MainWindow::startReplyToMessage(const QString& messageId)
     m_replyingToMessageId = messageId;
     m_replyingToText = displayTextForMessage(*replyMsg);
     QString senderName = replyMsg->senderName.trimmed();
-    if (m_users.contains(replyMsg->senderId) && !m_users[replyMsg->senderId].username.trimmed().isEmpty()) {
-        senderName = m_users[replyMsg->senderId].username.trimmed();
+    if (m_store->users().contains(replyMsg->senderId) && !m_store->user(replyMsg->senderId).username.trimmed().isEmpty()) {
+        senderName = m_store->user(replyMsg->senderId).username.trimmed();
     }
     if (senderName.isEmpty()) {
         senderName = "Unknown";
@@ -3491,21 +3252,15 @@ void MainWindow::startReplyToMessage(const QString& messageId)
 
 void MainWindow::startEditMessage(const QString& messageId)
 {
-    if (messageId.isEmpty() || !m_chats.contains(m_currentChatId)) {
+    if (messageId.isEmpty() || !m_store->chats().contains(m_currentChatId)) {
         return;
     }
-    const Message* message = nullptr;
-    for (const auto& msg : m_chats[m_currentChatId].messages) {
-        if (msg.messageId == messageId) {
-            message = &msg;
-            break;
-        }
-    }
+    const Message* message = m_store->chat(m_currentChatId).findMessage(messageId);
     if (!message || !message->file.isNull()) {
         return;
     }
 
-    const QString editableText = extractRenderableMessageText(*message);
+    const QString editableText = message->text;
     m_editingMessageId = messageId;
     m_editingOriginalText = editableText;
     QString preview = editableText.length() > 30 ? editableText.left(30) + "..." : editableText;
@@ -3534,24 +3289,18 @@ void MainWindow::deleteMessageById(const QString& messageId)
 
 void MainWindow::forwardMessageById(const QString& messageId)
 {
-    if (!m_chats.contains(m_currentChatId) || messageId.isEmpty()) {
+    if (!m_store->chats().contains(m_currentChatId) || messageId.isEmpty()) {
         return;
     }
 
-    const Message* original = nullptr;
-    for (const auto& msg : m_chats[m_currentChatId].messages) {
-        if (msg.messageId == messageId) {
-            original = &msg;
-            break;
-        }
-    }
+    const Message* original = m_store->chat(m_currentChatId).findMessage(messageId);
     if (!original) {
         return;
     }
 
     QStringList options;
     QMap<QString, QString> optionToChatId;
-    for (auto it = m_chats.constBegin(); it != m_chats.constEnd(); ++it) {
+    for (auto it = m_store->chats().constBegin(); it != m_store->chats().constEnd(); ++it) {
         if (it.key() == m_currentChatId) {
             continue;
         }
@@ -3572,8 +3321,8 @@ void MainWindow::forwardMessageById(const QString& messageId)
     if (targetChatId.isEmpty()) {
         return;
     }
-    if (m_chats.contains(targetChatId)) {
-        const Chat& targetChat = m_chats[targetChatId];
+    if (m_store->chats().contains(targetChatId)) {
+        const Chat& targetChat = m_store->chat(targetChatId);
         if (targetChat.chatType == "channel" && targetChat.ownerId != m_client->currentUserId()) {
             QMessageBox::warning(this,
                                  "Permission Denied",
@@ -3584,7 +3333,7 @@ void MainWindow::forwardMessageById(const QString& messageId)
     }
 
     QJsonObject content;
-    const QString forwardText = extractRenderableMessageText(*original);
+    const QString forwardText = original->text;
     content.insert("text", forwardText.isEmpty() ? QJsonValue::Null : QJsonValue(forwardText));
     content.insert("theme", QJsonValue::Null);
     if (!original->file.isNull()) {
@@ -3602,8 +3351,8 @@ void MainWindow::forwardMessageById(const QString& messageId)
 
     QJsonObject forwardedInfo;
     QString forwardedFrom = original->senderName.trimmed();
-    if (m_users.contains(original->senderId) && !m_users[original->senderId].username.trimmed().isEmpty()) {
-        forwardedFrom = m_users[original->senderId].username.trimmed();
+    if (m_store->users().contains(original->senderId) && !m_store->user(original->senderId).username.trimmed().isEmpty()) {
+        forwardedFrom = m_store->user(original->senderId).username.trimmed();
     }
     if (forwardedFrom.isEmpty()) {
         forwardedFrom = "Someone";
@@ -3666,16 +3415,14 @@ void MainWindow::openMediaInViewer(const QString& mediaType, const QString& file
     }
 }
 
-void MainWindow::syncMessageWidgetSize(QListWidgetItem* item)
+bool MainWindow::syncMessageWidgetSize(const QString& messageId)
 {
-    if (!m_chatList || !item) {
-        return;
+    MessageItemWidget* widget = m_messageWidgetsById.value(messageId, nullptr);
+    if (!m_chatList || !widget) {
+        return false;
     }
-    QWidget* widget = m_chatList->itemWidget(item);
-    if (!widget) {
-        return;
-    }
-    const int targetWidth = qMax(0, m_chatList->viewport()->width() - 2);
+    const int viewportWidth = m_chatList->viewport()->width();
+    const int targetWidth = qMax(0, viewportWidth - 2);
     if (targetWidth > 0) {
         if (widget->minimumWidth() != targetWidth || widget->maximumWidth() != targetWidth) {
             widget->setMinimumWidth(targetWidth);
@@ -3683,10 +3430,7 @@ void MainWindow::syncMessageWidgetSize(QListWidgetItem* item)
             widget->updateGeometry();
         }
     }
-    const QSize hint = widget->sizeHint();
-    if (item->sizeHint() != hint) {
-        item->setSizeHint(hint);
-    }
+    return m_messageDelegate->setMeasuredHeight(messageId, viewportWidth, widget->sizeHint().height());
 }
 
 void MainWindow::refreshMessageWidgetSizes()
@@ -3699,15 +3443,132 @@ void MainWindow::refreshMessageWidgetSizes()
         return;
     }
     m_lastMessageViewportWidth = viewportWidth;
-    for (int i = 0; i < m_chatList->count(); ++i) {
-        QListWidgetItem* item = m_chatList->item(i);
-        if (!item) {
+    for (auto it = m_messageWidgetsById.constBegin(); it != m_messageWidgetsById.constEnd(); ++it) {
+        syncMessageWidgetSize(it.key());
+    }
+    m_chatList->doItemsLayout();
+    scheduleMessageWidgetMaterialization();
+}
+
+void MainWindow::scheduleMessageWidgetMaterialization()
+{
+    if (m_messageMaterializeTimer && !m_messageMaterializeTimer->isActive()) {
+        m_messageMaterializeTimer->start();
+    }
+}
+
+void MainWindow::materializeVisibleMessageWidgets()
+{
+    NOVEO_TRACE_SCOPE("MainWindow::materializeVisibleMessageWidgets");
+    if (!m_chatList || !m_messageModel) {
+        return;
+    }
+    const int rowCount = m_messageModel->rowCount();
+    if (rowCount == 0) {
+        return;
+    }
+
+    // Only rows intersecting the viewport (plus a small overscan) own a
+    // MessageItemWidget; everything else is painted by MessageDelegate.
+    const int viewportHeight = m_chatList->viewport()->height();
+    int lo = 0;
+    int hi = rowCount - 1;
+    int first = rowCount - 1;
+    while (lo <= hi) {
+        const int mid = lo + (hi - lo) / 2;
+        if (m_chatList->visualRect(m_messageModel->index(mid)).bottom() >= 0) {
+            first = mid;
+            hi = mid - 1;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    lo = first;
+    hi = rowCount - 1;
+    int last = first;
+    while (lo <= hi) {
+        const int mid = lo + (hi - lo) / 2;
+        if (m_chatList->visualRect(m_messageModel->index(mid)).top() <= viewportHeight) {
+            last = mid;
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+
+    const int anchorRow = first;
+    const int anchorTop = m_chatList->visualRect(m_messageModel->index(anchorRow)).top();
+    const bool wasAtBottom = isScrolledToBottom();
+
+    constexpr int kOverscanRows = 4;
+    first = qMax(0, first - kOverscanRows);
+    last = qMin(rowCount - 1, last + kOverscanRows);
+
+    const QStringList materialized = m_messageWidgetsById.keys();
+    for (const QString& messageId : materialized) {
+        const int row = m_messageModel->rowForMessage(messageId);
+        if (row < first || row > last) {
+            releaseMessageWidget(messageId);
+        }
+    }
+
+    bool heightsChanged = false;
+    for (int row = first; row <= last; ++row) {
+        const Message* message = m_messageModel->messageAt(row);
+        if (!message || m_messageWidgetsById.contains(message->messageId)) {
             continue;
         }
-        syncMessageWidgetSize(item);
+        const QString messageId = message->messageId;
+        MessageItemWidget* widget = createMessageWidget(*message, *m_messageModel->rowAt(row));
+        m_messageWidgetsById.insert(messageId, widget);
+        m_chatList->setIndexWidget(m_messageModel->index(row), widget);
+        heightsChanged = syncMessageWidgetSize(messageId) || heightsChanged;
+    }
+
+    if (heightsChanged) {
+        m_chatList->doItemsLayout();
+        if (wasAtBottom) {
+            m_chatList->scrollToBottom();
+        } else {
+            const int newTop = m_chatList->visualRect(m_messageModel->index(anchorRow)).top();
+            QScrollBar* sb = m_chatList->verticalScrollBar();
+            sb->setValue(sb->value() + (newTop - anchorTop));
+        }
+        scheduleMessageWidgetMaterialization();
     }
 }
 
+void MainWindow::releaseMessageWidget(const QString& messageId)
+{
+    MessageItemWidget* widget = m_messageWidgetsById.take(messageId);
+    if (!widget) {
+        return;
+    }
+    if (widget == m_currentAudioSourceWidget) {
+        m_currentAudioSourceWidget = nullptr;
+    }
+    const QModelIndex index = m_messageModel->indexForMessage(messageId);
+    if (index.isValid() && m_chatList->indexWidget(index) == widget) {
+        // Detaches without deleting; the delegate hands it to the pool.
+        m_chatList->closePersistentEditor(index);
+    } else {
+        m_messageWidgetPool->recycle(widget);
+    }
+}
+
+void MainWindow::clearMessageView()
+{
+    m_currentAudioSourceWidget = nullptr;
+    m_messageWidgetsById.clear();
+    if (m_messageModel) {
+        m_messageModel->clear();
+    }
+    if (m_messageDelegate) {
+        m_messageDelegate->clearHeights();
+    }
+    m_lastMessageViewportWidth = -1;
+}
+
 void MainWindow::openStickerPicker()
 {
     if (m_currentChatId.isEmpty()) {
@@ -3736,7 +3597,7 @@ void MainWindow::openStickerPicker()
         content.insert("theme", QJsonValue::Null);
 
         const QString recipientId = resolveRecipientIdForChat(targetChatId);
-        m_client->sendMessagePayload(targetChatId, content, targetReplyId, recipientId);
+        const QString clientMessageId = m_client->sendMessagePayload(targetChatId, content, targetReplyId, recipientId);
 
         Message pendingMsg;
         pendingMsg.messageId = "temp_" + QUuid::createUuid().toString(QUuid::WithoutBraces);
@@ -3751,7 +3612,9 @@ void MainWindow::openStickerPicker()
         pendingMsg.file.type = "image/png";
         pendingMsg.text.clear();
 
-        m_pendingMessages[pendingMsg.messageId] = pendingMsg;
+        pendingMsg.clientMessageId = clientMessageId;
+
+        m_store->trackPending(pendingMsg);
         if (m_currentChatId == targetChatId) {
             addMessageBubble(pendingMsg, false, false);
             smoothScrollToBottom();
@@ -3804,21 +3667,20 @@ void MainWindow::openStickerPicker()
             if (imageUrl.isRelative()) {
                 imageUrl = QUrl("https://noveo.ir").resolved(imageUrl);
             }
-            QNetworkReply* imageReply = m_nam->get(QNetworkRequest(imageUrl));
-            connect(imageReply, &QNetworkReply::finished, imageReply, &QObject::deleteLater);
-            connect(imageReply, &QNetworkReply::finished, btn, [imageReply, btn]() {
-                if (imageReply->error() != QNetworkReply::NoError) {
-                    btn->setText("x");
-                    return;
-                }
-                QPixmap px;
-                if (!px.loadFromData(imageReply->readAll())) {
-                    btn->setText("x");
-                    return;
-                }
+            QPixmap cached;
+            if (ImagePipeline::instance()->cachedPixmap(imageUrl, btn->iconSize(), ImagePipeline::Shape::Fit, &cached)) {
                 btn->setText(QString());
-                btn->setIcon(QIcon(px));
-            });
+                btn->setIcon(QIcon(cached));
+            } else {
+                ImagePipeline::instance()->load(imageUrl, btn->iconSize(), ImagePipeline::Shape::Fit, btn, [btn](const QPixmap& px) {
+                    if (px.isNull()) {
+                        btn->setText("x");
+                        return;
+                    }
+                    btn->setText(QString());
+                    btn->setIcon(QIcon(px));
+                });
+            }
 
             m_stickerGridLayout->addWidget(btn, i / kColumns, i % kColumns);
         }
@@ -3950,13 +3812,11 @@ void MainWindow::performChatSettingsAction(const QString& action, const QString&
 
         const QJsonObject root = doc.object();
         if (action == "remove_handle") {
-            if (m_chats.contains(chatId)) {
-                m_chats[chatId].handle.clear();
-            }
+            m_store->clearHandle(chatId);
             statusBar()->showMessage("Handle removed.", 3000);
         } else if (action == "remove_member") {
-            if (m_chats.contains(chatId)) {
-                QStringList members = m_chats[chatId].members;
+            if (m_store->chats().contains(chatId)) {
+                QStringList members = m_store->chat(chatId).members;
                 if (root.contains("members") && root.value("members").isArray()) {
                     members.clear();
                     const QJsonArray arr = root.value("members").toArray();
@@ -3966,32 +3826,27 @@ void MainWindow::performChatSettingsAction(const QString& action, const QString&
                 } else {
                     members.removeAll(extra.value("memberId").toString());
                 }
-                m_chats[chatId].members = members;
+                m_store->setMembers(chatId, members);
             }
             if (extra.value("memberId").toString() == m_client->currentUserId() && m_currentChatId == chatId) {
                 m_currentChatId.clear();
                 m_chatTitle->setText("Select a chat");
-                m_chatList->clear();
-                m_messageItemsById.clear();
-                m_messageWidgetsById.clear();
-                m_currentMessagePreviewById.clear();
-                m_currentMessageSenderById.clear();
-                m_lastMessageViewportWidth = -1;
+                clearMessageView();
                 if (m_chatSettingsBtn) {
                     m_chatSettingsBtn->setVisible(false);
                 }
             }
             statusBar()->showMessage("Member removed.", 3000);
         } else if (action == "add_members") {
-            if (m_chats.contains(chatId) && root.contains("members") && root.value("members").isArray()) {
+            if (m_store->chats().contains(chatId) && root.contains("members") && root.value("members").isArray()) {
                 QStringList members;
                 const QJsonArray arr = root.value("members").toArray();
                 for (const QJsonValue& value : arr) {
                     members.push_back(value.toString());
                 }
-                m_chats[chatId].members = members;
-            } else if (m_chats.contains(chatId) && extra.contains("memberIds") && extra.value("memberIds").isArray()) {
-                QStringList members = m_chats[chatId].members;
+                m_store->setMembers(chatId, members);
+            } else if (m_store->chats().contains(chatId) && extra.contains("memberIds") && extra.value("memberIds").isArray()) {
+                QStringList members = m_store->chat(chatId).members;
                 const QJsonArray arr = extra.value("memberIds").toArray();
                 for (const QJsonValue& value : arr) {
                     const QString memberId = value.toString();
@@ -3999,11 +3854,11 @@ void MainWindow::performChatSettingsAction(const QString& action, const QString&
                         members.push_back(memberId);
                     }
                 }
-                m_chats[chatId].members = members;
+                m_store->setMembers(chatId, members);
             }
             statusBar()->showMessage("Members updated.", 3000);
         } else if (action == "delete_chat") {
-            m_chats.remove(chatId);
+            m_store->removeChat(chatId);
             for (int i = 0; i < m_chatListWidget->count(); ++i) {
                 QListWidgetItem* item = m_chatListWidget->item(i);
                 if (item && item->data(Qt::UserRole).toString() == chatId) {
@@ -4015,12 +3870,7 @@ void MainWindow::performChatSettingsAction(const QString& action, const QString&
             if (m_currentChatId == chatId) {
                 m_currentChatId.clear();
                 m_chatTitle->setText("Select a chat");
-                m_chatList->clear();
-                m_messageItemsById.clear();
-                m_messageWidgetsById.clear();
-                m_currentMessagePreviewById.clear();
-                m_currentMessageSenderById.clear();
-                m_lastMessageViewportWidth = -1;
+                clearMessageView();
                 if (m_chatSettingsBtn) {
                     m_chatSettingsBtn->setVisible(false);
                 }
@@ -4028,80 +3878,56 @@ void MainWindow::performChatSettingsAction(const QString& action, const QString&
             statusBar()->showMessage("Chat deleted.", 3000);
         }
 
-        if (m_currentChatId == chatId && m_chats.contains(chatId)) {
+        if (m_currentChatId == chatId && m_store->chats().contains(chatId)) {
             renderMessages(chatId);
         }
         updateComposerStateForCurrentChat();
         updatePinnedMessageBar();
         if (m_chatSettingsDialog) {
-            if (m_chats.contains(chatId) && m_chatSettingsDialog->isVisible() && m_chatSettingsDialog->chatId() == chatId) {
-                m_chatSettingsDialog->setChatData(m_chats[chatId], m_users, m_client->currentUserId());
-            } else if (!m_chats.contains(chatId) && m_chatSettingsDialog->isVisible() && m_chatSettingsDialog->chatId() == chatId) {
+            if (m_store->chats().contains(chatId) && m_chatSettingsDialog->isVisible() && m_chatSettingsDialog->chatId() == chatId) {
+                m_chatSettingsDialog->setChatData(m_store->chat(chatId), m_store->users(), m_client->currentUserId());
+            } else if (!m_store->chats().contains(chatId) && m_chatSettingsDialog->isVisible() && m_chatSettingsDialog->chatId() == chatId) {
                 m_chatSettingsDialog->hide();
             }
         }
     });
 }
 
-void MainWindow::rebuildCurrentMessageCaches(const QString& chatId)
-{
-    m_currentMessagePreviewById.clear();
-    m_currentMessageSenderById.clear();
-    if (!m_chats.contains(chatId)) {
-        return;
-    }
-    const Chat& chat = m_chats[chatId];
-    for (const Message& msg : chat.messages) {
-        QString senderName = msg.senderName.trimmed();
-        if (m_users.contains(msg.senderId) && !m_users[msg.senderId].username.trimmed().isEmpty()) {
-            senderName = m_users[msg.senderId].username.trimmed();
-        }
-        if (senderName.isEmpty()) {
-            senderName = QStringLiteral("Unknown");
-        }
-        m_currentMessageSenderById.insert(msg.messageId, senderName);
-        m_currentMessagePreviewById.insert(msg.messageId, displayTextForMessage(msg));
-    }
-}
-
 void MainWindow::renderMessages(const QString& chatId) {
-    m_currentAudioSourceWidget = nullptr;
+    NOVEO_TRACE_SCOPE("MainWindow::renderMessages");
+    QElapsedTimer switchTimer;
+    switchTimer.start();
     m_chatList->setUpdatesEnabled(false);
-    m_chatList->clear();
-    m_messageItemsById.clear();
-    m_messageWidgetsById.clear();
-    m_lastMessageViewportWidth = -1;
-    rebuildCurrentMessageCaches(chatId);
-    if (m_chats.contains(chatId)) {
-        Chat& chat = m_chats[chatId];
-        for (auto& msg : chat.messages) {
-            msg.status = calculateMessageStatus(msg, chat);
-            addMessageBubble(msg, false, false);
-
-            if (msg.senderId != m_client->currentUserId() && !msg.seenBy.contains(m_client->currentUserId())) {
-                m_client->sendMessageSeen(chatId, msg.messageId);
-                msg.seenBy.append(m_client->currentUserId());
-            }
-        }
+    clearMessageView();
+    if (m_store->chats().contains(chatId)) {
+        const QStringList newlySeen = m_store->markChatSeen(chatId);
+        const Chat& chat = m_store->chat(chatId);
+        const size_t first = chat.messages.size() > static_cast<size_t>(MessageWindowRows)
+                                 ? chat.messages.size() - MessageWindowRows
+                                 : 0;
+        QStringList messageIds;
+        messageIds.reserve(static_cast<int>(chat.messages.size() - first));
+        for (size_t i = first; i < chat.messages.size(); ++i) {
+            messageIds.append(chat.messages[i].messageId);
+        }
+        for (const QString& messageId : newlySeen) {
+            m_client->sendMessageSeen(chatId, messageId);
+        }
+        m_messageModel->resetRows(chatId, messageIds);
         scrollToBottom();
         updatePinnedMessageBar();
     }
     m_chatList->setUpdatesEnabled(true);
     m_chatList->viewport()->update();
+    materializeVisibleMessageWidgets();
+    m_lastChatSwitchMs = switchTimer.elapsed();
 }
 
 QString MainWindow::getReplyPreviewText(const QString& replyToId, const QString& chatId) {
     QString replyText;
-    if (m_currentMessagePreviewById.contains(replyToId)) {
-        replyText = m_currentMessagePreviewById.value(replyToId);
-    }
-
-    if (replyText.isEmpty() && !chatId.isEmpty() && m_chats.contains(chatId)) {
-        for (const auto& m : m_chats[chatId].messages) {
-            if (m.messageId == replyToId) {
-                replyText = displayTextForMessage(m);
-                break;
-            }
+    if (!chatId.isEmpty() && m_store->chats().contains(chatId)) {
+        if (const Message* m = m_store->chat(chatId).findMessage(replyToId)) {
+            replyText = displayTextForMessage(*m);
         }
     }
 
@@ -4129,38 +3955,23 @@ QString MainWindow::getReplyPreviewText(const QString& replyToId, const QString&
     return replyText;
 }
 
-void MainWindow::addMessageBubble(const Message& msg, bool appendStretch, bool animate) {
-    Q_UNUSED(appendStretch);
-    Q_UNUSED(animate);
-
-    if (m_messageItemsById.contains(msg.messageId)) {
-        QListWidgetItem* existing = m_messageItemsById.value(msg.messageId);
-        const int row = m_chatList->row(existing);
-        if (row >= 0) {
-            delete m_chatList->takeItem(row);
-        }
-        m_messageItemsById.remove(msg.messageId);
-        m_messageWidgetsById.remove(msg.messageId);
-    }
+// Resolved lazily by the model for rows that are painted or materialized.
+MessageRow MainWindow::buildMessageRow(const Message& msg) {
+    MessageRow row;
+    const QString chatId = msg.chatId.isEmpty() ? m_currentChatId : msg.chatId;
 
-    Message widgetMessage = msg;
-    if (widgetMessage.chatId.isEmpty()) {
-        widgetMessage.chatId = m_currentChatId;
-    }
-    widgetMessage.text = extractRenderableMessageText(msg, &widgetMessage.file);
-
-    bool isMe = (widgetMessage.senderId == m_client->currentUserId());
-    QString senderName = widgetMessage.senderName.trimmed();
+    row.isMe = (msg.senderId == m_client->currentUserId());
+    QString senderName = msg.senderName.trimmed();
     if (senderName.isEmpty()) {
         senderName = "Unknown";
     }
-    QString senderAvatarUrl = widgetMessage.senderAvatarUrl.trimmed();
-    if (m_users.contains(widgetMessage.senderId)) {
-        if (!m_users[widgetMessage.senderId].username.trimmed().isEmpty()) {
-            senderName = m_users[widgetMessage.senderId].username.trimmed();
+    QString senderAvatarUrl = msg.senderAvatarUrl.trimmed();
+    if (m_store->users().contains(msg.senderId)) {
+        if (!m_store->user(msg.senderId).username.trimmed().isEmpty()) {
+            senderName = m_store->user(msg.senderId).username.trimmed();
         }
-        if (!m_users[widgetMessage.senderId].avatarUrl.trimmed().isEmpty()) {
-            senderAvatarUrl = m_users[widgetMessage.senderId].avatarUrl.trimmed();
+        if (!m_store->user(msg.senderId).avatarUrl.trimmed().isEmpty()) {
+            senderAvatarUrl = m_store->user(msg.senderId).avatarUrl.trimmed();
         }
     }
     if (!senderAvatarUrl.isEmpty() && !senderAvatarUrl.startsWith("http://") && !senderAvatarUrl.startsWith("https://")) {
@@ -4170,185 +3981,75 @@ void MainWindow::addMessageBubble(const Message& msg, bool appendStretch, bool a
             senderAvatarUrl = API_BASE_URL + "/" + senderAvatarUrl;
         }
     }
-    const QPixmap senderAvatar = getAvatar(senderName, senderAvatarUrl).pixmap(34, 34);
-
-    const QString displayText = displayTextForMessage(widgetMessage);
-
-    QListWidgetItem* item = new QListWidgetItem();
-    item->setData(Qt::UserRole + 1, displayText);
-    item->setData(Qt::UserRole + 2, senderName);
-    item->setData(Qt::UserRole + 3, widgetMessage.timestamp);
-    item->setData(Qt::UserRole + 4, isMe);
-    item->setData(Qt::UserRole + 5, static_cast<int>(widgetMessage.status));
-    item->setData(Qt::UserRole + 6, widgetMessage.messageId);
-    item->setData(Qt::UserRole + 7, widgetMessage.editedAt);
-    item->setData(Qt::UserRole + 8, widgetMessage.senderId);
-    item->setData(Qt::UserRole + 9, widgetMessage.replyToId);
-    item->setData(FileUrlRole, resolveFileUrl(widgetMessage.file.url));
-    item->setData(FileTypeRole, widgetMessage.file.type);
+    row.senderName = senderName;
+    row.senderAvatarUrl = senderAvatarUrl;
+    row.displayText = displayTextForMessage(msg);
+    row.fileUrl = resolveFileUrl(msg.file.url);
 
-    QString replyText;
-    QString replySenderName;
-    if (!widgetMessage.replyToId.isEmpty()) {
-        replyText = getReplyPreviewText(widgetMessage.replyToId, widgetMessage.chatId);
-        item->setData(Qt::UserRole + 10, replyText);
-        replySenderName = m_currentMessageSenderById.value(widgetMessage.replyToId);
-        if (replySenderName.isEmpty() && m_chats.contains(widgetMessage.chatId)) {
-            for (const Message& candidate : m_chats[widgetMessage.chatId].messages) {
-                if (candidate.messageId == widgetMessage.replyToId) {
-                    replySenderName = m_users.contains(candidate.senderId)
-                                          ? m_users[candidate.senderId].username
-                                          : QStringLiteral("Unknown");
-                    break;
-                }
+    if (!msg.replyToId.isEmpty()) {
+        row.replyText = getReplyPreviewText(msg.replyToId, chatId);
+        if (const Message* original = m_store->chat(chatId).findMessage(msg.replyToId)) {
+            row.replySender = original->senderName.trimmed();
+            if (!m_store->user(original->senderId).username.trimmed().isEmpty()) {
+                row.replySender = m_store->user(original->senderId).username.trimmed();
+            }
+            if (row.replySender.isEmpty()) {
+                row.replySender = QStringLiteral("Unknown");
             }
         }
-        item->setData(Qt::UserRole + 11, replySenderName);
     }
+    return row;
+}
+
+MessageItemWidget* MainWindow::createMessageWidget(const Message& msg, const MessageRow& row) {
+    NOVEO_TRACE_SCOPE("MainWindow::createMessageWidget");
+    Message widgetMessage = msg;
+    if (widgetMessage.chatId.isEmpty()) {
+        widgetMessage.chatId = m_currentChatId;
+    }
+    widgetMessage.status = m_messageModel->statusOf(msg);
+    const QPixmap senderAvatar = getAvatar(row.senderName, row.senderAvatarUrl).pixmap(34, 34);
 
     QString chatType = "private";
     bool isChannelOwner = false;
-    if (m_chats.contains(widgetMessage.chatId)) {
-        const Chat& chat = m_chats[widgetMessage.chatId];
+    if (m_store->chats().contains(widgetMessage.chatId)) {
+        const Chat& chat = m_store->chat(widgetMessage.chatId);
         chatType = chat.chatType;
         isChannelOwner = (chat.chatType == "channel" && chat.ownerId == m_client->currentUserId());
     }
 
-    auto* widget = new MessageItemWidget(widgetMessage,
-                                         senderName,
-                                         senderAvatarUrl,
-                                         senderAvatar,
-                                         resolveFileUrl(widgetMessage.file.url),
-                                         replySenderName,
-                                         replyText,
-                                         m_client->currentUserId(),
-                                         chatType,
-                                         isChannelOwner,
-                                         m_isDarkMode,
-                                         m_chatList);
-    connect(widget, &MessageItemWidget::replyRequested, this, &MainWindow::startReplyToMessage);
-    connect(widget, &MessageItemWidget::editRequested, this, &MainWindow::startEditMessage);
-    connect(widget, &MessageItemWidget::deleteRequested, this, &MainWindow::deleteMessageById);
-    connect(widget, &MessageItemWidget::forwardRequested, this, &MainWindow::forwardMessageById);
-    connect(widget, &MessageItemWidget::pinRequested, this, [this](const QString& messageId) {
-        if (!m_currentChatId.isEmpty()) {
-            m_client->pinMessage(m_currentChatId, messageId);
-        }
-    });
-    connect(widget, &MessageItemWidget::openMediaRequested, this, &MainWindow::openMediaInViewer);
-    connect(widget, &MessageItemWidget::openFileRequested, this, [this](const QString& fileUrl) {
-        if (!fileUrl.isEmpty()) {
-            QDesktopServices::openUrl(QUrl(fileUrl));
-        }
-    });
-    connect(widget, &MessageItemWidget::playAudioRequested, this, &MainWindow::playAudioTrack);
-    connect(widget, &MessageItemWidget::replyAnchorClicked, this, &MainWindow::focusOnMessage);
+    bool created = false;
+    MessageItemWidget* widget = m_messageWidgetPool->acquire(&created);
+    widget->bind(widgetMessage,
+                 row.senderName,
+                 row.senderAvatarUrl,
+                 senderAvatar,
+                 row.fileUrl,
+                 row.replySender,
+                 row.replyText,
+                 m_client->currentUserId(),
+                 chatType,
+                 isChannelOwner,
+                 m_isDarkMode);
+    if (created) {
+        connectMessageWidget(widget);
+    }
 
-    m_chatList->addItem(item);
-    m_chatList->setItemWidget(item, widget);
-    syncMessageWidgetSize(item);
-    m_messageItemsById[widgetMessage.messageId] = item;
-    m_messageWidgetsById[widgetMessage.messageId] = widget;
-    m_currentMessagePreviewById.insert(widgetMessage.messageId, displayText);
-    m_currentMessageSenderById.insert(widgetMessage.messageId, senderName);
     if (m_highlightedMessageId == widgetMessage.messageId) {
         widget->setHighlighted(true);
     }
-}
-
-void MainWindow::prependMessageBubble(const Message& msg) {
-    if (m_messageItemsById.contains(msg.messageId)) {
-        QListWidgetItem* existing = m_messageItemsById.value(msg.messageId);
-        const int row = m_chatList->row(existing);
-        if (row >= 0) {
-            delete m_chatList->takeItem(row);
-        }
-        m_messageItemsById.remove(msg.messageId);
-        m_messageWidgetsById.remove(msg.messageId);
-    }
-
-    Message widgetMessage = msg;
-    if (widgetMessage.chatId.isEmpty()) {
-        widgetMessage.chatId = m_currentChatId;
-    }
-    widgetMessage.text = extractRenderableMessageText(msg, &widgetMessage.file);
-
-    bool isMe = (widgetMessage.senderId == m_client->currentUserId());
-    QString senderName = widgetMessage.senderName.trimmed();
-    if (senderName.isEmpty()) {
-        senderName = "Unknown";
-    }
-    QString senderAvatarUrl = widgetMessage.senderAvatarUrl.trimmed();
-    if (m_users.contains(widgetMessage.senderId)) {
-        if (!m_users[widgetMessage.senderId].username.trimmed().isEmpty()) {
-            senderName = m_users[widgetMessage.senderId].username.trimmed();
-        }
-        if (!m_users[widgetMessage.senderId].avatarUrl.trimmed().isEmpty()) {
-            senderAvatarUrl = m_users[widgetMessage.senderId].avatarUrl.trimmed();
-        }
-    }
-    if (!senderAvatarUrl.isEmpty() && !senderAvatarUrl.startsWith("http://") && !senderAvatarUrl.startsWith("https://")) {
-        if (senderAvatarUrl.startsWith('/')) {
-            senderAvatarUrl = API_BASE_URL + senderAvatarUrl;
-        } else {
-            senderAvatarUrl = API_BASE_URL + "/" + senderAvatarUrl;
-        }
-    }
-    const QPixmap senderAvatar = getAvatar(senderName, senderAvatarUrl).pixmap(34, 34);
-
-    const QString displayText = displayTextForMessage(widgetMessage);
-
-    QListWidgetItem* item = new QListWidgetItem();
-    item->setData(Qt::UserRole + 1, displayText);
-    item->setData(Qt::UserRole + 2, senderName);
-    item->setData(Qt::UserRole + 3, widgetMessage.timestamp);
-    item->setData(Qt::UserRole + 4, isMe);
-    item->setData(Qt::UserRole + 5, static_cast<int>(widgetMessage.status));
-    item->setData(Qt::UserRole + 6, widgetMessage.messageId);
-    item->setData(Qt::UserRole + 7, widgetMessage.editedAt);
-    item->setData(Qt::UserRole + 8, widgetMessage.senderId);
-    item->setData(Qt::UserRole + 9, widgetMessage.replyToId);
-    item->setData(FileUrlRole, resolveFileUrl(widgetMessage.file.url));
-    item->setData(FileTypeRole, widgetMessage.file.type);
-
-    QString replyText;
-    QString replySenderName;
-    if (!widgetMessage.replyToId.isEmpty()) {
-        replyText = getReplyPreviewText(widgetMessage.replyToId, widgetMessage.chatId);
-        item->setData(Qt::UserRole + 10, replyText);
-        replySenderName = m_currentMessageSenderById.value(widgetMessage.replyToId);
-        if (replySenderName.isEmpty() && m_chats.contains(widgetMessage.chatId)) {
-            for (const Message& candidate : m_chats[widgetMessage.chatId].messages) {
-                if (candidate.messageId == widgetMessage.replyToId) {
-                    replySenderName = m_users.contains(candidate.senderId)
-                                          ? m_users[candidate.senderId].username
-                                          : QStringLiteral("Unknown");
-                    break;
-                }
-            }
-        }
-        item->setData(Qt::UserRole + 11, replySenderName);
+    if (!m_currentAudioSourceWidget && widget->representsAudioUrl(m_currentAudioUrl) &&
+        m_sidebarAudioPlayback && m_sidebarAudioPlayback->state() == QMediaPlayer::PlayingState) {
+        widget->setAudioPlaying(true);
+        m_currentAudioSourceWidget = widget;
     }
+    return widget;
+}
 
-    QString chatType = "private";
-    bool isChannelOwner = false;
-    if (m_chats.contains(widgetMessage.chatId)) {
-        const Chat& chat = m_chats[widgetMessage.chatId];
-        chatType = chat.chatType;
-        isChannelOwner = (chat.chatType == "channel" && chat.ownerId == m_client->currentUserId());
-    }
-    auto* widget = new MessageItemWidget(widgetMessage,
-                                         senderName,
-                                         senderAvatarUrl,
-                                         senderAvatar,
-                                         resolveFileUrl(widgetMessage.file.url),
-                                         replySenderName,
-                                         replyText,
-                                         m_client->currentUserId(),
-                                         chatType,
-                                         isChannelOwner,
-                                         m_isDarkMode,
-                                         m_chatList);
+// Pooled widgets keep these across rebinds; every signal carries the bound
+// message's id or url, so nothing here depends on which message it shows.
+void MainWindow::connectMessageWidget(MessageItemWidget* widget)
+{
     connect(widget, &MessageItemWidget::replyRequested, this, &MainWindow::startReplyToMessage);
     connect(widget, &MessageItemWidget::editRequested, this, &MainWindow::startEditMessage);
     connect(widget, &MessageItemWidget::deleteRequested, this, &MainWindow::deleteMessageById);
@@ -4366,97 +4067,77 @@ void MainWindow::prependMessageBubble(const Message& msg) {
     });
     connect(widget, &MessageItemWidget::playAudioRequested, this, &MainWindow::playAudioTrack);
     connect(widget, &MessageItemWidget::replyAnchorClicked, this, &MainWindow::focusOnMessage);
+}
+
+void MainWindow::addMessageBubble(const Message& msg, bool appendStretch, bool animate) {
+    NOVEO_TRACE_SCOPE("MainWindow::addMessageBubble");
+    Q_UNUSED(appendStretch);
+    Q_UNUSED(animate);
 
-    m_chatList->insertItem(0, item);
-    m_chatList->setItemWidget(item, widget);
-    syncMessageWidgetSize(item);
-    m_messageItemsById[widgetMessage.messageId] = item;
-    m_messageWidgetsById[widgetMessage.messageId] = widget;
-    m_currentMessagePreviewById.insert(widgetMessage.messageId, displayText);
-    m_currentMessageSenderById.insert(widgetMessage.messageId, senderName);
+    releaseMessageWidget(msg.messageId);
+    m_messageDelegate->invalidateMessage(msg.messageId);
+    m_messageModel->appendMessage(msg);
 }
 
-void MainWindow::updateMessageStatus(const QString& messageId, MessageStatus newStatus) {
-    QListWidgetItem* item = m_messageItemsById.value(messageId, nullptr);
-    if (!item) {
-        for (int i = 0; i < m_chatList->count(); i++) {
-            QListWidgetItem* candidate = m_chatList->item(i);
-            if (candidate && candidate->data(Qt::UserRole + 6).toString() == messageId) {
-                item = candidate;
-                break;
-            }
-        }
-    }
-    if (item) {
-        item->setData(Qt::UserRole + 5, static_cast<int>(newStatus));
-        if (m_messageWidgetsById.contains(messageId) && m_messageWidgetsById[messageId]) {
-            m_messageWidgetsById[messageId]->setMessageStatus(newStatus);
-        }
+void MainWindow::prependMessageBubbles(const std::vector<Message>& messages) {
+    NOVEO_TRACE_SCOPE("MainWindow::prependMessageBubbles");
+    QStringList messageIds;
+    messageIds.reserve(static_cast<int>(messages.size()));
+    for (const Message& msg : messages) {
+        messageIds.append(msg.messageId);
     }
 
-    for (auto& chat : m_chats) {
-        for (auto& msg : chat.messages) {
-            if (msg.messageId == messageId) {
-                msg.status = newStatus;
-                break;
-            }
-        }
+    // Keeps the rows already on screen where they were.
+    QScrollBar* sb = m_chatList->verticalScrollBar();
+    const int oldMax = sb->maximum();
+    const int oldValue = sb->value();
+    m_chatList->setUpdatesEnabled(false);
+    m_messageModel->prependMessages(messageIds);
+    m_chatList->doItemsLayout();
+    m_chatList->setUpdatesEnabled(true);
+    sb->setValue(oldValue + sb->maximum() - oldMax);
+}
+
+bool MainWindow::revealOlderMessages(const QString& untilMessageId)
+{
+    const Chat& chat = m_store->chat(m_currentChatId);
+    const Message* top = m_messageModel->messageAt(0);
+    const int oldest = top ? chat.messageIndex.value(top->messageId, -1) : -1;
+    if (oldest <= 0) {
+        return false;
+    }
+    int from = qMax(0, oldest - MessageWindowRows);
+    if (!untilMessageId.isEmpty()) {
+        const int target = chat.messageIndex.value(untilMessageId, -1);
+        if (target < 0 || target >= oldest) {
+            return false;
+        }
+        from = qMin(from, target);
+    }
+    prependMessageBubbles(std::vector<Message>(chat.messages.begin() + from, chat.messages.begin() + oldest));
+    return true;
+}
+
+void MainWindow::updateMessageStatus(const QString& chatId, const QString& messageId, MessageStatus newStatus) {
+    if (chatId != m_currentChatId) {
+        return;
+    }
+    m_messageModel->refreshStatus(messageId);
+    if (m_messageWidgetsById.contains(messageId) && m_messageWidgetsById[messageId]) {
+        m_messageWidgetsById[messageId]->setMessageStatus(newStatus);
     }
 }
 
-void MainWindow::onMessageReceived(const Message& msg) {
+void MainWindow::onMessageAdded(const Message& msg, const QString& pendingId) {
+    NOVEO_TRACE_SCOPE("MainWindow::onMessageAdded");
     Message normalizedMsg = msg;
-    normalizedMsg.text = extractRenderableMessageText(msg, &normalizedMsg.file);
     if (normalizedMsg.chatId.isEmpty()) {
+        // Legacy frames without a chat id belong to the open chat.
         normalizedMsg.chatId = m_currentChatId;
-    }
-    if (!normalizedMsg.senderId.isEmpty()) {
-        User sender = m_users.value(normalizedMsg.senderId);
-        bool changed = false;
-        if (sender.userId.isEmpty()) {
-            sender.userId = normalizedMsg.senderId;
-            changed = true;
-        }
-        if (sender.username.trimmed().isEmpty() && !normalizedMsg.senderName.trimmed().isEmpty()) {
-            sender.username = normalizedMsg.senderName.trimmed();
-            changed = true;
-        }
-        if (sender.avatarUrl.trimmed().isEmpty() && !normalizedMsg.senderAvatarUrl.trimmed().isEmpty()) {
-            sender.avatarUrl = normalizedMsg.senderAvatarUrl.trimmed();
-            changed = true;
-        }
-        if (changed) {
-            m_users[sender.userId] = sender;
-        }
-    }
-
-    bool isPendingConfirmation = false;
-    QString pendingIdToRemove;
-
-    if (normalizedMsg.senderId == m_client->currentUserId()) {
-        for (auto it = m_pendingMessages.begin(); it != m_pendingMessages.end(); ++it) {
-            const bool sameChat = (it.value().chatId == normalizedMsg.chatId);
-            const bool sameText = (it.value().text == normalizedMsg.text && it.value().replyToId == normalizedMsg.replyToId);
-            const bool sameFile = !it.value().file.isNull() && !normalizedMsg.file.isNull() &&
-                                  (resolveFileUrl(it.value().file.url) == resolveFileUrl(normalizedMsg.file.url));
-            if (sameChat && (sameFile || sameText)) {
-                isPendingConfirmation = true;
-                pendingIdToRemove = it.key();
-                break;
-            }
-        }
+        m_store->upsertMessage(normalizedMsg.chatId, normalizedMsg);
     }
 
-    if (m_chats.contains(normalizedMsg.chatId)) {
-        auto& chatMessages = m_chats[normalizedMsg.chatId].messages;
-        auto existingIt = std::find_if(chatMessages.begin(), chatMessages.end(), [&normalizedMsg](const Message& existing) {
-            return existing.messageId == normalizedMsg.messageId;
-        });
-        if (existingIt == chatMessages.end()) {
-            chatMessages.push_back(normalizedMsg);
-        } else {
-            *existingIt = normalizedMsg;
-        }
+    if (m_store->chats().contains(normalizedMsg.chatId)) {
         for (int i = 0; i < m_chatListWidget->count(); i++) {
             if (m_chatListWidget->item(i)->data(Qt::UserRole).toString() == normalizedMsg.chatId) {
                 QListWidgetItem* item = m_chatListWidget->takeItem(i);
@@ -4469,39 +4150,14 @@ void MainWindow::onMessageReceived(const Message& msg) {
     if (m_currentChatId == normalizedMsg.chatId) {
         bool wasAtBottom = isScrolledToBottom();
 
-        if (isPendingConfirmation) {
-            for (int i = 0; i < m_chatList->count(); i++) {
-                QListWidgetItem* item = m_chatList->item(i);
-                if (item->data(Qt::UserRole + 6).toString() == pendingIdToRemove) {
-                    if (m_messageWidgetsById.contains(pendingIdToRemove) &&
-                        m_messageWidgetsById[pendingIdToRemove] == m_currentAudioSourceWidget) {
-                        m_currentAudioSourceWidget = nullptr;
-                    }
-                    m_messageWidgetsById.remove(pendingIdToRemove);
-                    m_messageItemsById.remove(pendingIdToRemove);
-                    m_currentMessagePreviewById.remove(pendingIdToRemove);
-                    m_currentMessageSenderById.remove(pendingIdToRemove);
-                    delete m_chatList->takeItem(i);
-                    break;
-                }
-            }
-            m_pendingMessages.remove(pendingIdToRemove);
-        }
-
-        if (m_messageItemsById.contains(normalizedMsg.messageId)) {
-            QListWidgetItem* existing = m_messageItemsById.value(normalizedMsg.messageId);
-            const int row = m_chatList->row(existing);
-            if (row >= 0) {
-                delete m_chatList->takeItem(row);
+        if (pendingId.isEmpty() || !confirmPendingBubble(pendingId, normalizedMsg)) {
+            if (m_messageModel->rowForMessage(normalizedMsg.messageId) >= 0) {
+                releaseMessageWidget(normalizedMsg.messageId);
+                m_messageModel->removeMessage(normalizedMsg.messageId);
             }
-            m_messageItemsById.remove(normalizedMsg.messageId);
-            m_messageWidgetsById.remove(normalizedMsg.messageId);
-            m_currentMessagePreviewById.remove(normalizedMsg.messageId);
-            m_currentMessageSenderById.remove(normalizedMsg.messageId);
+            addMessageBubble(normalizedMsg, false, false);
         }
 
-        addMessageBubble(normalizedMsg, false, false);
-
         if (normalizedMsg.senderId != m_client->currentUserId()) {
             m_client->sendMessageSeen(normalizedMsg.chatId, normalizedMsg.messageId);
         }
@@ -4509,66 +4165,42 @@ void MainWindow::onMessageReceived(const Message& msg) {
         if (wasAtBottom || normalizedMsg.senderId == m_client->currentUserId()) {
             smoothScrollToBottom();
         }
-    } else if (isPendingConfirmation) {
-        m_pendingMessages.remove(pendingIdToRemove);
     }
 
     showNotificationForMessage(normalizedMsg);
 }
 
-MessageStatus MainWindow::calculateMessageStatus(const Message& msg, const Chat& chat) {
-    if (msg.senderId != m_client->currentUserId()) {
-        return MessageStatus::Sent;
-    }
-    if (msg.messageId.startsWith("temp_")) {
-        return MessageStatus::Pending;
-    }
-
-    int otherMembersCount = 0;
-    int seenByOthers = 0;
-
-    for (const QString& memberId : chat.members) {
-        if (memberId != m_client->currentUserId()) {
-            otherMembersCount++;
-            if (msg.seenBy.contains(memberId)) {
-                seenByOthers++;
-            }
-        }
+bool MainWindow::confirmPendingBubble(const QString& pendingId, const Message& confirmed)
+{
+    if (m_messageModel->rowForMessage(pendingId) < 0) {
+        return false;
     }
-
-    if (seenByOthers > 0) {
-        return MessageStatus::Seen;
+    if (confirmed.messageId != pendingId && m_messageModel->rowForMessage(confirmed.messageId) >= 0) {
+        releaseMessageWidget(confirmed.messageId);
     }
-    return MessageStatus::Sent;
-}
-
-void MainWindow::onMessageSeenUpdate(const QString& chatId, const QString& messageId, const QString& userId) {
-    if (m_chats.contains(chatId)) {
-        for (auto& msg : m_chats[chatId].messages) {
-            if (msg.messageId == messageId) {
-                if (!msg.seenBy.contains(userId)) {
-                    msg.seenBy.append(userId);
-                }
-                MessageStatus newStatus = calculateMessageStatus(msg, m_chats[chatId]);
-                msg.status = newStatus;
+    m_messageDelegate->invalidateMessage(pendingId);
 
-                if (m_currentChatId == chatId) {
-                    updateMessageStatus(messageId, newStatus);
-                }
-                break;
-            }
-        }
+    // Same row, same widget: only the id, timestamp and status change.
+    m_messageModel->renameMessage(pendingId, confirmed);
+    if (MessageItemWidget* widget = m_messageWidgetsById.take(pendingId)) {
+        Message shown = confirmed;
+        shown.status = m_messageModel->statusOf(confirmed);
+        m_messageWidgetsById.insert(confirmed.messageId, widget);
+        widget->confirmPending(shown);
+        syncMessageWidgetSize(confirmed.messageId);
     }
+    return true;
 }
 
 void MainWindow::onChatListContextMenu(const QPoint& pos) {
-    QListWidgetItem* item = m_chatList->itemAt(pos);
-    if (!item) return;
+    NOVEO_TRACE_SCOPE("MainWindow::onChatListContextMenu");
+    const QModelIndex index = m_chatList->indexAt(pos);
+    if (!index.isValid()) return;
 
-    QString messageId = item->data(Qt::UserRole + 6).toString();
-    QString senderId = item->data(Qt::UserRole + 8).toString();
+    QString messageId = index.data(MessageListModel::MessageIdRole).toString();
+    QString senderId = index.data(MessageListModel::SenderIdRole).toString();
     bool isMyMessage = (senderId == m_client->currentUserId());
-    const bool hasAttachment = !item->data(FileUrlRole).toString().isEmpty();
+    const bool hasAttachment = !index.data(MessageListModel::FileUrlRole).toString().isEmpty();
 
     QMenu contextMenu(this);
     if (m_isDarkMode) {
@@ -4622,8 +4254,8 @@ void MainWindow::onChatListContextMenu(const QPoint& pos) {
     QAction* forwardAction = contextMenu.addAction("Forward");
     QAction* pinAction = nullptr;
     QAction* unpinAction = nullptr;
-    if (m_chats.contains(m_currentChatId)) {
-        const Chat& chat = m_chats[m_currentChatId];
+    if (m_store->chats().contains(m_currentChatId)) {
+        const Chat& chat = m_store->chat(m_currentChatId);
         const bool canPin = (chat.chatType == "private") ||
                             (chat.chatType == "channel" && chat.ownerId == m_client->currentUserId());
         if (canPin) {
@@ -4650,12 +4282,13 @@ void MainWindow::onChatListContextMenu(const QPoint& pos) {
     }
 
     contextMenu.setProperty("messageId", messageId);
-    contextMenu.setProperty("messageText", item->data(Qt::UserRole + 1).toString());
+    contextMenu.setProperty("messageText", index.data(MessageListModel::TextRole).toString());
 
     contextMenu.exec(m_chatList->mapToGlobal(pos));
 }
 
 void MainWindow::onEditMessage() {
+    NOVEO_TRACE_SCOPE("MainWindow::onEditMessage");
     QMenu* menu = qobject_cast<QMenu*>(sender()->parent());
     if (!menu) return;
 
@@ -4664,6 +4297,7 @@ void MainWindow::onEditMessage() {
 }
 
 void MainWindow::onDeleteMessage() {
+    NOVEO_TRACE_SCOPE("MainWindow::onDeleteMessage");
     QMenu* menu = qobject_cast<QMenu*>(sender()->parent());
     if (!menu) return;
     QString messageId = menu->property("messageId").toString();
@@ -4671,6 +4305,7 @@ void MainWindow::onDeleteMessage() {
 }
 
 void MainWindow::onReplyToMessage() {
+    NOVEO_TRACE_SCOPE("MainWindow::onReplyToMessage");
     QMenu* menu = qobject_cast<QMenu*>(sender()->parent());
     if (!menu) return;
     QString messageId = menu->property("messageId").toString();
@@ -4678,6 +4313,7 @@ void MainWindow::onReplyToMessage() {
 }
 
 void MainWindow::onForwardMessage() {
+    NOVEO_TRACE_SCOPE("MainWindow::onForwardMessage");
     QMenu* menu = qobject_cast<QMenu*>(sender()->parent());
     if (!menu) return;
     QString messageId = menu->property("messageId").toString();
@@ -4685,6 +4321,7 @@ void MainWindow::onForwardMessage() {
 }
 
 void MainWindow::onCancelEdit() {
+    NOVEO_TRACE_SCOPE("MainWindow::onCancelEdit");
     m_editingMessageId.clear();
     m_editingOriginalText.clear();
     m_editBar->hide();
@@ -4693,113 +4330,57 @@ void MainWindow::onCancelEdit() {
 }
 
 void MainWindow::onCancelReply() {
+    NOVEO_TRACE_SCOPE("MainWindow::onCancelReply");
     m_replyingToMessageId.clear();
     m_replyingToText.clear();
     m_replyingToSender.clear();
     m_replyBar->hide();
 }
 
-void MainWindow::onMessageUpdated(const QString& chatId, const QString& messageId, const QString& newContent, qint64 editedAt) {
-    Message updatedSnapshot;
-    bool foundMessage = false;
-    if (m_chats.contains(chatId)) {
-        for (auto& msg : m_chats[chatId].messages) {
-            if (msg.messageId == messageId) {
-                msg.text = newContent;
-                msg.text = extractRenderableMessageText(msg, &msg.file);
-                msg.editedAt = editedAt;
-                updatedSnapshot = msg;
-                foundMessage = true;
-                break;
-            }
-        }
-    }
-    const QString renderedText = foundMessage ? displayTextForMessage(updatedSnapshot) : newContent;
-    if (foundMessage && chatId == m_currentChatId) {
-        m_currentMessagePreviewById[messageId] = renderedText;
-    }
-
+void MainWindow::onMessageEdited(const QString& chatId, const QString& messageId, const QString& newContent, qint64 editedAt) {
+    NOVEO_TRACE_SCOPE("MainWindow::onMessageEdited");
     if (m_currentChatId == chatId) {
-        for (int i = 0; i < m_chatList->count(); i++) {
-            QListWidgetItem* item = m_chatList->item(i);
-            if (item->data(Qt::UserRole + 6).toString() == messageId) {
-                item->setData(Qt::UserRole + 1, renderedText);
-                item->setData(Qt::UserRole + 7, editedAt);
-                if (m_messageWidgetsById.contains(messageId) && m_messageWidgetsById[messageId]) {
-                    m_messageWidgetsById[messageId]->setMessageText(renderedText);
-                    m_messageWidgetsById[messageId]->setEditedAt(editedAt);
-                    syncMessageWidgetSize(item);
-                }
-                break;
-            }
+        const Message* msg = m_store->chat(chatId).findMessage(messageId);
+        const QString editedText = msg ? msg->text : newContent;
+        m_messageModel->refreshMessage(messageId);
+        m_messageDelegate->invalidateMessage(messageId);
+        if (m_messageWidgetsById.contains(messageId) && m_messageWidgetsById[messageId]) {
+            m_messageWidgetsById[messageId]->setMessageText(editedText);
+            m_messageWidgetsById[messageId]->setEditedAt(editedAt);
+            syncMessageWidgetSize(messageId);
         }
+        m_chatList->doItemsLayout();
         updatePinnedMessageBar();
     }
 }
 
-void MainWindow::onMessageDeleted(const QString& chatId, const QString& messageId) {
-    if (m_chats.contains(chatId)) {
-        auto& messages = m_chats[chatId].messages;
-        messages.erase(std::remove_if(messages.begin(), messages.end(),
-            [&messageId](const Message& m) { return m.messageId == messageId; }), messages.end());
-        if (m_chats[chatId].hasPinnedMessage && m_chats[chatId].pinnedMessage.messageId == messageId) {
-            m_chats[chatId].hasPinnedMessage = false;
-        }
-    }
-
+void MainWindow::onMessageRemoved(const QString& chatId, const QString& messageId) {
+    NOVEO_TRACE_SCOPE("MainWindow::onMessageRemoved");
     if (m_currentChatId == chatId) {
-        if (m_messageWidgetsById.contains(messageId) && m_messageWidgetsById[messageId] == m_currentAudioSourceWidget) {
-            m_currentAudioSourceWidget = nullptr;
-        }
-        for (int i = 0; i < m_chatList->count(); i++) {
-            QListWidgetItem* item = m_chatList->item(i);
-            if (item->data(Qt::UserRole + 6).toString() == messageId) {
-                delete m_chatList->takeItem(i);
-                break;
-            }
-        }
-        m_messageItemsById.remove(messageId);
-        m_messageWidgetsById.remove(messageId);
-        m_currentMessagePreviewById.remove(messageId);
-        m_currentMessageSenderById.remove(messageId);
+        releaseMessageWidget(messageId);
+        m_messageModel->removeMessage(messageId);
+        m_messageDelegate->invalidateMessage(messageId);
         updatePinnedMessageBar();
     }
-    m_messageItemsById.remove(messageId);
-    m_messageWidgetsById.remove(messageId);
-    m_currentMessagePreviewById.remove(messageId);
-    m_currentMessageSenderById.remove(messageId);
-}
-
-void MainWindow::onPresenceUpdated(const QString& userId, bool online)
-{
-    if (!m_users.contains(userId)) {
-        return;
-    }
-    m_users[userId].online = online;
-
-    std::vector<User> users;
-    users.reserve(static_cast<size_t>(m_users.size()));
-    for (auto it = m_users.constBegin(); it != m_users.constEnd(); ++it) {
-        users.push_back(it.value());
-    }
-    onUserListUpdated(users);
 }
 
 void MainWindow::onTypingReceived(const QString& chatId, const QString& senderId)
 {
+    NOVEO_TRACE_SCOPE("MainWindow::onTypingReceived");
     if (chatId != m_currentChatId || senderId == m_client->currentUserId()) {
         return;
     }
 
     QString senderName = senderId;
-    if (m_users.contains(senderId) && !m_users[senderId].username.isEmpty()) {
-        senderName = m_users[senderId].username;
+    if (m_store->users().contains(senderId) && !m_store->user(senderId).username.isEmpty()) {
+        senderName = m_store->user(senderId).username;
     }
     statusBar()->showMessage(senderName + " is typing...", 2000);
 }
 
 void MainWindow::onPasswordChanged(const QString& token, qint64 expiresAt, const QString& warning)
 {
+    NOVEO_TRACE_SCOPE("MainWindow::onPasswordChanged");
     if (token.isEmpty()) {
         return;
     }
@@ -4818,23 +4399,96 @@ void MainWindow::onPasswordChanged(const QString& token, qint64 expiresAt, const
     }
 }
 
-void MainWindow::onUserUpdated(const User& user)
+void MainWindow::onUserChanged(const User& user, bool profileChanged)
 {
-    if (user.userId.isEmpty()) {
+    NOVEO_TRACE_SCOPE("MainWindow::onUserChanged");
+    if (user.userId == m_client->currentUserId() && m_settingsDialog) {
+        m_settingsDialog->setBlockGroupInvites(user.blockGroupInvites);
+    }
+    if (!profileChanged) {
         return;
     }
-    m_users[user.userId] = user;
+    patchUserRows(user);
+    updatePinnedMessageBar();
+}
 
-    std::vector<User> users;
-    users.reserve(static_cast<size_t>(m_users.size()));
-    for (auto it = m_users.constBegin(); it != m_users.constEnd(); ++it) {
-        users.push_back(it.value());
+void MainWindow::patchUserRows(const User& user)
+{
+    QString fullUrl = user.avatarUrl;
+    if (!fullUrl.startsWith("http")) {
+        fullUrl = API_BASE_URL + fullUrl;
+    }
+
+    if (user.userId != m_client->currentUserId()) {
+        QListWidgetItem* contactItem = nullptr;
+        for (int i = 0; i < m_contactListWidget->count(); ++i) {
+            if (m_contactListWidget->item(i)->data(Qt::UserRole).toString() == user.userId) {
+                contactItem = m_contactListWidget->takeItem(i);
+                break;
+            }
+        }
+        if (!contactItem) {
+            contactItem = new QListWidgetItem();
+            contactItem->setData(Qt::UserRole, user.userId);
+        }
+        contactItem->setText(user.username);
+        contactItem->setData(AvatarUrlRole, fullUrl);
+        contactItem->setIcon(getAvatar(user.username, fullUrl));
+
+        const QString key = user.username.toLower();
+        int lo = 0;
+        int hi = m_contactListWidget->count();
+        while (lo < hi) {
+            const int mid = lo + (hi - lo) / 2;
+            if (m_contactListWidget->item(mid)->text().toLower() < key) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        m_contactListWidget->insertItem(lo, contactItem);
+        applyContactsFilter(m_contactsSearchInput ? m_contactsSearchInput->text() : QString());
+    }
+
+    for (int i = 0; i < m_chatListWidget->count(); ++i) {
+        QListWidgetItem* item = m_chatListWidget->item(i);
+        const QString chatId = item->data(Qt::UserRole).toString();
+        if (!m_store->chats().contains(chatId)) {
+            continue;
+        }
+        const Chat& chat = m_store->chat(chatId);
+        if (chat.chatType != "private" || user.userId == m_client->currentUserId() ||
+            !chat.members.contains(user.userId)) {
+            continue;
+        }
+        const QString name = resolveChatName(chat);
+        QString chatUrl = chat.avatarUrl.isEmpty() ? user.avatarUrl : chat.avatarUrl;
+        if (!chatUrl.startsWith("http")) {
+            chatUrl = API_BASE_URL + chatUrl;
+        }
+        item->setText(name);
+        item->setData(AvatarUrlRole, chatUrl);
+        item->setIcon(getAvatar(name, chatUrl));
+        if (chatId == m_currentChatId) {
+            m_chatTitle->setText(name);
+        }
+    }
+
+    if (m_currentChatId.isEmpty()) {
+        return;
+    }
+    const QStringList affected = m_messageModel->messagesFromSender(user.userId);
+    for (const QString& messageId : affected) {
+        releaseMessageWidget(messageId);
+        m_messageModel->refreshMessage(messageId);
+    }
+    if (!affected.isEmpty()) {
+        scheduleMessageWidgetMaterialization();
     }
-    onUserListUpdated(users);
-    updatePinnedMessageBar();
 }
 
 void MainWindow::onSendBtnClicked() {
+    NOVEO_TRACE_SCOPE("MainWindow::onSendBtnClicked");
     hideStickerPanel();
     QString text = m_messageInput->text().trimmed();
     if (text.isEmpty() || m_currentChatId.isEmpty()) return;
@@ -4862,7 +4516,8 @@ void MainWindow::onSendBtnClicked() {
         pendingMsg.replyToId = m_replyingToMessageId;
     }
 
-    m_pendingMessages[tempId] = pendingMsg;
+    pendingMsg.clientMessageId = m_client->sendMessage(m_currentChatId, text, m_replyingToMessageId);
+    m_store->trackPending(pendingMsg);
 
     bool wasAtBottom = isScrolledToBottom();
     addMessageBubble(pendingMsg, false, false);
@@ -4871,8 +4526,6 @@ void MainWindow::onSendBtnClicked() {
         smoothScrollToBottom();
     }
 
-    m_client->sendMessage(m_currentChatId, text, m_replyingToMessageId);
-
     m_messageInput->clear();
     if (!m_replyingToMessageId.isEmpty()) {
         onCancelReply();
@@ -4880,34 +4533,39 @@ void MainWindow::onSendBtnClicked() {
 }
 
 void MainWindow::focusOnMessage(const QString& messageId) {
-    for (int i = 0; i < m_chatList->count(); i++) {
-        QListWidgetItem* item = m_chatList->item(i);
-        QString itemMsgId = item->data(Qt::UserRole + 6).toString();
-        if (itemMsgId == messageId) {
-            m_chatList->scrollToItem(item, QAbstractItemView::PositionAtCenter);
-
-            if (!m_highlightedMessageId.isEmpty() && m_messageWidgetsById.contains(m_highlightedMessageId)) {
-                m_messageWidgetsById[m_highlightedMessageId]->setHighlighted(false);
-            }
-            m_highlightedMessageId = messageId;
-            if (m_messageWidgetsById.contains(messageId)) {
-                m_messageWidgetsById[messageId]->setHighlighted(true);
-            }
-            QTimer::singleShot(3000, this, [this]() {
-                if (m_messageWidgetsById.contains(m_highlightedMessageId)) {
-                    m_messageWidgetsById[m_highlightedMessageId]->setHighlighted(false);
-                }
-                m_highlightedMessageId.clear();
-            });
-            break;
-        }
+    if (m_messageModel->rowForMessage(messageId) < 0) {
+        revealOlderMessages(messageId);
     }
+    const QModelIndex index = m_messageModel->indexForMessage(messageId);
+    if (!index.isValid()) {
+        return;
+    }
+    m_chatList->scrollTo(index, QAbstractItemView::PositionAtCenter);
+
+    if (!m_highlightedMessageId.isEmpty() && m_messageWidgetsById.contains(m_highlightedMessageId)) {
+        m_messageWidgetsById[m_highlightedMessageId]->setHighlighted(false);
+    }
+    m_highlightedMessageId = messageId;
+    m_messageDelegate->setHighlightedMessage(messageId);
+    materializeVisibleMessageWidgets();
+    if (m_messageWidgetsById.contains(messageId)) {
+        m_messageWidgetsById[messageId]->setHighlighted(true);
+    }
+    QTimer::singleShot(3000, this, [this]() {
+        if (m_messageWidgetsById.contains(m_highlightedMessageId)) {
+            m_messageWidgetsById[m_highlightedMessageId]->setHighlighted(false);
+        }
+        m_highlightedMessageId.clear();
+        m_messageDelegate->setHighlightedMessage(QString());
+        m_chatList->viewport()->update();
+    });
 }
 
 void MainWindow::onChatListItemClicked(const QModelIndex& index) {
-    const QString fileUrl = index.data(FileUrlRole).toString();
+    NOVEO_TRACE_SCOPE("MainWindow::onChatListItemClicked");
+    const QString fileUrl = index.data(MessageListModel::FileUrlRole).toString();
     if (!fileUrl.isEmpty()) {
-        QString type = index.data(FileTypeRole).toString().toLower();
+        QString type = index.data(MessageListModel::FileTypeRole).toString().toLower();
         if (type.isEmpty()) {
             const QString lower = fileUrl.toLower();
             if (lower.endsWith(".png") || lower.endsWith(".jpg") || lower.endsWith(".jpeg") || lower.endsWith(".gif") || lower.endsWith(".webp")) {
@@ -4998,8 +4656,8 @@ void MainWindow::showNotificationForMessage(const Message& msg)
     }
 
     QString title = "New message";
-    if (m_chats.contains(msg.chatId)) {
-        title = resolveChatName(m_chats[msg.chatId]);
+    if (m_store->chats().contains(msg.chatId)) {
+        title = resolveChatName(m_store->chat(msg.chatId));
     }
 
     QString body = displayTextForMessage(msg).trimmed();
@@ -5031,6 +4689,7 @@ void MainWindow::closeEvent(QCloseEvent* event)
 
 void MainWindow::onTrayIconActivated(QSystemTrayIcon::ActivationReason reason)
 {
+    NOVEO_TRACE_SCOPE("MainWindow::onTrayIconActivated");
     if (reason == QSystemTrayIcon::Trigger || reason == QSystemTrayIcon::DoubleClick) {
         onTrayShowHide();
     }
@@ -5038,6 +4697,7 @@ void MainWindow::onTrayIconActivated(QSystemTrayIcon::ActivationReason reason)
 
 void MainWindow::onTrayShowHide()
 {
+    NOVEO_TRACE_SCOPE("MainWindow::onTrayShowHide");
     if (isVisible() && !isMinimized()) {
         hide();
     } else {
@@ -5049,6 +4709,7 @@ void MainWindow::onTrayShowHide()
 
 void MainWindow::onTrayQuit()
 {
+    NOVEO_TRACE_SCOPE("MainWindow::onTrayQuit");
     m_manualDisconnect = true;
     if (m_reconnectTimer) {
         m_reconnectTimer->stop();
@@ -5062,6 +4723,7 @@ void MainWindow::onTrayQuit()
 
 void MainWindow::onNotificationsToggled(bool checked)
 {
+    NOVEO_TRACE_SCOPE("MainWindow::onNotificationsToggled");
     m_notificationsEnabled = checked;
     QSettings settings("Noveo", "MessengerClient");
     settings.setValue("notificationsEnabled", m_notificationsEnabled);
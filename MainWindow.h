@@ -21,11 +21,14 @@
 #include <QAction>
 #include <QCloseEvent>
 #include <QJsonObject>
+#include <QElapsedTimer>
 #include <QPointer>
 #include <QTimer>
 
 #include "WebSocketClient.h"
+#include "ChatStore.h"
 #include "DataStructures.h"
+#include "LocalStore.h"
 #include "RestClient.h"
 #include "SessionStore.h"
 #include "UpdaterService.h"
@@ -37,9 +40,14 @@
 
 class QFrame;
 class QGridLayout;
+class QListView;
 class QMediaPlayer;
 class QScrollArea;
 class QSlider;
+class MessageDelegate;
+class MessageWidgetPool;
+class MessageListModel;
+struct MessageRow;
 
 class UserListDelegate : public QStyledItemDelegate {
     Q_OBJECT
@@ -62,6 +70,8 @@ public:
     ~MainWindow();
 
     QString getReplyPreviewText(const QString& replyToId, const QString& chatId);
+    // One-line summary used for previews, replies and notifications.
+    static QString displayTextForMessage(const Message& msg);
     void focusOnMessage(const QString& messageId);
 
 protected:
@@ -78,12 +88,13 @@ private slots:
     void onAuthFailed(const QString& msg);
 
     void onChatHistoryReceived(const std::vector<Chat>& chats);
-    void onMessageReceived(const Message& msg);
-    void onUserListUpdated(const std::vector<User>& users);
+    void onChatDeltaReceived(const std::vector<Chat>& chats);
+    void onChatHistoryBatchReceived(const std::vector<Chat>& batch, bool first, bool last);
+    void onMessageAdded(const Message& msg, const QString& pendingId);
+    void onUsersReset();
 
     void onSendBtnClicked();
     void onNewChatCreated(const Chat& chat);
-    void onMessageSeenUpdate(const QString& chatId, const QString& messageId, const QString& userId);
 
     void onChatSelected(QListWidgetItem* item);
     void onContactSelected(QListWidgetItem* item);
@@ -100,12 +111,11 @@ private slots:
     void onCancelEdit();
     void onCancelReply();
 
-    void onMessageUpdated(const QString& chatId, const QString& messageId, const QString& newContent, qint64 editedAt);
-    void onMessageDeleted(const QString& chatId, const QString& messageId);
-    void onPresenceUpdated(const QString& userId, bool online);
+    void onMessageEdited(const QString& chatId, const QString& messageId, const QString& newContent, qint64 editedAt);
+    void onMessageRemoved(const QString& chatId, const QString& messageId);
     void onTypingReceived(const QString& chatId, const QString& senderId);
     void onPasswordChanged(const QString& token, qint64 expiresAt, const QString& warning);
-    void onUserUpdated(const User& user);
+    void onUserChanged(const User& user, bool profileChanged);
 
     void onScrollValueChanged(int value);
     void onChatListItemClicked(const QModelIndex& index);
@@ -121,7 +131,15 @@ private:
     QString uiText(const QString& key) const;
     void applyLayoutDirectionForLanguage(const QString& languageCode);
     bool shouldForceReloginForAuthError(const QString& message) const;
+    bool autoSessionReconnectEnabled() const;
     void tryReconnectWithSavedSession();
+    QHash<QString, qint64> syncCursors() const;
+    void onLocalSnapshotLoaded(const LocalStore::Snapshot& snapshot);
+    void discardLocalPreload();
+    void recordFirstRender(bool fromLocalStore);
+    void recordFirstChatRow();
+    void sampleDiagnostics();
+    QListWidgetItem* createChatListItem(const Chat& chat);
     void updatePinnedMessageBar();
     void updateComposerStateForCurrentChat();
     void openStickerPicker();
@@ -142,7 +160,6 @@ private:
     void createChannelFromSidebar();
     QString resolveRecipientIdForChat(const QString& chatId) const;
     QString resolveFileUrl(const QString& rawUrl) const;
-    QString displayTextForMessage(const Message& msg) const;
     void startReplyToMessage(const QString& messageId);
     void startEditMessage(const QString& messageId);
     void deleteMessageById(const QString& messageId);
@@ -150,13 +167,24 @@ private:
     void playAudioTrack(const QString& fileUrl, const QString& trackName, MessageItemWidget* sourceWidget = nullptr);
     void openMediaInViewer(const QString& mediaType, const QString& fileUrl);
     void refreshMessageWidgetSizes();
-    void syncMessageWidgetSize(QListWidgetItem* item);
-    void rebuildCurrentMessageCaches(const QString& chatId);
+    bool syncMessageWidgetSize(const QString& messageId);
+    void scheduleMessageWidgetMaterialization();
+    void materializeVisibleMessageWidgets();
+    void releaseMessageWidget(const QString& messageId);
+    void patchUserRows(const User& user);
+    void clearMessageView();
     void openAddMembersDialogForChat(const QString& chatId);
 
     void renderMessages(const QString& chatId);
     void addMessageBubble(const Message& msg, bool appendStretch, bool animate);
-    void prependMessageBubble(const Message& msg);
+    bool confirmPendingBubble(const QString& pendingId, const Message& confirmed);
+    void prependMessageBubbles(const std::vector<Message>& messages);
+    // Prepends the page of held messages above the oldest row, or down to
+    // untilMessageId; false when nothing older is held locally.
+    bool revealOlderMessages(const QString& untilMessageId = QString());
+    MessageRow buildMessageRow(const Message& msg);
+    MessageItemWidget* createMessageWidget(const Message& msg, const MessageRow& row);
+    void connectMessageWidget(MessageItemWidget* widget);
 
     QString resolveChatName(const Chat& chat);
     QColor getColorForName(const QString& name);
@@ -169,18 +197,19 @@ private:
     void smoothScrollToBottom();
     bool isScrolledToBottom() const;
 
-    void updateMessageStatus(const QString& messageId, MessageStatus newStatus);
-    MessageStatus calculateMessageStatus(const Message& msg, const Chat& chat);
+    void updateMessageStatus(const QString& chatId, const QString& messageId, MessageStatus newStatus);
 
     void setupTrayIcon();
     void showNotificationForMessage(const Message& msg);
 
 private:
     WebSocketClient* m_client = nullptr;
+    ChatStore* m_store = nullptr;
     QNetworkAccessManager* m_nam = nullptr;
     RestClient* m_restClient = nullptr;
     UpdaterService* m_updaterService = nullptr;
     VoiceAudioBridge* m_voiceAudio = nullptr;
+    LocalStore* m_localStore = nullptr;
 
     QStackedWidget* m_stackedWidget = nullptr;
     QWidget* m_loginPage = nullptr;
@@ -238,7 +267,10 @@ private:
     QLabel* m_chatTitle = nullptr;
     QPushButton* m_chatSettingsBtn = nullptr;
     QPushButton* m_voiceCallBtn = nullptr;
-    QListWidget* m_chatList = nullptr;
+    QListView* m_chatList = nullptr;
+    MessageListModel* m_messageModel = nullptr;
+    MessageDelegate* m_messageDelegate = nullptr;
+    MessageWidgetPool* m_messageWidgetPool = nullptr;
     QWidget* m_pinnedBar = nullptr;
     QLabel* m_pinnedLabel = nullptr;
     QPushButton* m_openPinnedBtn = nullptr;
@@ -269,8 +301,6 @@ private:
     bool m_canDownloadUpdate = false;
     bool m_canInstallUpdate = false;
 
-    QMap<QString, User> m_users;
-    QMap<QString, Chat> m_chats;
     QString m_currentChatId;
     QString m_currentVoiceChatId;
     QString m_authToken;
@@ -283,17 +313,34 @@ private:
     bool m_waitingForSessionReconnectResult = false;
     bool m_hasAuthenticatedSession = false;
     bool m_blockAutoSessionReconnect = false;
+    // The store's chats were seeded from LocalStore and has not been reconciled with
+    // the server's chat_history yet.
+    bool m_chatsFromLocalStore = false;
+
+    // Startup metric: ms from MainWindow construction to the first chat list
+    // render, and whether local data or the server provided it.
+    QElapsedTimer m_startupClock;
+    qint64 m_firstRenderMs = -1;
+    bool m_firstRenderFromLocalStore = false;
+    // Startup -> first sidebar row, from whichever source got there first.
+    qint64 m_firstChatRowMs = -1;
+    // Duration of the last renderMessages(), i.e. a chat switch.
+    qint64 m_lastChatSwitchMs = -1;
+    bool m_progressiveHistory = false;
+    std::vector<Chat> m_deferredHistory;
 
     bool m_isDarkMode = false;
     bool m_notificationsEnabled = true;
     QString m_highlightedMessageId;
 
-    QMap<QString, Message> m_pendingMessages;
-    QMap<QString, QListWidgetItem*> m_messageItemsById;
     QMap<QString, MessageItemWidget*> m_messageWidgetsById;
-    QMap<QString, QString> m_currentMessagePreviewById;
-    QMap<QString, QString> m_currentMessageSenderById;
     QTimer* m_messageResizeDebounceTimer = nullptr;
+    QTimer* m_messageMaterializeTimer = nullptr;
+    // Runs only while the Diagnostics page is open: measures how late each
+    // tick fires (event-loop lag) and publishes gauges to Metrics.
+    QTimer* m_diagnosticsTimer = nullptr;
+    QElapsedTimer m_diagnosticsTickClock;
+    qint64 m_eventLoopLagPeakMs = 0;
     int m_lastMessageViewportWidth = -1;
 
     QString m_editingMessageId;
@@ -305,8 +352,8 @@ private:
 
     bool m_isLoadingHistory = false;
 
-    QMap<QString, QPixmap> m_avatarCache;
     QSet<QString> m_pendingDownloads;
+    QPointer<QNetworkReply> m_activeUpload;
 
     QSystemTrayIcon* m_trayIcon = nullptr;
     QMenu* m_trayMenu = nullptr;
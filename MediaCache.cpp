@@ -0,0 +1,295 @@
+#include "MediaCache.h"
+
+#include "AppConfig.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QPointer>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace {
+constexpr qint64 kRevalidateAfterSecs = 24 * 60 * 60;
+constexpr int kIndexSaveDelayMs = 2000;
+const QString kIndexFileName = QStringLiteral("index.json");
+
+int pixmapCost(const QPixmap& pixmap)
+{
+    const qint64 bytes = static_cast<qint64>(pixmap.width()) * pixmap.height() * qMax(1, pixmap.depth() / 8);
+    return static_cast<int>(qBound<qint64>(1, bytes, std::numeric_limits<int>::max()));
+}
+}
+
+MediaCache::MediaCache(QObject* parent)
+    : QObject(parent)
+{
+    m_memory.setMaxCost(static_cast<int>(qMin<qint64>(AppConfig::mediaMemoryBudgetBytes(), std::numeric_limits<int>::max())));
+    m_diskBudgetBytes = AppConfig::mediaDiskBudgetBytes();
+    m_dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/media");
+    QDir().mkpath(m_dir);
+
+    m_indexSaveTimer = new QTimer(this);
+    m_indexSaveTimer->setSingleShot(true);
+    m_indexSaveTimer->setInterval(kIndexSaveDelayMs);
+    connect(m_indexSaveTimer, &QTimer::timeout, this, &MediaCache::saveIndex);
+
+    loadIndex();
+}
+
+MediaCache::~MediaCache()
+{
+    if (m_indexSaveTimer->isActive()) {
+        saveIndex();
+    }
+}
+
+MediaCache* MediaCache::instance()
+{
+    static QPointer<MediaCache> cache;
+    if (!cache) {
+        cache = new MediaCache(qApp);
+    }
+    return cache;
+}
+
+bool MediaCache::findPixmap(const QString& key, QPixmap* out)
+{
+    const QPixmap* cached = m_memory.object(key);
+    if (!cached) {
+        ++m_stats.memoryMisses;
+        return false;
+    }
+    ++m_stats.memoryHits;
+    if (out) {
+        *out = *cached;
+    }
+    return true;
+}
+
+bool MediaCache::peekPixmap(const QString& key, QPixmap* out) const
+{
+    const QPixmap* cached = m_memory.object(key);
+    if (!cached) {
+        return false;
+    }
+    if (out) {
+        *out = *cached;
+    }
+    return true;
+}
+
+void MediaCache::insertPixmap(const QString& key, const QPixmap& pixmap)
+{
+    if (pixmap.isNull()) {
+        return;
+    }
+    m_memory.insert(key, new QPixmap(pixmap), pixmapCost(pixmap));
+}
+
+void MediaCache::clearMemory()
+{
+    m_memory.clear();
+}
+
+bool MediaCache::lookupDisk(const QUrl& url, QString* path, bool* needsRevalidation)
+{
+    auto it = m_disk.find(url.toString());
+    if (it == m_disk.end()) {
+        ++m_stats.diskMisses;
+        return false;
+    }
+    ++m_stats.diskHits;
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    it->accessedAt = now;
+    scheduleIndexSave();
+    if (path) {
+        *path = m_dir + QLatin1Char('/') + it->fileName;
+    }
+    if (needsRevalidation) {
+        *needsRevalidation = (now - it->validatedAt) > kRevalidateAfterSecs;
+    }
+    return true;
+}
+
+void MediaCache::prepareRequest(const QUrl& url, QNetworkRequest* request) const
+{
+    const auto it = m_disk.constFind(url.toString());
+    if (it == m_disk.constEnd()) {
+        return;
+    }
+    if (!it->etag.isEmpty()) {
+        request->setRawHeader("If-None-Match", it->etag);
+    }
+    if (!it->lastModified.isEmpty()) {
+        request->setRawHeader("If-Modified-Since", it->lastModified);
+    }
+}
+
+bool MediaCache::handleResponse(const QUrl& url, QNetworkReply* reply, const QByteArray& body)
+{
+    ++m_stats.networkFetches;
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status == 304) {
+        auto it = m_disk.find(url.toString());
+        if (it != m_disk.end()) {
+            ++m_stats.revalidated;
+            it->validatedAt = QDateTime::currentSecsSinceEpoch();
+            scheduleIndexSave();
+            return true;
+        }
+        return false;
+    }
+    if (reply->error() == QNetworkReply::NoError && !body.isEmpty()) {
+        storeDisk(url, body, reply->rawHeader("ETag"), reply->rawHeader("Last-Modified"));
+    }
+    return false;
+}
+
+void MediaCache::dropDisk(const QUrl& url)
+{
+    const auto it = m_disk.find(url.toString());
+    if (it == m_disk.end()) {
+        return;
+    }
+    QFile::remove(m_dir + QLatin1Char('/') + it->fileName);
+    m_diskBytes -= it->size;
+    m_disk.erase(it);
+    scheduleIndexSave();
+}
+
+MediaCache::Stats MediaCache::stats() const
+{
+    Stats result = m_stats;
+    result.memoryBytes = m_memory.totalCost();
+    result.memoryBudgetBytes = m_memory.maxCost();
+    result.diskBytes = m_diskBytes;
+    result.diskBudgetBytes = m_diskBudgetBytes;
+    return result;
+}
+
+void MediaCache::storeDisk(const QUrl& url, const QByteArray& body, const QByteArray& etag, const QByteArray& lastModified)
+{
+    if (body.size() > m_diskBudgetBytes / 4) {
+        return;
+    }
+    const QString key = url.toString();
+    const QString fileName = QString::fromLatin1(QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex());
+    const QString path = m_dir + QLatin1Char('/') + fileName;
+
+    // The entry only becomes visible once the file is fully on disk, so a
+    // concurrent lookup never hands out a half-written file.
+    QPointer<MediaCache> self(this);
+    QThreadPool::globalInstance()->start([self, key, fileName, path, body, etag, lastModified]() {
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly) || file.write(body) != body.size() || !file.commit()) {
+            return;
+        }
+        if (!self) {
+            return;
+        }
+        QMetaObject::invokeMethod(self.data(), [self, key, fileName, size = body.size(), etag, lastModified]() {
+            const qint64 now = QDateTime::currentSecsSinceEpoch();
+            DiskEntry& entry = self->m_disk[key];
+            self->m_diskBytes += size - entry.size;
+            entry.fileName = fileName;
+            entry.size = size;
+            entry.etag = etag;
+            entry.lastModified = lastModified;
+            entry.validatedAt = now;
+            entry.accessedAt = now;
+            self->evictDiskIfNeeded();
+            self->scheduleIndexSave();
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MediaCache::evictDiskIfNeeded()
+{
+    if (m_diskBytes <= m_diskBudgetBytes) {
+        return;
+    }
+    std::vector<std::pair<qint64, QString>> byAge;
+    byAge.reserve(static_cast<size_t>(m_disk.size()));
+    for (auto it = m_disk.constBegin(); it != m_disk.constEnd(); ++it) {
+        byAge.emplace_back(it->accessedAt, it.key());
+    }
+    std::sort(byAge.begin(), byAge.end());
+
+    // Trim to 90% so a burst of new entries does not evict on every store.
+    const qint64 target = m_diskBudgetBytes - m_diskBudgetBytes / 10;
+    for (const auto& candidate : byAge) {
+        if (m_diskBytes <= target) {
+            break;
+        }
+        const auto it = m_disk.find(candidate.second);
+        QFile::remove(m_dir + QLatin1Char('/') + it->fileName);
+        m_diskBytes -= it->size;
+        m_disk.erase(it);
+    }
+}
+
+void MediaCache::loadIndex()
+{
+    QFile file(m_dir + QLatin1Char('/') + kIndexFileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    for (auto it = root.constBegin(); it != root.constEnd(); ++it) {
+        const QJsonObject obj = it.value().toObject();
+        DiskEntry entry;
+        entry.fileName = obj.value(QStringLiteral("file")).toString();
+        entry.size = static_cast<qint64>(obj.value(QStringLiteral("size")).toDouble());
+        entry.etag = obj.value(QStringLiteral("etag")).toString().toUtf8();
+        entry.lastModified = obj.value(QStringLiteral("lastModified")).toString().toUtf8();
+        entry.validatedAt = static_cast<qint64>(obj.value(QStringLiteral("validatedAt")).toDouble());
+        entry.accessedAt = static_cast<qint64>(obj.value(QStringLiteral("accessedAt")).toDouble());
+        if (entry.fileName.isEmpty() || !QFile::exists(m_dir + QLatin1Char('/') + entry.fileName)) {
+            continue;
+        }
+        m_disk.insert(it.key(), entry);
+        m_diskBytes += entry.size;
+    }
+    evictDiskIfNeeded();
+}
+
+void MediaCache::scheduleIndexSave()
+{
+    if (!m_indexSaveTimer->isActive()) {
+        m_indexSaveTimer->start();
+    }
+}
+
+void MediaCache::saveIndex()
+{
+    m_indexSaveTimer->stop();
+    QJsonObject root;
+    for (auto it = m_disk.constBegin(); it != m_disk.constEnd(); ++it) {
+        root.insert(it.key(), QJsonObject{
+            {QStringLiteral("file"), it->fileName},
+            {QStringLiteral("size"), static_cast<double>(it->size)},
+            {QStringLiteral("etag"), QString::fromUtf8(it->etag)},
+            {QStringLiteral("lastModified"), QString::fromUtf8(it->lastModified)},
+            {QStringLiteral("validatedAt"), static_cast<double>(it->validatedAt)},
+            {QStringLiteral("accessedAt"), static_cast<double>(it->accessedAt)},
+        });
+    }
+    QSaveFile file(m_dir + QLatin1Char('/') + kIndexFileName);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+        file.commit();
+    }
+}
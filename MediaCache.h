@@ -0,0 +1,87 @@
+#ifndef MEDIACACHE_H
+#define MEDIACACHE_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QHash>
+#include <QObject>
+#include <QPixmap>
+#include <QString>
+#include <QUrl>
+
+class QNetworkReply;
+class QNetworkRequest;
+class QTimer;
+
+// Two-tier cache shared by every image consumer (through ImagePipeline).
+// The memory tier holds decoded pixmaps under a byte budget with LRU
+// eviction. The disk tier keeps the original response bytes under
+// CacheLocation/media with a persistent JSON index, a byte cap and
+// ETag / Last-Modified validators for conditional revalidation.
+class MediaCache : public QObject
+{
+    Q_OBJECT
+public:
+    struct Stats {
+        quint64 memoryHits = 0;
+        quint64 memoryMisses = 0;
+        quint64 diskHits = 0;
+        quint64 diskMisses = 0;
+        quint64 revalidated = 0;
+        quint64 networkFetches = 0;
+        qint64 memoryBytes = 0;
+        qint64 memoryBudgetBytes = 0;
+        qint64 diskBytes = 0;
+        qint64 diskBudgetBytes = 0;
+    };
+
+    struct DiskEntry {
+        QString fileName;
+        qint64 size = 0;
+        QByteArray etag;
+        QByteArray lastModified;
+        qint64 validatedAt = 0;
+        qint64 accessedAt = 0;
+    };
+
+    static MediaCache* instance();
+    ~MediaCache() override;
+
+    bool findPixmap(const QString& key, QPixmap* out);
+    // Same lookup, left out of the hit/miss counts.
+    bool peekPixmap(const QString& key, QPixmap* out) const;
+    void insertPixmap(const QString& key, const QPixmap& pixmap);
+    void clearMemory();
+
+    // Returns the on-disk copy for url, if any. needsRevalidation is set
+    // when the copy is older than the freshness window.
+    bool lookupDisk(const QUrl& url, QString* path, bool* needsRevalidation);
+    // Adds If-None-Match / If-Modified-Since when a disk copy exists.
+    void prepareRequest(const QUrl& url, QNetworkRequest* request) const;
+    // Records the outcome of a network fetch: a 304 refreshes the disk
+    // entry, a 200 replaces it. Returns true for 304.
+    bool handleResponse(const QUrl& url, QNetworkReply* reply, const QByteArray& body);
+    // Forgets a disk entry whose file turned out to be missing or corrupt.
+    void dropDisk(const QUrl& url);
+
+    Stats stats() const;
+
+private:
+    explicit MediaCache(QObject* parent = nullptr);
+
+    void loadIndex();
+    void scheduleIndexSave();
+    void saveIndex();
+    void storeDisk(const QUrl& url, const QByteArray& body, const QByteArray& etag, const QByteArray& lastModified);
+    void evictDiskIfNeeded();
+
+    QCache<QString, QPixmap> m_memory;
+    QHash<QString, DiskEntry> m_disk;
+    QString m_dir;
+    qint64 m_diskBytes = 0;
+    qint64 m_diskBudgetBytes = 0;
+    QTimer* m_indexSaveTimer = nullptr;
+    Stats m_stats;
+};
+
+#endif // MEDIACACHE_H
@@ -1,5 +1,7 @@
 #include "MediaViewerDialog.h"
 
+#include "ImagePipeline.h"
+
 #include <QHBoxLayout>
 #include <QHideEvent>
 #include <QKeyEvent>
@@ -7,9 +9,6 @@
 #include <QMediaContent>
 #include <QMediaPlayer>
 #include <QMouseEvent>
-#include <QNetworkAccessManager>
-#include <QNetworkReply>
-#include <QNetworkRequest>
 #include <QPixmap>
 #include <QPushButton>
 #include <QResizeEvent>
@@ -19,8 +18,7 @@
 #include <QVideoWidget>
 
 MediaViewerDialog::MediaViewerDialog(QWidget* parent)
-    : QDialog(parent),
-      m_nam(new QNetworkAccessManager(this))
+    : QDialog(parent)
 {
     setWindowTitle(QStringLiteral("Media Viewer"));
     setModal(true);
@@ -76,12 +74,7 @@ MediaViewerDialog::MediaViewerDialog(QWidget* parent)
     positionCloseButton();
 }
 
-MediaViewerDialog::~MediaViewerDialog()
-{
-    if (m_pendingReply) {
-        m_pendingReply->abort();
-    }
-}
+MediaViewerDialog::~MediaViewerDialog() = default;
 
 void MediaViewerDialog::showImage(const QUrl& url)
 {
@@ -108,10 +101,7 @@ void MediaViewerDialog::showVideo(const QUrl& url)
     if (parentWidget()) {
         setGeometry(parentWidget()->frameGeometry());
     }
-    if (m_pendingReply) {
-        m_pendingReply->abort();
-        m_pendingReply = nullptr;
-    }
+    ImagePipeline::instance()->cancel(this);
     m_stack->setCurrentWidget(m_videoWidget->parentWidget());
     m_videoPlayer->setMedia(QMediaContent(url));
     m_videoPlayer->play();
@@ -122,10 +112,7 @@ void MediaViewerDialog::showVideo(const QUrl& url)
 
 void MediaViewerDialog::clearMedia()
 {
-    if (m_pendingReply) {
-        m_pendingReply->abort();
-        m_pendingReply = nullptr;
-    }
+    ImagePipeline::instance()->cancel(this);
     if (m_videoPlayer) {
         m_videoPlayer->stop();
     }
@@ -183,37 +170,13 @@ void MediaViewerDialog::loadImageFromUrl(const QUrl& url)
         return;
     }
 
-    if (url.isLocalFile() || url.scheme().isEmpty()) {
-        QPixmap px(url.isLocalFile() ? url.toLocalFile() : url.toString());
-        if (px.isNull()) {
-            m_imageLabel->setText(QStringLiteral("Unable to load image."));
-            return;
-        }
-        m_currentImage = px;
+    ImagePipeline::instance()->cancel(this);
+    if (ImagePipeline::instance()->cachedPixmap(url, QSize(), ImagePipeline::Shape::Fit, &m_currentImage)) {
         updateImageDisplay();
         return;
     }
-
-    if (m_pendingReply) {
-        m_pendingReply->abort();
-        m_pendingReply = nullptr;
-    }
-
-    QNetworkRequest request(url);
-    m_pendingReply = m_nam->get(request);
-    connect(m_pendingReply, &QNetworkReply::finished, this, [this]() {
-        QNetworkReply* reply = m_pendingReply;
-        m_pendingReply = nullptr;
-        if (!reply) {
-            return;
-        }
-        reply->deleteLater();
-        if (reply->error() != QNetworkReply::NoError) {
-            m_imageLabel->setText(QStringLiteral("Unable to load image."));
-            return;
-        }
-        QPixmap px;
-        if (!px.loadFromData(reply->readAll())) {
+    ImagePipeline::instance()->load(url, QSize(), ImagePipeline::Shape::Fit, this, [this](const QPixmap& px) {
+        if (px.isNull()) {
             m_imageLabel->setText(QStringLiteral("Unable to load image."));
             return;
         }
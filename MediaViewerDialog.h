@@ -9,8 +9,6 @@ class QLabel;
 class QKeyEvent;
 class QMediaPlayer;
 class QMouseEvent;
-class QNetworkAccessManager;
-class QNetworkReply;
 class QPushButton;
 class QResizeEvent;
 class QStackedWidget;
@@ -44,8 +42,6 @@ private:
     QVideoWidget* m_videoWidget = nullptr;
     QPushButton* m_closeButton = nullptr;
     QMediaPlayer* m_videoPlayer = nullptr;
-    QNetworkAccessManager* m_nam = nullptr;
-    QNetworkReply* m_pendingReply = nullptr;
     QPixmap m_currentImage;
 };
 
@@ -0,0 +1,267 @@
+#include "MessageDelegate.h"
+
+#include "MessageItemWidget.h"
+#include "MessageListModel.h"
+#include "MessageWidgetPool.h"
+
+#include <QAbstractItemView>
+#include <QDateTime>
+#include <QFontMetrics>
+#include <QPainter>
+
+namespace {
+// Geometry mirrors MessageItemWidget so estimates stay close to measured heights.
+constexpr int kRowMarginX = 14;
+constexpr int kRowMarginY = 3;
+constexpr int kAvatarSize = 34;
+constexpr int kAvatarGap = 8;
+constexpr int kBubbleMaxWidth = 620;
+constexpr int kBubblePaddingX = 12;
+constexpr int kBubblePaddingY = 9;
+constexpr int kBubbleSpacing = 7;
+constexpr int kLineHeightSmall = 16;
+constexpr int kReplyAnchorHeight = 28;
+constexpr int kActionRowHeight = 30;
+
+const MessageListModel* modelFor(const QModelIndex& index)
+{
+    return qobject_cast<const MessageListModel*>(index.model());
+}
+
+int bubbleWidthFor(bool isMe, int viewWidth)
+{
+    const int available = viewWidth - 2 - 2 * kRowMarginX - (isMe ? 0 : kAvatarSize + kAvatarGap);
+    return qBound(120, available, kBubbleMaxWidth);
+}
+
+QFont textFontFrom(const QFont& base)
+{
+    QFont font = base;
+    font.setPixelSize(13);
+    return font;
+}
+
+int attachmentHeight(const Message& message)
+{
+    if (message.file.isNull() || message.file.url.isEmpty()) {
+        return 0;
+    }
+    const QString& type = message.file.type;
+    if (type.startsWith(QStringLiteral("image/"), Qt::CaseInsensitive)) {
+        return 236;
+    }
+    if (type.startsWith(QStringLiteral("video/"), Qt::CaseInsensitive)) {
+        return 160 + kBubbleSpacing + kActionRowHeight;
+    }
+    return kActionRowHeight;
+}
+}
+
+MessageDelegate::MessageDelegate(QObject* parent)
+    : QStyledItemDelegate(parent)
+{
+}
+
+void MessageDelegate::setTheme(bool darkMode)
+{
+    m_darkMode = darkMode;
+}
+
+void MessageDelegate::setHighlightedMessage(const QString& messageId)
+{
+    m_highlightedMessageId = messageId;
+}
+
+void MessageDelegate::setWidgetPool(MessageWidgetPool* pool)
+{
+    m_widgetPool = pool;
+}
+
+bool MessageDelegate::setMeasuredHeight(const QString& messageId, int viewWidth, int height)
+{
+    MeasuredHeight& measured = m_heights[messageId];
+    if (measured.viewWidth == viewWidth && measured.height == height) {
+        return false;
+    }
+    measured.viewWidth = viewWidth;
+    measured.height = height;
+    return true;
+}
+
+void MessageDelegate::invalidateMessage(const QString& messageId)
+{
+    m_heights.remove(messageId);
+}
+
+void MessageDelegate::clearHeights()
+{
+    m_heights.clear();
+}
+
+int MessageDelegate::viewWidthFor(const QStyleOptionViewItem& option) const
+{
+    if (const auto* view = qobject_cast<const QAbstractItemView*>(option.widget)) {
+        return view->viewport()->width();
+    }
+    return option.rect.width() > 0 ? option.rect.width() : 420;
+}
+
+void MessageDelegate::updateTextMetrics(const QFont& baseFont) const
+{
+    if (m_averageCharWidth > 0 && baseFont == m_metricsFont) {
+        return;
+    }
+    m_metricsFont = baseFont;
+    const QFontMetrics fm(textFontFrom(baseFont));
+    m_averageCharWidth = qMax(1, fm.averageCharWidth());
+    m_textLineHeight = fm.lineSpacing();
+}
+
+// Constant time per row: no text layout, only the text length against the
+// average glyph width. Materialized rows replace this with their real height.
+int MessageDelegate::estimateHeight(const Message& message, bool isMe, const QFont& baseFont, int viewWidth) const
+{
+    const int textWidth = bubbleWidthFor(isMe, viewWidth) - 2 * kBubblePaddingX;
+    int parts = 0;
+    int height = 2 * kRowMarginY + 2 * kBubblePaddingY;
+    if (!isMe) {
+        height += kLineHeightSmall;
+        ++parts;
+    }
+    if (!message.forwardedInfo.isNull()) {
+        height += kLineHeightSmall;
+        ++parts;
+    }
+    if (!message.replyToId.isEmpty()) {
+        height += kReplyAnchorHeight;
+        ++parts;
+    }
+    const int attachment = attachmentHeight(message);
+    if (attachment > 0) {
+        height += attachment;
+        ++parts;
+    }
+    const int length = message.text.size();
+    if (length > 0 && (message.file.isNull() || attachment == 0)) {
+        updateTextMetrics(baseFont);
+        const int charsPerLine = qMax(1, textWidth / m_averageCharWidth);
+        height += (1 + (length - 1) / charsPerLine) * m_textLineHeight;
+        ++parts;
+    }
+    height += kLineHeightSmall;
+    return height + kBubbleSpacing * parts;
+}
+
+QSize MessageDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    const int viewWidth = viewWidthFor(option);
+    const MessageListModel* model = modelFor(index);
+    const Message* message = model ? model->messageAt(index.row()) : nullptr;
+    if (!message) {
+        return QSize(viewWidth, kLineHeightSmall);
+    }
+
+    // Sizing reads the stored message only; the display text and sender of
+    // a row are resolved when it is painted or materialized.
+    const auto measured = m_heights.constFind(message->messageId);
+    const int height = measured != m_heights.constEnd()
+                           ? measured->height
+                           : estimateHeight(*message, model->isOwnMessage(*message), option.font, viewWidth);
+    return QSize(qMax(0, viewWidth - 2), height);
+}
+
+void MessageDelegate::updateEditorGeometry(QWidget* editor, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    Q_UNUSED(index);
+    editor->setGeometry(option.rect);
+}
+
+// The view routes index widgets through here when a row is removed, the
+// model resets or closePersistentEditor() is called.
+void MessageDelegate::destroyEditor(QWidget* editor, const QModelIndex& index) const
+{
+    if (auto* widget = qobject_cast<MessageItemWidget*>(editor)) {
+        if (m_widgetPool) {
+            m_widgetPool->recycle(widget);
+            return;
+        }
+    }
+    QStyledItemDelegate::destroyEditor(editor, index);
+}
+
+void MessageDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    // Rows scrolled into view get a MessageItemWidget shortly after; until
+    // then a lightweight bubble is painted so fast scrolling never shows gaps.
+    if (const auto* view = qobject_cast<const QAbstractItemView*>(option.widget)) {
+        if (view->indexWidget(index)) {
+            return;
+        }
+    }
+    const MessageListModel* model = modelFor(index);
+    const Message* message = model ? model->messageAt(index.row()) : nullptr;
+    const MessageRow* row = model ? model->rowAt(index.row()) : nullptr;
+    if (!message || !row) {
+        return;
+    }
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->setClipRect(option.rect);
+
+    const int viewWidth = viewWidthFor(option);
+    const int bubbleWidth = bubbleWidthFor(row->isMe, viewWidth);
+    const QRect rowRect = option.rect.adjusted(kRowMarginX, kRowMarginY, -kRowMarginX, -kRowMarginY);
+    QRect bubbleRect(0, rowRect.top(), bubbleWidth, rowRect.height());
+    if (row->isMe) {
+        bubbleRect.moveRight(rowRect.right());
+    } else {
+        bubbleRect.moveLeft(rowRect.left() + kAvatarSize + kAvatarGap);
+    }
+
+    const bool highlighted = (message->messageId == m_highlightedMessageId);
+    QColor bg;
+    QColor fg;
+    QColor border;
+    if (m_darkMode) {
+        bg = row->isMe ? QColor("#1d3f5f") : QColor("#272a31");
+        fg = QColor("#f3f4f6");
+        border = highlighted ? QColor("#facc15") : QColor("#3a3f48");
+    } else {
+        bg = row->isMe ? QColor("#e7f0ff") : QColor("#ffffff");
+        fg = QColor("#0f172a");
+        border = highlighted ? QColor("#f59e0b") : QColor("#dbe0ea");
+    }
+    const QColor muted = m_darkMode ? QColor("#9aa4b2") : QColor("#64748b");
+
+    painter->setPen(QPen(border, 1));
+    painter->setBrush(bg);
+    painter->drawRoundedRect(bubbleRect, 14, 14);
+
+    QRect content = bubbleRect.adjusted(kBubblePaddingX, kBubblePaddingY, -kBubblePaddingX, -kBubblePaddingY);
+    if (!row->isMe && !row->senderName.isEmpty()) {
+        QFont senderFont = option.font;
+        senderFont.setPixelSize(12);
+        senderFont.setBold(true);
+        painter->setFont(senderFont);
+        painter->setPen(m_darkMode ? QColor("#93c5fd") : QColor("#2563eb"));
+        painter->drawText(content.adjusted(0, 0, 0, -(content.height() - kLineHeightSmall)),
+                          Qt::AlignLeft | Qt::AlignVCenter,
+                          row->senderName);
+        content.setTop(content.top() + kLineHeightSmall + kBubbleSpacing);
+    }
+
+    QFont metaFont = option.font;
+    metaFont.setPixelSize(11);
+    QDateTime dt;
+    dt.setSecsSinceEpoch(message->timestamp);
+    painter->setFont(metaFont);
+    painter->setPen(muted);
+    painter->drawText(content, Qt::AlignRight | Qt::AlignBottom, dt.toString("hh:mm AP"));
+
+    painter->setFont(textFontFrom(option.font));
+    painter->setPen(fg);
+    painter->drawText(content.adjusted(0, 0, 0, -kLineHeightSmall), Qt::TextWordWrap, row->displayText);
+
+    painter->restore();
+}
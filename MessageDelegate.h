@@ -0,0 +1,55 @@
+#ifndef MESSAGEDELEGATE_H
+#define MESSAGEDELEGATE_H
+
+#include <QFont>
+#include <QHash>
+#include <QPointer>
+#include <QStyledItemDelegate>
+
+class MessageWidgetPool;
+struct Message;
+
+class MessageDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+public:
+    explicit MessageDelegate(QObject* parent = nullptr);
+
+    void setTheme(bool darkMode);
+    void setHighlightedMessage(const QString& messageId);
+    // Index widgets the view releases go back to pool instead of being deleted.
+    void setWidgetPool(MessageWidgetPool* pool);
+
+    // Rows are sized from a constant-time estimate until a materialized
+    // MessageItemWidget reports its real height here. A measured height is
+    // kept across width changes until the row is measured again.
+    bool setMeasuredHeight(const QString& messageId, int viewWidth, int height);
+    void invalidateMessage(const QString& messageId);
+    // Drops every cached height; called when the view leaves a chat.
+    void clearHeights();
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    void updateEditorGeometry(QWidget* editor, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    void destroyEditor(QWidget* editor, const QModelIndex& index) const override;
+
+private:
+    struct MeasuredHeight {
+        int viewWidth = -1;
+        int height = 0;
+    };
+
+    int viewWidthFor(const QStyleOptionViewItem& option) const;
+    int estimateHeight(const Message& message, bool isMe, const QFont& baseFont, int viewWidth) const;
+    void updateTextMetrics(const QFont& baseFont) const;
+
+    bool m_darkMode = false;
+    QString m_highlightedMessageId;
+    QPointer<MessageWidgetPool> m_widgetPool;
+    QHash<QString, MeasuredHeight> m_heights;
+    mutable QFont m_metricsFont;
+    mutable int m_averageCharWidth = 0;
+    mutable int m_textLineHeight = 0;
+};
+
+#endif // MESSAGEDELEGATE_H
@@ -1,5 +1,8 @@
 #include "MessageItemWidget.h"
 
+#include "ImagePipeline.h"
+#include "Trace.h"
+
 #include <QApplication>
 #include <QDateTime>
 #include <QFileInfo>
@@ -7,17 +10,14 @@
 #include <QHBoxLayout>
 #include <QIcon>
 #include <QLabel>
+#include <QList>
 #include <QMediaContent>
 #include <QMediaPlayer>
-#include <QNetworkAccessManager>
-#include <QNetworkReply>
-#include <QNetworkRequest>
 #include <QPixmap>
-#include <QPixmapCache>
-#include <QPointer>
 #include <QPushButton>
 #include <QRegularExpression>
 #include <QShowEvent>
+#include <QSpacerItem>
 #include <QTimer>
 #include <QToolButton>
 #include <QUrl>
@@ -26,6 +26,8 @@
 #include <functional>
 
 namespace {
+const QSize kImagePreviewSize(320, 230);
+
 QString resolveAttachmentType(const FileAttachment& file, const QString& fallbackUrl)
 {
     QString type = file.type.trimmed().toLower();
@@ -45,59 +47,26 @@ QString resolveAttachmentType(const FileAttachment& file, const QString& fallbac
     }
     return QStringLiteral("application/octet-stream");
 }
-
-QNetworkAccessManager* sharedNetworkManager()
-{
-    static QPointer<QNetworkAccessManager> manager;
-    if (!manager) {
-        manager = new QNetworkAccessManager(qApp);
-    }
-    return manager;
-}
 }
 
-MessageItemWidget::MessageItemWidget(const Message& message,
-                                     const QString& senderName,
-                                     const QString& senderAvatarUrl,
-                                     const QPixmap& senderAvatar,
-                                     const QString& resolvedFileUrl,
-                                     const QString& replySender,
-                                     const QString& replyPreviewText,
-                                     const QString& currentUserId,
-                                     const QString& chatType,
-                                     bool isChannelOwner,
-                                     bool darkMode,
-                                     QWidget* parent)
-    : QWidget(parent),
-      m_message(message),
-      m_senderName(senderName),
-      m_senderAvatarUrl(senderAvatarUrl),
-      m_fileUrl(resolvedFileUrl),
-      m_replySender(replySender),
-      m_replyPreviewText(replyPreviewText),
-      m_currentUserId(currentUserId),
-      m_chatType(chatType),
-      m_isChannelOwner(isChannelOwner),
-      m_darkMode(darkMode)
+MessageItemWidget::MessageItemWidget(QWidget* parent)
+    : QWidget(parent)
 {
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Minimum);
     setMouseTracking(true);
 
-    auto* root = new QHBoxLayout(this);
-    root->setContentsMargins(14, 3, 14, 3);
-    root->setSpacing(0);
+    // Spacing only falls between visible items, so hiding the avatar also
+    // drops its gap. The stretches swap sides for outgoing bubbles.
+    m_rootLayout = new QHBoxLayout(this);
+    m_rootLayout->setContentsMargins(14, 3, 14, 3);
+    m_rootLayout->setSpacing(8);
+    m_leadingStretch = new QSpacerItem(0, 0, QSizePolicy::Fixed, QSizePolicy::Minimum);
+    m_rootLayout->addItem(m_leadingStretch);
 
-    const bool isMe = (m_message.senderId == m_currentUserId);
-    if (isMe) {
-        root->addStretch();
-    } else {
-        m_avatarLabel = new QLabel(this);
-        m_avatarLabel->setFixedSize(34, 34);
-        m_avatarLabel->setAlignment(Qt::AlignCenter);
-        setSenderAvatar(senderAvatar);
-        root->addWidget(m_avatarLabel, 0, Qt::AlignLeft | Qt::AlignBottom);
-        root->addSpacing(8);
-    }
+    m_avatarLabel = new QLabel(this);
+    m_avatarLabel->setFixedSize(34, 34);
+    m_avatarLabel->setAlignment(Qt::AlignCenter);
+    m_rootLayout->addWidget(m_avatarLabel, 0, Qt::AlignLeft | Qt::AlignBottom);
 
     m_bubble = new QFrame(this);
     m_bubble->setObjectName(QStringLiteral("messageBubbleFrame"));
@@ -105,60 +74,168 @@ MessageItemWidget::MessageItemWidget(const Message& message,
     m_bubble->setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Minimum);
     m_bubble->setMaximumWidth(620);
 
-    auto* bubbleLayout = new QVBoxLayout(m_bubble);
-    bubbleLayout->setContentsMargins(12, 9, 12, 9);
-    bubbleLayout->setSpacing(7);
+    m_bubbleLayout = new QVBoxLayout(m_bubble);
+    m_bubbleLayout->setContentsMargins(12, 9, 12, 9);
+    m_bubbleLayout->setSpacing(7);
 
-    if (!isMe && m_chatType != QStringLiteral("private") && !m_senderName.isEmpty()) {
-        m_senderLabel = new QLabel(m_senderName, m_bubble);
-        bubbleLayout->addWidget(m_senderLabel);
-    }
+    m_senderLabel = new QLabel(m_bubble);
+    m_bubbleLayout->addWidget(m_senderLabel);
 
-    if (!m_message.forwardedInfo.isNull()) {
-        m_forwardedLabel = new QLabel(QStringLiteral("Forwarded message"), m_bubble);
-        bubbleLayout->addWidget(m_forwardedLabel);
-    }
+    m_forwardedLabel = new QLabel(QStringLiteral("Forwarded message"), m_bubble);
+    m_bubbleLayout->addWidget(m_forwardedLabel);
 
-    if (!m_message.replyToId.isEmpty()) {
-        QString preview = m_replyPreviewText;
-        if (preview.isEmpty()) {
-            preview = QStringLiteral("[Original message]");
-        }
-        if (preview.size() > 70) {
-            preview = preview.left(67) + QStringLiteral("...");
-        }
-        const QString sender = m_replySender.isEmpty() ? QStringLiteral("Unknown") : m_replySender;
-        m_replyAnchorButton = new QPushButton(QStringLiteral("%1: %2").arg(sender, preview), m_bubble);
-        m_replyAnchorButton->setFlat(true);
-        m_replyAnchorButton->setCursor(Qt::PointingHandCursor);
-        connect(m_replyAnchorButton, &QPushButton::clicked, this, [this]() {
-            emit replyAnchorClicked(m_message.replyToId);
-        });
-        bubbleLayout->addWidget(m_replyAnchorButton);
-    }
+    m_replyAnchorButton = new QPushButton(m_bubble);
+    m_replyAnchorButton->setFlat(true);
+    m_replyAnchorButton->setCursor(Qt::PointingHandCursor);
+    connect(m_replyAnchorButton, &QPushButton::clicked, this, [this]() {
+        emit replyAnchorClicked(m_message.replyToId);
+    });
+    m_bubbleLayout->addWidget(m_replyAnchorButton);
+
+    m_imageButton = new QToolButton(m_bubble);
+    m_imageButton->setToolButtonStyle(Qt::ToolButtonIconOnly);
+    m_imageButton->setIconSize(kImagePreviewSize);
+    m_imageButton->setMinimumSize(220, 150);
+    m_imageButton->setMaximumSize(360, 260);
+    m_imageButton->setCursor(Qt::PointingHandCursor);
+    connect(m_imageButton, &QToolButton::clicked, this, [this]() {
+        emit openMediaRequested(QStringLiteral("image"), m_fileUrl);
+    });
+    m_bubbleLayout->addWidget(m_imageButton, 0, Qt::AlignLeft);
+
+    auto* audioRow = new QHBoxLayout();
+    m_audioButton = new QPushButton(QStringLiteral("Play"), m_bubble);
+    m_audioButton->setCursor(Qt::PointingHandCursor);
+    m_audioNameLabel = new QLabel(m_bubble);
+    m_audioNameLabel->setWordWrap(true);
+    audioRow->addWidget(m_audioButton);
+    audioRow->addWidget(m_audioNameLabel, 1);
+    m_bubbleLayout->addLayout(audioRow);
+    connect(m_audioButton, &QPushButton::clicked, this, [this]() {
+        emit playAudioRequested(m_fileUrl, fileDisplayName(), this);
+    });
 
-    if (!m_message.file.isNull() && !m_fileUrl.isEmpty()) {
-        renderAttachmentContent(bubbleLayout);
-    }
+    m_fileButton = new QPushButton(m_bubble);
+    m_fileButton->setCursor(Qt::PointingHandCursor);
+    connect(m_fileButton, &QPushButton::clicked, this, [this]() {
+        emit openFileRequested(m_fileUrl);
+    });
+    m_bubbleLayout->addWidget(m_fileButton, 0, Qt::AlignLeft);
+
+    m_textLabel = new QLabel(m_bubble);
+    m_textLabel->setWordWrap(true);
+    m_textLabel->setTextFormat(Qt::PlainText);
+    m_textLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    m_textLabel->setSizePolicy(QSizePolicy::Ignored, QSizePolicy::Minimum);
+    m_textLabel->setMinimumWidth(0);
+    m_bubbleLayout->addWidget(m_textLabel);
 
-    renderTextContent(bubbleLayout);
-    renderActionRow(bubbleLayout);
+    renderActionRow(m_bubbleLayout);
 
     m_metaLabel = new QLabel(m_bubble);
     m_metaLabel->setAlignment(Qt::AlignRight);
-    m_metaLabel->setStyleSheet("font-size: 11px; color: #6b7280;");
-    bubbleLayout->addWidget(m_metaLabel);
-    rebuildMetaText();
+    m_bubbleLayout->addWidget(m_metaLabel);
 
-    root->addWidget(m_bubble);
-    if (!isMe) {
-        root->addStretch();
+    m_rootLayout->addWidget(m_bubble);
+    m_trailingStretch = new QSpacerItem(0, 0, QSizePolicy::Expanding, QSizePolicy::Minimum);
+    m_rootLayout->addItem(m_trailingStretch);
+
+    const QList<QWidget*> optionalParts = {m_senderLabel, m_forwardedLabel, m_replyAnchorButton, m_imageButton,
+                                           m_audioButton, m_audioNameLabel, m_fileButton, m_textLabel};
+    for (QWidget* part : optionalParts) {
+        part->setVisible(false);
     }
+}
+
+MessageItemWidget::MessageItemWidget(const Message& message,
+                                     const QString& senderName,
+                                     const QString& senderAvatarUrl,
+                                     const QPixmap& senderAvatar,
+                                     const QString& resolvedFileUrl,
+                                     const QString& replySender,
+                                     const QString& replyPreviewText,
+                                     const QString& currentUserId,
+                                     const QString& chatType,
+                                     bool isChannelOwner,
+                                     bool darkMode,
+                                     QWidget* parent)
+    : MessageItemWidget(parent)
+{
+    bind(message, senderName, senderAvatarUrl, senderAvatar, resolvedFileUrl, replySender, replyPreviewText,
+         currentUserId, chatType, isChannelOwner, darkMode);
+}
+
+void MessageItemWidget::bind(const Message& message,
+                             const QString& senderName,
+                             const QString& senderAvatarUrl,
+                             const QPixmap& senderAvatar,
+                             const QString& resolvedFileUrl,
+                             const QString& replySender,
+                             const QString& replyPreviewText,
+                             const QString& currentUserId,
+                             const QString& chatType,
+                             bool isChannelOwner,
+                             bool darkMode)
+{
+    NOVEO_TRACE_SCOPE("MessageItemWidget::bind");
+    m_message = message;
+    m_senderName = senderName;
+    m_senderAvatarUrl = senderAvatarUrl;
+    m_fileUrl = resolvedFileUrl;
+    m_replySender = replySender;
+    m_replyPreviewText = replyPreviewText;
+    m_currentUserId = currentUserId;
+    m_chatType = chatType;
+    m_isChannelOwner = isChannelOwner;
+    m_darkMode = darkMode;
+
+    const bool isMe = (m_message.senderId == m_currentUserId);
+    m_leadingStretch->changeSize(0, 0, isMe ? QSizePolicy::Expanding : QSizePolicy::Fixed, QSizePolicy::Minimum);
+    m_trailingStretch->changeSize(0, 0, isMe ? QSizePolicy::Fixed : QSizePolicy::Expanding, QSizePolicy::Minimum);
+    m_rootLayout->invalidate();
+    m_avatarLabel->setVisible(!isMe);
+    setSenderAvatar(isMe ? QPixmap() : senderAvatar);
+
+    const bool showSender = !isMe && m_chatType != QStringLiteral("private") && !m_senderName.isEmpty();
+    m_senderLabel->setText(showSender ? m_senderName : QString());
+    m_senderLabel->setVisible(showSender);
+    m_forwardedLabel->setVisible(!m_message.forwardedInfo.isNull());
+
+    bindReplyAnchor();
+    bindAttachmentContent();
+    bindTextContent();
+    rebuildMetaText();
 
     applyBubbleStyle();
     QTimer::singleShot(0, this, [this]() { maybeLoadImagePreview(); });
 }
 
+void MessageItemWidget::reset()
+{
+    ImagePipeline::instance()->cancel(this);
+    m_hasImagePreview = false;
+    m_imagePreviewRequested = false;
+    m_imagePreviewLoaded = false;
+    m_imageButton->setIcon(QIcon());
+    if (m_videoPlayer) {
+        m_videoPlayer->stop();
+        m_videoPlayer->setMedia(QMediaContent());
+    }
+    m_videoPlayerReady = false;
+    if (m_videoPlayButton) {
+        m_videoPlayButton->setText(QStringLiteral("Play"));
+    }
+    m_audioButton->setText(QStringLiteral("Play"));
+    m_avatarLabel->clear();
+    if (m_isHighlighted) {
+        m_isHighlighted = false;
+        applyBubbleStyle();
+    }
+    m_message = Message();
+    m_senderAvatarUrl.clear();
+    m_fileUrl.clear();
+}
+
 QString MessageItemWidget::messageId() const
 {
     return m_message.messageId;
@@ -170,6 +247,16 @@ void MessageItemWidget::setMessageStatus(MessageStatus status)
     rebuildMetaText();
 }
 
+void MessageItemWidget::confirmPending(const Message& confirmed)
+{
+    m_message.messageId = confirmed.messageId;
+    m_message.timestamp = confirmed.timestamp;
+    m_message.status = confirmed.status;
+    m_message.seenBy = confirmed.seenBy;
+    m_message.pending = false;
+    rebuildMetaText();
+}
+
 void MessageItemWidget::setEditedAt(qint64 editedAt)
 {
     m_message.editedAt = editedAt;
@@ -179,9 +266,7 @@ void MessageItemWidget::setEditedAt(qint64 editedAt)
 void MessageItemWidget::setMessageText(const QString& text)
 {
     m_message.text = text;
-    if (m_textLabel) {
-        m_textLabel->setText(text);
-    }
+    bindTextContent();
 }
 
 void MessageItemWidget::setHighlighted(bool highlighted)
@@ -293,6 +378,7 @@ void MessageItemWidget::rebuildMetaText()
 
 void MessageItemWidget::applyBubbleStyle()
 {
+    NOVEO_TRACE_SCOPE("MessageItemWidget::applyBubbleStyle");
     const bool isMe = (m_message.senderId == m_currentUserId);
     QString bg;
     QString fg;
@@ -307,16 +393,23 @@ void MessageItemWidget::applyBubbleStyle()
         border = m_isHighlighted ? QStringLiteral("#f59e0b") : QStringLiteral("#dbe0ea");
     }
 
-    m_bubble->setStyleSheet(QString(
-        "QFrame#messageBubbleFrame {"
-        " border: 1px solid %1;"
-        " border-radius: 14px;"
-        " background: %2;"
-        " color: %3;"
-        "}"
-    ).arg(border, bg, fg));
+    const int bubbleStyle = (isMe ? 1 : 0) | (m_darkMode ? 2 : 0) | (m_isHighlighted ? 4 : 0);
+    if (bubbleStyle != m_appliedBubbleStyle) {
+        m_appliedBubbleStyle = bubbleStyle;
+        m_bubble->setStyleSheet(QString(
+            "QFrame#messageBubbleFrame {"
+            " border: 1px solid %1;"
+            " border-radius: 14px;"
+            " background: %2;"
+            " color: %3;"
+            "}"
+        ).arg(border, bg, fg));
+    }
 
-    applyControlStyles();
+    if (m_appliedControlStyle != static_cast<int>(m_darkMode)) {
+        m_appliedControlStyle = static_cast<int>(m_darkMode);
+        applyControlStyles();
+    }
 }
 
 void MessageItemWidget::applyControlStyles()
@@ -393,104 +486,117 @@ void MessageItemWidget::applyControlStyles()
     }
 }
 
-void MessageItemWidget::renderTextContent(QVBoxLayout* bubbleLayout)
+void MessageItemWidget::bindReplyAnchor()
 {
-    if (!shouldRenderTextContent()) {
+    if (m_message.replyToId.isEmpty()) {
+        m_replyAnchorButton->setVisible(false);
         return;
     }
-    m_textLabel = new QLabel(m_message.text, m_bubble);
-    m_textLabel->setWordWrap(true);
-    m_textLabel->setTextFormat(Qt::PlainText);
-    m_textLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
-    m_textLabel->setSizePolicy(QSizePolicy::Ignored, QSizePolicy::Minimum);
-    m_textLabel->setMinimumWidth(0);
-    bubbleLayout->addWidget(m_textLabel);
+    QString preview = m_replyPreviewText;
+    if (preview.isEmpty()) {
+        preview = QStringLiteral("[Original message]");
+    }
+    if (preview.size() > 70) {
+        preview = preview.left(67) + QStringLiteral("...");
+    }
+    const QString sender = m_replySender.isEmpty() ? QStringLiteral("Unknown") : m_replySender;
+    m_replyAnchorButton->setText(QStringLiteral("%1: %2").arg(sender, preview));
+    m_replyAnchorButton->setVisible(true);
 }
 
-void MessageItemWidget::renderAttachmentContent(QVBoxLayout* bubbleLayout)
+void MessageItemWidget::bindTextContent()
 {
-    const QString type = inferFileType();
-    const QString name = fileDisplayName();
+    const bool show = shouldRenderTextContent();
+    m_textLabel->setText(show ? m_message.text : QString());
+    m_textLabel->setVisible(show);
+}
 
-    if (type.startsWith(QStringLiteral("image/"))) {
-        m_imageButton = new QToolButton(m_bubble);
-        m_imageButton->setText(QStringLiteral("Loading preview..."));
-        m_imageButton->setToolButtonStyle(Qt::ToolButtonIconOnly);
-        m_imageButton->setIconSize(QSize(320, 230));
-        m_imageButton->setMinimumSize(220, 150);
-        m_imageButton->setMaximumSize(360, 260);
-        m_imageButton->setCursor(Qt::PointingHandCursor);
-        connect(m_imageButton, &QToolButton::clicked, this, [this]() {
-            emit openMediaRequested(QStringLiteral("image"), m_fileUrl);
-        });
-        bubbleLayout->addWidget(m_imageButton, 0, Qt::AlignLeft);
-        const QString cacheKey = QStringLiteral("noveo_msg_image_preview::%1").arg(m_fileUrl);
+void MessageItemWidget::bindAttachmentContent()
+{
+    const QString type = (!m_message.file.isNull() && !m_fileUrl.isEmpty()) ? inferFileType() : QString();
+    const bool isImage = type.startsWith(QStringLiteral("image/"));
+    const bool isVideo = type.startsWith(QStringLiteral("video/"));
+    const bool isAudio = type.startsWith(QStringLiteral("audio/"));
+    const bool isFile = !type.isEmpty() && !isImage && !isVideo && !isAudio;
+
+    m_hasImagePreview = isImage;
+    m_imageButton->setVisible(isImage);
+    if (isImage) {
         QPixmap cached;
-        if (QPixmapCache::find(cacheKey, &cached)) {
+        if (ImagePipeline::instance()->cachedPixmap(imagePreviewUrl(), kImagePreviewSize, ImagePipeline::Shape::Fit, &cached)) {
             m_imageButton->setIcon(QIcon(cached));
             m_imageButton->setText(QString());
             m_imagePreviewLoaded = true;
+        } else {
+            m_imageButton->setText(QStringLiteral("Loading preview..."));
         }
-        return;
     }
 
-    if (type.startsWith(QStringLiteral("video/"))) {
-        m_videoWidget = new QVideoWidget(m_bubble);
-        m_videoWidget->setMinimumSize(280, 160);
-        m_videoWidget->setMaximumSize(320, 220);
-        bubbleLayout->addWidget(m_videoWidget, 0, Qt::AlignLeft);
-
-        auto* controls = new QHBoxLayout();
-        m_videoPlayButton = new QPushButton(QStringLiteral("Play"), m_bubble);
-        m_videoOpenButton = new QPushButton(QStringLiteral("Open Viewer"), m_bubble);
-        m_videoPlayButton->setCursor(Qt::PointingHandCursor);
-        m_videoOpenButton->setCursor(Qt::PointingHandCursor);
-        controls->addWidget(m_videoPlayButton);
-        controls->addWidget(m_videoOpenButton);
-        controls->addStretch();
-        bubbleLayout->addLayout(controls);
-
-        connect(m_videoPlayButton, &QPushButton::clicked, this, [this]() {
-            ensureVideoPlayer();
-            if (!m_videoPlayer) {
-                return;
-            }
-            if (m_videoPlayer->state() == QMediaPlayer::PlayingState) {
-                m_videoPlayer->pause();
-                m_videoPlayButton->setText(QStringLiteral("Play"));
-            } else {
-                m_videoPlayer->play();
-                m_videoPlayButton->setText(QStringLiteral("Pause"));
-            }
-        });
-        connect(m_videoOpenButton, &QPushButton::clicked, this, [this]() {
-            emit openMediaRequested(QStringLiteral("video"), m_fileUrl);
-        });
-        return;
+    if (isVideo) {
+        ensureVideoPanel();
+    }
+    if (m_videoPanel) {
+        m_videoPanel->setVisible(isVideo);
     }
 
-    if (type.startsWith(QStringLiteral("audio/"))) {
-        auto* row = new QHBoxLayout();
-        m_audioButton = new QPushButton(QStringLiteral("Play"), m_bubble);
-        m_audioButton->setCursor(Qt::PointingHandCursor);
-        auto* label = new QLabel(name, m_bubble);
-        label->setWordWrap(true);
-        row->addWidget(m_audioButton);
-        row->addWidget(label, 1);
-        bubbleLayout->addLayout(row);
+    m_audioButton->setVisible(isAudio);
+    m_audioNameLabel->setVisible(isAudio);
+    if (isAudio) {
+        m_audioNameLabel->setText(fileDisplayName());
+    }
 
-        connect(m_audioButton, &QPushButton::clicked, this, [this, name]() {
-            emit playAudioRequested(m_fileUrl, name, this);
-        });
-        return;
+    m_fileButton->setVisible(isFile);
+    if (isFile) {
+        m_fileButton->setText(QStringLiteral("Open %1").arg(fileDisplayName()));
     }
+}
 
-    m_fileButton = new QPushButton(QStringLiteral("Open %1").arg(name), m_bubble);
-    m_fileButton->setCursor(Qt::PointingHandCursor);
-    connect(m_fileButton, &QPushButton::clicked, this, [this]() {
-        emit openFileRequested(m_fileUrl);
+void MessageItemWidget::ensureVideoPanel()
+{
+    if (m_videoPanel) {
+        return;
+    }
+    m_videoPanel = new QWidget(m_bubble);
+    auto* panelLayout = new QVBoxLayout(m_videoPanel);
+    panelLayout->setContentsMargins(0, 0, 0, 0);
+    panelLayout->setSpacing(m_bubbleLayout->spacing());
+
+    m_videoWidget = new QVideoWidget(m_videoPanel);
+    m_videoWidget->setMinimumSize(280, 160);
+    m_videoWidget->setMaximumSize(320, 220);
+    panelLayout->addWidget(m_videoWidget, 0, Qt::AlignLeft);
+
+    auto* controls = new QHBoxLayout();
+    m_videoPlayButton = new QPushButton(QStringLiteral("Play"), m_videoPanel);
+    m_videoOpenButton = new QPushButton(QStringLiteral("Open Viewer"), m_videoPanel);
+    m_videoPlayButton->setCursor(Qt::PointingHandCursor);
+    m_videoOpenButton->setCursor(Qt::PointingHandCursor);
+    controls->addWidget(m_videoPlayButton);
+    controls->addWidget(m_videoOpenButton);
+    controls->addStretch();
+    panelLayout->addLayout(controls);
+
+    connect(m_videoPlayButton, &QPushButton::clicked, this, [this]() {
+        ensureVideoPlayer();
+        if (!m_videoPlayer) {
+            return;
+        }
+        if (m_videoPlayer->state() == QMediaPlayer::PlayingState) {
+            m_videoPlayer->pause();
+            m_videoPlayButton->setText(QStringLiteral("Play"));
+        } else {
+            m_videoPlayer->play();
+            m_videoPlayButton->setText(QStringLiteral("Pause"));
+        }
     });
-    bubbleLayout->addWidget(m_fileButton, 0, Qt::AlignLeft);
+    connect(m_videoOpenButton, &QPushButton::clicked, this, [this]() {
+        emit openMediaRequested(QStringLiteral("video"), m_fileUrl);
+    });
+
+    // Attachments sit between the reply anchor and the text.
+    m_bubbleLayout->insertWidget(m_bubbleLayout->indexOf(m_imageButton) + 1, m_videoPanel);
+    m_appliedControlStyle = -1;
+    applyBubbleStyle();
 }
 
 void MessageItemWidget::renderActionRow(QVBoxLayout* bubbleLayout)
@@ -538,67 +644,29 @@ bool MessageItemWidget::shouldRenderTextContent() const
     return true;
 }
 
+QUrl MessageItemWidget::imagePreviewUrl() const
+{
+    const QUrl url(m_fileUrl);
+    return url.scheme().isEmpty() ? QUrl::fromLocalFile(m_fileUrl) : url;
+}
+
 void MessageItemWidget::maybeLoadImagePreview()
 {
-    if (!m_imageButton || m_imagePreviewLoaded || m_imagePreviewRequested || m_fileUrl.isEmpty() || !isVisible()) {
+    if (!m_hasImagePreview || m_imagePreviewLoaded || m_imagePreviewRequested || m_fileUrl.isEmpty() || !isVisible()) {
         return;
     }
 
     const QString name = fileDisplayName();
-    const QString cacheKey = QStringLiteral("noveo_msg_image_preview::%1").arg(m_fileUrl);
-    QPixmap cached;
-    if (QPixmapCache::find(cacheKey, &cached)) {
-        m_imageButton->setIcon(QIcon(cached));
-        m_imageButton->setText(QString());
-        m_imagePreviewLoaded = true;
-        return;
-    }
-
     m_imagePreviewRequested = true;
-    const QUrl imageUrl(m_fileUrl);
-    if (imageUrl.isLocalFile() || imageUrl.scheme().isEmpty()) {
-        QPixmap px(imageUrl.isLocalFile() ? imageUrl.toLocalFile() : m_fileUrl);
+    ImagePipeline::instance()->load(imagePreviewUrl(), kImagePreviewSize, ImagePipeline::Shape::Fit, this, [this, name](const QPixmap& scaled) {
         m_imagePreviewRequested = false;
-        if (px.isNull()) {
+        m_imagePreviewLoaded = true;
+        if (scaled.isNull()) {
             m_imageButton->setText(name);
-            m_imagePreviewLoaded = true;
             return;
         }
-        const QPixmap scaled = px.scaled(QSize(320, 230), Qt::KeepAspectRatio, Qt::FastTransformation);
-        QPixmapCache::insert(cacheKey, scaled);
         m_imageButton->setIcon(QIcon(scaled));
         m_imageButton->setText(QString());
-        m_imagePreviewLoaded = true;
-        return;
-    }
-
-    QNetworkReply* reply = sharedNetworkManager()->get(QNetworkRequest(imageUrl));
-    connect(reply, &QNetworkReply::finished, reply, &QObject::deleteLater);
-    QPointer<MessageItemWidget> self(this);
-    connect(reply, &QNetworkReply::finished, this, [self, reply, cacheKey, name]() {
-        if (!self) {
-            return;
-        }
-        self->m_imagePreviewRequested = false;
-        if (!self->m_imageButton) {
-            return;
-        }
-        if (reply->error() != QNetworkReply::NoError) {
-            self->m_imageButton->setText(name);
-            self->m_imagePreviewLoaded = true;
-            return;
-        }
-        QPixmap px;
-        if (!px.loadFromData(reply->readAll())) {
-            self->m_imageButton->setText(name);
-            self->m_imagePreviewLoaded = true;
-            return;
-        }
-        const QPixmap scaled = px.scaled(QSize(320, 230), Qt::KeepAspectRatio, Qt::FastTransformation);
-        QPixmapCache::insert(cacheKey, scaled);
-        self->m_imageButton->setIcon(QIcon(scaled));
-        self->m_imageButton->setText(QString());
-        self->m_imagePreviewLoaded = true;
     });
 }
 
@@ -5,19 +5,26 @@
 
 #include "DataStructures.h"
 
+class QHBoxLayout;
 class QLabel;
 class QMediaPlayer;
 class QPixmap;
 class QShowEvent;
 class QPushButton;
+class QSpacerItem;
 class QToolButton;
+class QUrl;
 class QVBoxLayout;
 class QVideoWidget;
 
+// Builds every child a bubble can need once and shows the ones the bound
+// message uses, so MessageWidgetPool can rebind a widget to another message
+// without new layouts, labels or stylesheets.
 class MessageItemWidget : public QWidget
 {
     Q_OBJECT
 public:
+    explicit MessageItemWidget(QWidget* parent = nullptr);
     explicit MessageItemWidget(const Message& message,
                                const QString& senderName,
                                const QString& senderAvatarUrl,
@@ -31,8 +38,25 @@ public:
                                bool darkMode,
                                QWidget* parent = nullptr);
 
+    void bind(const Message& message,
+              const QString& senderName,
+              const QString& senderAvatarUrl,
+              const QPixmap& senderAvatar,
+              const QString& resolvedFileUrl,
+              const QString& replySender,
+              const QString& replyPreviewText,
+              const QString& currentUserId,
+              const QString& chatType,
+              bool isChannelOwner,
+              bool darkMode);
+    // Drops everything tied to the bound message: pending preview loads,
+    // video playback, highlight and pixmaps.
+    void reset();
+
     QString messageId() const;
     void setMessageStatus(MessageStatus status);
+    // Adopts the server's id, timestamp and status for a pending bubble.
+    void confirmPending(const Message& confirmed);
     void setEditedAt(qint64 editedAt);
     void setMessageText(const QString& text);
     void setHighlighted(bool highlighted);
@@ -64,10 +88,13 @@ private:
     void rebuildMetaText();
     void applyBubbleStyle();
     void applyControlStyles();
-    void renderTextContent(QVBoxLayout* bubbleLayout);
-    void renderAttachmentContent(QVBoxLayout* bubbleLayout);
+    void bindReplyAnchor();
+    void bindTextContent();
+    void bindAttachmentContent();
     void renderActionRow(QVBoxLayout* bubbleLayout);
+    void ensureVideoPanel();
     bool shouldRenderTextContent() const;
+    QUrl imagePreviewUrl() const;
     void maybeLoadImagePreview();
     void ensureVideoPlayer();
 
@@ -83,6 +110,10 @@ private:
     bool m_darkMode = false;
     bool m_isHighlighted = false;
 
+    QHBoxLayout* m_rootLayout = nullptr;
+    QSpacerItem* m_leadingStretch = nullptr;
+    QSpacerItem* m_trailingStretch = nullptr;
+    QVBoxLayout* m_bubbleLayout = nullptr;
     QLabel* m_textLabel = nullptr;
     QLabel* m_metaLabel = nullptr;
     QLabel* m_senderLabel = nullptr;
@@ -92,14 +123,22 @@ private:
     QToolButton* m_imageButton = nullptr;
     QPushButton* m_fileButton = nullptr;
     QPushButton* m_audioButton = nullptr;
+    QLabel* m_audioNameLabel = nullptr;
+    // Created the first time a video is bound; QVideoWidget is expensive.
+    QWidget* m_videoPanel = nullptr;
     QPushButton* m_videoPlayButton = nullptr;
     QPushButton* m_videoOpenButton = nullptr;
     QMediaPlayer* m_videoPlayer = nullptr;
     QVideoWidget* m_videoWidget = nullptr;
     QWidget* m_bubble = nullptr;
+    // Set by bindAttachmentContent(); only image attachments get a preview.
+    bool m_hasImagePreview = false;
     bool m_imagePreviewRequested = false;
     bool m_imagePreviewLoaded = false;
     bool m_videoPlayerReady = false;
+    // Style inputs last applied, so rebinding skips identical stylesheets.
+    int m_appliedBubbleStyle = -1;
+    int m_appliedControlStyle = -1;
 };
 
 #endif // MESSAGEITEMWIDGET_H
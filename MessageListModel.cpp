@@ -0,0 +1,259 @@
+#include "MessageListModel.h"
+
+#include "ChatStore.h"
+
+MessageListModel::MessageListModel(const ChatStore* store, QObject* parent)
+    : QAbstractListModel(parent)
+    , m_store(store)
+{
+}
+
+void MessageListModel::setRowDecorator(RowDecorator decorator)
+{
+    m_decorator = std::move(decorator);
+    m_rowCache.clear();
+}
+
+int MessageListModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_ids.size();
+}
+
+QVariant MessageListModel::data(const QModelIndex& index, int role) const
+{
+    const Message* message = index.isValid() ? messageAt(index.row()) : nullptr;
+    if (!message) {
+        return QVariant();
+    }
+
+    switch (role) {
+    case TimestampRole:
+        return message->timestamp;
+    case IsMeRole:
+        return isOwnMessage(*message);
+    case StatusRole:
+        return static_cast<int>(statusOf(*message));
+    case MessageIdRole:
+        return message->messageId;
+    case EditedAtRole:
+        return message->editedAt;
+    case SenderIdRole:
+        return message->senderId;
+    case ReplyToIdRole:
+        return message->replyToId;
+    case FileTypeRole:
+        return message->file.type;
+    default:
+        break;
+    }
+
+    const MessageRow* row = rowAt(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case TextRole:
+        return row->displayText;
+    case SenderNameRole:
+        return row->senderName;
+    case ReplyTextRole:
+        return row->replyText;
+    case ReplySenderRole:
+        return row->replySender;
+    case FileUrlRole:
+        return row->fileUrl;
+    case SenderAvatarUrlRole:
+        return row->senderAvatarUrl;
+    default:
+        break;
+    }
+    return QVariant();
+}
+
+void MessageListModel::clear()
+{
+    if (m_ids.isEmpty() && m_chatId.isEmpty()) {
+        return;
+    }
+    beginResetModel();
+    m_chatId.clear();
+    m_ids.clear();
+    m_rowById.clear();
+    m_detached.clear();
+    m_rowCache.clear();
+    endResetModel();
+}
+
+void MessageListModel::resetRows(const QString& chatId, const QStringList& messageIds)
+{
+    beginResetModel();
+    m_chatId = chatId;
+    m_ids = messageIds;
+    m_rowById.clear();
+    m_detached.clear();
+    m_rowCache.clear();
+    rebuildIndex(0);
+    endResetModel();
+}
+
+void MessageListModel::appendMessage(const Message& message)
+{
+    removeMessage(message.messageId);
+    if (!m_store->chat(m_chatId).findMessage(message.messageId)) {
+        m_detached.insert(message.messageId, message);
+    }
+    const int position = m_ids.size();
+    beginInsertRows(QModelIndex(), position, position);
+    m_ids.append(message.messageId);
+    m_rowById.insert(message.messageId, position);
+    endInsertRows();
+}
+
+void MessageListModel::prependMessages(const QStringList& messageIds)
+{
+    QStringList fresh;
+    for (const QString& messageId : messageIds) {
+        if (!m_rowById.contains(messageId)) {
+            fresh.append(messageId);
+        }
+    }
+    if (fresh.isEmpty()) {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), 0, fresh.size() - 1);
+    m_ids = fresh + m_ids;
+    rebuildIndex(0);
+    endInsertRows();
+}
+
+bool MessageListModel::removeMessage(const QString& messageId)
+{
+    const int row = rowForMessage(messageId);
+    if (row < 0) {
+        return false;
+    }
+    beginRemoveRows(QModelIndex(), row, row);
+    m_ids.removeAt(row);
+    m_rowById.remove(messageId);
+    forgetMessage(messageId);
+    rebuildIndex(row);
+    endRemoveRows();
+    return true;
+}
+
+void MessageListModel::refreshMessage(const QString& messageId)
+{
+    const int row = rowForMessage(messageId);
+    if (row < 0) {
+        return;
+    }
+    m_rowCache.remove(messageId);
+    const QModelIndex changed = index(row);
+    emit dataChanged(changed, changed);
+}
+
+void MessageListModel::refreshStatus(const QString& messageId)
+{
+    const int row = rowForMessage(messageId);
+    if (row < 0) {
+        return;
+    }
+    const QModelIndex changed = index(row);
+    emit dataChanged(changed, changed, {StatusRole});
+}
+
+bool MessageListModel::renameMessage(const QString& oldMessageId, const Message& confirmed)
+{
+    const QString& newMessageId = confirmed.messageId;
+    if (newMessageId != oldMessageId) {
+        removeMessage(newMessageId);
+    }
+    const int position = rowForMessage(oldMessageId);
+    if (position < 0) {
+        return false;
+    }
+    m_rowById.remove(oldMessageId);
+    forgetMessage(oldMessageId);
+    if (!m_store->chat(m_chatId).findMessage(newMessageId)) {
+        m_detached.insert(newMessageId, confirmed);
+    }
+    m_ids[position] = newMessageId;
+    m_rowById.insert(newMessageId, position);
+    const QModelIndex changed = index(position);
+    emit dataChanged(changed, changed);
+    return true;
+}
+
+int MessageListModel::rowForMessage(const QString& messageId) const
+{
+    return m_rowById.value(messageId, -1);
+}
+
+QModelIndex MessageListModel::indexForMessage(const QString& messageId) const
+{
+    const int row = rowForMessage(messageId);
+    return row >= 0 ? index(row) : QModelIndex();
+}
+
+const Message* MessageListModel::messageAt(int row) const
+{
+    if (row < 0 || row >= m_ids.size()) {
+        return nullptr;
+    }
+    const QString& messageId = m_ids.at(row);
+    if (const Message* stored = m_store->chat(m_chatId).findMessage(messageId)) {
+        return stored;
+    }
+    const auto detached = m_detached.constFind(messageId);
+    return detached != m_detached.constEnd() ? &detached.value() : nullptr;
+}
+
+const MessageRow* MessageListModel::rowAt(int row) const
+{
+    const Message* message = messageAt(row);
+    if (!message) {
+        return nullptr;
+    }
+    auto cached = m_rowCache.find(message->messageId);
+    if (cached == m_rowCache.end()) {
+        cached = m_rowCache.insert(message->messageId, m_decorator ? m_decorator(*message) : MessageRow());
+    }
+    return &cached.value();
+}
+
+bool MessageListModel::isOwnMessage(const Message& message) const
+{
+    return message.senderId == m_store->currentUserId();
+}
+
+MessageStatus MessageListModel::statusOf(const Message& message) const
+{
+    return m_store->messageStatus(message, m_store->chat(m_chatId));
+}
+
+QStringList MessageListModel::messagesFromSender(const QString& senderId) const
+{
+    QStringList ids;
+    for (int row = 0; row < m_ids.size(); ++row) {
+        const Message* message = messageAt(row);
+        if (message && message->senderId == senderId) {
+            ids.append(message->messageId);
+        }
+    }
+    return ids;
+}
+
+void MessageListModel::forgetMessage(const QString& messageId)
+{
+    m_detached.remove(messageId);
+    m_rowCache.remove(messageId);
+}
+
+void MessageListModel::rebuildIndex(int fromRow)
+{
+    for (int i = qMax(0, fromRow); i < m_ids.size(); ++i) {
+        m_rowById.insert(m_ids.at(i), i);
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef MESSAGELISTMODEL_H
+#define MESSAGELISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QStringList>
+#include <functional>
+#include <vector>
+
+#include "DataStructures.h"
+
+class ChatStore;
+
+// What a row shows beyond the stored message. Resolved on first use and
+// cached until the message or its sender changes.
+struct MessageRow {
+    QString displayText;
+    QString senderName;
+    QString senderAvatarUrl;
+    QString fileUrl;
+    QString replySender;
+    QString replyText;
+    bool isMe = false;
+};
+
+// A view over one chat in ChatStore. Rows hold message ids only; messages
+// are read from the store when asked for. Unconfirmed sends the store does
+// not hold keep a copy here until the server confirms them.
+class MessageListModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    enum Role {
+        TextRole = Qt::UserRole + 1,
+        SenderNameRole,
+        TimestampRole,
+        IsMeRole,
+        StatusRole,
+        MessageIdRole,
+        EditedAtRole,
+        SenderIdRole,
+        ReplyToIdRole,
+        ReplyTextRole,
+        ReplySenderRole,
+        FileUrlRole,
+        FileTypeRole,
+        SenderAvatarUrlRole
+    };
+
+    using RowDecorator = std::function<MessageRow(const Message&)>;
+
+    explicit MessageListModel(const ChatStore* store, QObject* parent = nullptr);
+
+    void setRowDecorator(RowDecorator decorator);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    QString chatId() const { return m_chatId; }
+    void clear();
+    void resetRows(const QString& chatId, const QStringList& messageIds);
+    void appendMessage(const Message& message);
+    void prependMessages(const QStringList& messageIds);
+    bool removeMessage(const QString& messageId);
+    // Drops the cached row so it is resolved again on next use.
+    void refreshMessage(const QString& messageId);
+    // Status is read from the store on every use, so only the view is told.
+    void refreshStatus(const QString& messageId);
+    // A pending message confirmed by the server keeps its position under the
+    // new id. Any other row already holding the new id is dropped.
+    bool renameMessage(const QString& oldMessageId, const Message& confirmed);
+
+    int rowForMessage(const QString& messageId) const;
+    QModelIndex indexForMessage(const QString& messageId) const;
+    const Message* messageAt(int row) const;
+    const MessageRow* rowAt(int row) const;
+    bool isOwnMessage(const Message& message) const;
+    MessageStatus statusOf(const Message& message) const;
+    QStringList messagesFromSender(const QString& senderId) const;
+
+private:
+    void forgetMessage(const QString& messageId);
+    void rebuildIndex(int fromRow);
+
+    const ChatStore* m_store = nullptr;
+    RowDecorator m_decorator;
+    QString m_chatId;
+    QStringList m_ids;
+    QHash<QString, int> m_rowById;
+    QHash<QString, Message> m_detached;
+    mutable QHash<QString, MessageRow> m_rowCache;
+};
+
+#endif // MESSAGELISTMODEL_H
@@ -0,0 +1,52 @@
+#include "MessageWidgetPool.h"
+
+#include "MessageItemWidget.h"
+
+MessageWidgetPool::MessageWidgetPool(QWidget* host, int maxIdle, QObject* parent)
+    : QObject(parent),
+      m_host(host),
+      m_maxIdle(maxIdle)
+{
+}
+
+MessageItemWidget* MessageWidgetPool::acquire(bool* created)
+{
+    while (!m_idle.isEmpty()) {
+        // Parked widgets die with the host; skip any that already have.
+        if (MessageItemWidget* widget = m_idle.takeLast()) {
+            ++m_reused;
+            if (created) {
+                *created = false;
+            }
+            return widget;
+        }
+    }
+    ++m_created;
+    if (created) {
+        *created = true;
+    }
+    return new MessageItemWidget(m_host);
+}
+
+void MessageWidgetPool::recycle(MessageItemWidget* widget)
+{
+    if (!widget) {
+        return;
+    }
+    if (m_idle.size() >= m_maxIdle || widget->parentWidget() != m_host) {
+        widget->deleteLater();
+        return;
+    }
+    widget->hide();
+    widget->reset();
+    m_idle.append(widget);
+}
+
+MessageWidgetPool::Stats MessageWidgetPool::stats() const
+{
+    Stats result;
+    result.created = m_created;
+    result.reused = m_reused;
+    result.idle = m_idle.size();
+    return result;
+}
@@ -0,0 +1,42 @@
+#ifndef MESSAGEWIDGETPOOL_H
+#define MESSAGEWIDGETPOOL_H
+
+#include <QObject>
+#include <QPointer>
+#include <QVector>
+
+class MessageItemWidget;
+class QWidget;
+
+// Free list of MessageItemWidgets. Widgets the message view lets go of
+// (rows scrolled out, chat switches) are reset and parked hidden on the
+// host instead of deleted; acquire() hands them back for rebinding, so a
+// warm pool switches chats without building new bubbles.
+class MessageWidgetPool : public QObject
+{
+    Q_OBJECT
+public:
+    struct Stats {
+        quint64 created = 0;
+        quint64 reused = 0;
+        int idle = 0;
+    };
+
+    explicit MessageWidgetPool(QWidget* host, int maxIdle, QObject* parent = nullptr);
+
+    // Returns an unbound widget; created is set when none was idle and a
+    // new one had to be built (callers connect signals only then).
+    MessageItemWidget* acquire(bool* created = nullptr);
+    // Resets and parks widget; deletes it once maxIdle widgets are parked.
+    void recycle(MessageItemWidget* widget);
+    Stats stats() const;
+
+private:
+    QPointer<QWidget> m_host;
+    int m_maxIdle;
+    QVector<QPointer<MessageItemWidget>> m_idle;
+    quint64 m_created = 0;
+    quint64 m_reused = 0;
+};
+
+#endif // MESSAGEWIDGETPOOL_H
@@ -0,0 +1,73 @@
+#include "Metrics.h"
+
+#include <atomic>
+
+namespace Metrics {
+
+namespace {
+struct AtomicTiming {
+    std::atomic<quint64> count{0};
+    std::atomic<quint64> totalNs{0};
+    std::atomic<quint64> maxNs{0};
+};
+
+struct Registry {
+    Registry()
+    {
+        for (auto& gauge : gauges) {
+            gauge.store(-1, std::memory_order_relaxed);
+        }
+    }
+
+    std::array<std::atomic<quint64>, static_cast<size_t>(Counter::Count)> counters{};
+    std::array<std::atomic<qint64>, static_cast<size_t>(Gauge::Count)> gauges;
+    std::array<AtomicTiming, static_cast<size_t>(ServerEvent::Count)> events;
+};
+
+Registry& registry()
+{
+    static Registry instance;
+    return instance;
+}
+}
+
+void add(Counter counter, quint64 amount)
+{
+    registry().counters[static_cast<size_t>(counter)].fetch_add(amount, std::memory_order_relaxed);
+}
+
+void set(Gauge gauge, qint64 value)
+{
+    registry().gauges[static_cast<size_t>(gauge)].store(value, std::memory_order_relaxed);
+}
+
+void recordEvent(ServerEvent event, qint64 elapsedNs)
+{
+    AtomicTiming& timing = registry().events[static_cast<size_t>(event)];
+    const quint64 ns = static_cast<quint64>(qMax<qint64>(0, elapsedNs));
+    timing.count.fetch_add(1, std::memory_order_relaxed);
+    timing.totalNs.fetch_add(ns, std::memory_order_relaxed);
+    quint64 previous = timing.maxNs.load(std::memory_order_relaxed);
+    while (ns > previous && !timing.maxNs.compare_exchange_weak(previous, ns, std::memory_order_relaxed)) {
+    }
+}
+
+Snapshot snapshot()
+{
+    const Registry& reg = registry();
+    Snapshot result;
+    for (size_t i = 0; i < result.counters.size(); ++i) {
+        result.counters[i] = reg.counters[i].load(std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < result.gauges.size(); ++i) {
+        result.gauges[i] = reg.gauges[i].load(std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < result.events.size(); ++i) {
+        result.events[i].count = reg.events[i].count.load(std::memory_order_relaxed);
+        result.events[i].totalNs = reg.events[i].totalNs.load(std::memory_order_relaxed);
+        result.events[i].maxNs = reg.events[i].maxNs.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+} // namespace Metrics
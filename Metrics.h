@@ -0,0 +1,76 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QtGlobal>
+
+#include <array>
+
+#include "ServerEvent.h"
+
+// Process-wide counters behind the Diagnostics settings page. Writers are
+// lock-free (relaxed atomics) so the network thread can count every frame;
+// readers take a snapshot and difference two of them for rates.
+namespace Metrics {
+
+// Monotonic totals.
+enum class Counter {
+    WsFramesIn,
+    WsFramesOut,
+    WsBytesIn,
+    WsBytesOut,
+    Count
+};
+
+// Last value published by whoever owns the number; -1 until then.
+enum class Gauge {
+    PendingMessages,
+    OutboxQueued,
+    OutboxInFlight,
+    MessageWidgets,
+    MessageWidgetsCreated,
+    MessageWidgetsReused,
+    MessageWidgetsIdle,
+    ChatSwitchMs,
+    EventLoopLagMs,
+    EventLoopLagPeakMs,
+    MediaMemoryHits,
+    MediaMemoryMisses,
+    MediaDiskHits,
+    MediaDiskMisses,
+    MediaMemoryBytes,
+    MediaMemoryBudgetBytes,
+    MediaDiskBytes,
+    VoiceQueuedMs,
+    VoiceBufferFillPercent,
+    FirstRenderMs,
+    // 1 when the local store provided the first render, 0 for the server.
+    FirstRenderFromLocalStore,
+    FirstChatRowMs,
+    Count
+};
+
+// Decode plus handler time for one server event type.
+struct EventTiming {
+    quint64 count = 0;
+    quint64 totalNs = 0;
+    quint64 maxNs = 0;
+};
+
+struct Snapshot {
+    std::array<quint64, static_cast<size_t>(Counter::Count)> counters{};
+    std::array<qint64, static_cast<size_t>(Gauge::Count)> gauges{};
+    std::array<EventTiming, static_cast<size_t>(ServerEvent::Count)> events{};
+
+    quint64 counter(Counter c) const { return counters[static_cast<size_t>(c)]; }
+    qint64 gauge(Gauge g) const { return gauges[static_cast<size_t>(g)]; }
+    const EventTiming& event(ServerEvent e) const { return events[static_cast<size_t>(e)]; }
+};
+
+void add(Counter counter, quint64 amount = 1);
+void set(Gauge gauge, qint64 value);
+void recordEvent(ServerEvent event, qint64 elapsedNs);
+Snapshot snapshot();
+
+} // namespace Metrics
+
+#endif // METRICS_H
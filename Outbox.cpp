@@ -0,0 +1,193 @@
+#include "Outbox.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace {
+QString outboxDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + QStringLiteral("/outbox");
+}
+
+QString outboxPathFor(const QString& accountId)
+{
+    const QByteArray hash = QCryptographicHash::hash(accountId.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return outboxDirectory() + QLatin1Char('/') + QString::fromLatin1(hash) + QStringLiteral(".json");
+}
+}
+
+void Outbox::open(const QString& accountId)
+{
+    const QString path = outboxPathFor(accountId);
+    if (path == m_path) {
+        return;
+    }
+    if (!m_path.isEmpty()) {
+        close();
+    }
+    QDir().mkpath(outboxDirectory());
+    m_path = path;
+    load();
+    save();
+}
+
+void Outbox::close()
+{
+    save();
+    m_operations.clear();
+    m_path.clear();
+}
+
+void Outbox::wipe()
+{
+    m_operations.clear();
+    if (!m_path.isEmpty()) {
+        QFile::remove(m_path);
+    }
+    m_path.clear();
+}
+
+void Outbox::enqueue(const QString& key, const QJsonObject& payload)
+{
+    Operation operation;
+    operation.key = key;
+    operation.payload = payload;
+    operation.queuedAt = QDateTime::currentMSecsSinceEpoch();
+    m_operations.push_back(operation);
+    save();
+}
+
+std::vector<QJsonObject> Outbox::takeSendable(int maxInFlight)
+{
+    std::vector<QJsonObject> sendable;
+    int inFlight = 0;
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (Operation& operation : m_operations) {
+        if (inFlight >= maxInFlight) {
+            break;
+        }
+        if (operation.sentAt == 0) {
+            operation.sentAt = now;
+            sendable.push_back(operation.payload);
+        }
+        ++inFlight;
+    }
+    return sendable;
+}
+
+bool Outbox::acknowledge(const QString& key)
+{
+    for (auto it = m_operations.begin(); it != m_operations.end(); ++it) {
+        if (it->key == key) {
+            recordDelivered(*it);
+            m_operations.erase(it);
+            save();
+            return true;
+        }
+    }
+    return false;
+}
+
+void Outbox::acknowledgeInFlight()
+{
+    bool changed = false;
+    for (auto it = m_operations.begin(); it != m_operations.end();) {
+        if (it->sentAt == 0) {
+            ++it;
+            continue;
+        }
+        recordDelivered(*it);
+        it = m_operations.erase(it);
+        changed = true;
+    }
+    if (changed) {
+        save();
+    }
+}
+
+void Outbox::requeueInFlight(qint64 olderThanMs)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (Operation& operation : m_operations) {
+        if (operation.sentAt != 0 && (olderThanMs < 0 || now - operation.sentAt > olderThanMs)) {
+            operation.sentAt = 0;
+        }
+    }
+}
+
+Outbox::Stats Outbox::stats() const
+{
+    Stats result = m_stats;
+    for (const Operation& operation : m_operations) {
+        if (operation.sentAt == 0) {
+            ++result.queued;
+        } else {
+            ++result.inFlight;
+        }
+    }
+    return result;
+}
+
+void Outbox::recordDelivered(const Operation& operation)
+{
+    const qint64 latency = QDateTime::currentMSecsSinceEpoch() - operation.queuedAt;
+    ++m_stats.delivered;
+    m_stats.lastFlushLatencyMs = latency;
+    m_stats.maxFlushLatencyMs = qMax(m_stats.maxFlushLatencyMs, latency);
+}
+
+void Outbox::load()
+{
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    const QJsonArray entries = QJsonDocument::fromJson(file.readAll()).array();
+    std::deque<Operation> loaded;
+    for (const QJsonValue& value : entries) {
+        const QJsonObject obj = value.toObject();
+        Operation operation;
+        operation.key = obj.value(QStringLiteral("key")).toString();
+        operation.payload = obj.value(QStringLiteral("payload")).toObject();
+        operation.queuedAt = static_cast<qint64>(obj.value(QStringLiteral("queuedAt")).toDouble());
+        if (operation.key.isEmpty() || operation.payload.isEmpty()) {
+            continue;
+        }
+        loaded.push_back(operation);
+    }
+    // Whatever was queued before the account was known is newer.
+    for (Operation& operation : m_operations) {
+        loaded.push_back(std::move(operation));
+    }
+    m_operations = std::move(loaded);
+}
+
+void Outbox::save() const
+{
+    if (m_path.isEmpty()) {
+        return;
+    }
+    if (m_operations.empty()) {
+        QFile::remove(m_path);
+        return;
+    }
+    QJsonArray entries;
+    for (const Operation& operation : m_operations) {
+        entries.append(QJsonObject{
+            {QStringLiteral("key"), operation.key},
+            {QStringLiteral("payload"), operation.payload},
+            {QStringLiteral("queuedAt"), static_cast<double>(operation.queuedAt)},
+        });
+    }
+    QSaveFile file(m_path);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(entries).toJson(QJsonDocument::Compact));
+        file.commit();
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef OUTBOX_H
+#define OUTBOX_H
+
+#include <QJsonObject>
+#include <QMetaType>
+#include <QString>
+
+#include <deque>
+#include <vector>
+
+// Durable queue of user operations (send / edit / delete) that must reach the
+// server even across disconnects and restarts. Every operation carries a
+// client-generated idempotency key ("clientMessageId") so it can be resent
+// safely and matched against the server echo. The queue is kept per account
+// as a JSON file under AppLocalDataLocation/outbox. Not thread-safe; it is
+// owned by WebSocketWorker and only used on the network thread.
+class Outbox
+{
+public:
+    struct Stats {
+        int queued = 0;    // Waiting to be written to the socket.
+        int inFlight = 0;  // Written, not yet acknowledged.
+        quint64 delivered = 0;
+        qint64 lastFlushLatencyMs = 0; // Enqueue -> acknowledgement.
+        qint64 maxFlushLatencyMs = 0;
+    };
+
+    // Loads the account's pending operations. Anything queued before an
+    // account was known is kept and ordered after the loaded operations.
+    void open(const QString& accountId);
+    void close();
+    // Drops every pending operation and deletes the account's file.
+    void wipe();
+
+    void enqueue(const QString& key, const QJsonObject& payload);
+    // Marks and returns, in queue order, the operations that may be written
+    // now while keeping at most maxInFlight unacknowledged.
+    std::vector<QJsonObject> takeSendable(int maxInFlight);
+    // Returns true if key belonged to a pending operation.
+    bool acknowledge(const QString& key);
+    // Everything written so far counts as delivered. Used when the server
+    // does not echo idempotency keys.
+    void acknowledgeInFlight();
+    // Puts in-flight operations back in the queue (connection lost), or only
+    // those written more than olderThanMs ago.
+    void requeueInFlight(qint64 olderThanMs = -1);
+
+    bool isEmpty() const { return m_operations.empty(); }
+    Stats stats() const;
+
+private:
+    struct Operation {
+        QString key;
+        QJsonObject payload;
+        qint64 queuedAt = 0;
+        qint64 sentAt = 0; // 0 while queued.
+    };
+
+    void load();
+    void save() const;
+    void recordDelivered(const Operation& operation);
+
+    std::deque<Operation> m_operations;
+    QString m_path;
+    Stats m_stats;
+};
+
+Q_DECLARE_METATYPE(Outbox::Stats)
+
+#endif // OUTBOX_H
@@ -12,6 +12,20 @@
 #include <QNetworkRequest>
 #include <QUrl>
 
+namespace {
+QHttpPart makeFilePart(const QString& formField, const QString& fileName, const QString& mimeType)
+{
+    QHttpPart part;
+    const QString disposition = QStringLiteral("form-data; name=\"%1\"; filename=\"%2\"")
+                                    .arg(formField, fileName.isEmpty() ? QStringLiteral("upload.bin") : fileName);
+    part.setHeader(QNetworkRequest::ContentDispositionHeader, disposition);
+    if (!mimeType.isEmpty()) {
+        part.setHeader(QNetworkRequest::ContentTypeHeader, mimeType);
+    }
+    return part;
+}
+}
+
 RestClient::RestClient(QObject* parent)
     : QObject(parent),
       m_apiBaseUrl(AppConfig::apiBaseUrl())
@@ -48,33 +62,51 @@ QNetworkReply* RestClient::uploadBytes(const QString& path,
     QNetworkRequest request = buildRequest(path, includeAuth);
     auto* multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
 
-    QHttpPart filePart;
-    const QString disposition = QStringLiteral("form-data; name=\"%1\"; filename=\"%2\"")
-                                    .arg(formField, fileName.isEmpty() ? QStringLiteral("upload.bin") : fileName);
-    filePart.setHeader(QNetworkRequest::ContentDispositionHeader, disposition);
-    if (!mimeType.isEmpty()) {
-        filePart.setHeader(QNetworkRequest::ContentTypeHeader, mimeType);
-    }
+    QHttpPart filePart = makeFilePart(formField, fileName, mimeType);
     filePart.setBody(data);
     multiPart->append(filePart);
 
     QNetworkReply* reply = m_network.post(request, multiPart);
     multiPart->setParent(reply);
+    trackUpload(reply);
     return reply;
 }
 
 QNetworkReply* RestClient::uploadFile(const QString& path, const QString& localPath, const QString& formField, bool includeAuth)
 {
-    QFile file(localPath);
-    if (!file.open(QIODevice::ReadOnly)) {
+    auto* file = new QFile(localPath);
+    if (!file->open(QIODevice::ReadOnly)) {
+        delete file;
         return nullptr;
     }
 
-    const QByteArray payload = file.readAll();
-    const QString fileName = QFileInfo(file).fileName();
+    const QString fileName = QFileInfo(*file).fileName();
     const QMimeDatabase db;
     const QString mimeType = db.mimeTypeForFile(fileName).name();
-    return uploadBytes(path, payload, fileName, mimeType, formField, includeAuth);
+
+    // The multipart body has a known size and is seekable, so with buffering
+    // disabled it is read from the file as the socket drains rather than
+    // being copied into memory first.
+    QNetworkRequest request = buildRequest(path, includeAuth);
+    request.setAttribute(QNetworkRequest::DoNotBufferUploadDataAttribute, true);
+    auto* multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
+    file->setParent(multiPart);
+
+    QHttpPart filePart = makeFilePart(formField, fileName, mimeType);
+    filePart.setBodyDevice(file);
+    multiPart->append(filePart);
+
+    QNetworkReply* reply = m_network.post(request, multiPart);
+    multiPart->setParent(reply);
+    trackUpload(reply);
+    return reply;
+}
+
+void RestClient::cancelUpload(QNetworkReply* reply)
+{
+    if (reply && reply->isRunning()) {
+        reply->abort();
+    }
 }
 
 QNetworkReply* RestClient::uploadChatFile(const QByteArray& data, const QString& fileName, const QString& mimeType)
@@ -151,6 +183,13 @@ QNetworkReply* RestClient::updatePrivacy(bool blockGroupInvites)
     return postJson(QStringLiteral("/user/privacy"), body, true);
 }
 
+void RestClient::trackUpload(QNetworkReply* reply)
+{
+    connect(reply, &QNetworkReply::uploadProgress, this, [this, reply](qint64 bytesSent, qint64 bytesTotal) {
+        emit uploadProgress(reply, bytesSent, bytesTotal);
+    });
+}
+
 QNetworkRequest RestClient::buildRequest(const QString& path, bool includeAuth) const
 {
     QNetworkRequest request(QUrl(resolveUrl(path)));
@@ -27,10 +27,14 @@ public:
                                const QString& formField = QStringLiteral("file"),
                                bool includeAuth = true);
 
+    // Streams the file body from disk; returns nullptr if it cannot be opened.
     QNetworkReply* uploadFile(const QString& path,
                               const QString& localPath,
                               const QString& formField = QStringLiteral("file"),
                               bool includeAuth = true);
+    // Aborts an upload started by this client; the reply still emits finished()
+    // with QNetworkReply::OperationCanceledError.
+    void cancelUpload(QNetworkReply* reply);
 
     // Typed API wrappers used by parity plan.
     QNetworkReply* uploadChatFile(const QByteArray& data, const QString& fileName, const QString& mimeType);
@@ -44,7 +48,11 @@ public:
     QNetworkReply* chatSettingsAction(const QString& action, const QString& chatId, const QJsonObject& extra = QJsonObject());
     QNetworkReply* updatePrivacy(bool blockGroupInvites);
 
+signals:
+    void uploadProgress(QNetworkReply* reply, qint64 bytesSent, qint64 bytesTotal);
+
 private:
+    void trackUpload(QNetworkReply* reply);
     QNetworkRequest buildRequest(const QString& path, bool includeAuth) const;
     QString resolveUrl(const QString& path) const;
 
@@ -0,0 +1,95 @@
+#include "ServerEvent.h"
+
+#include <algorithm>
+#include <array>
+
+namespace {
+struct TypeEntry {
+    const char* name;
+    ServerEvent event;
+};
+
+constexpr std::array<TypeEntry, 20> kTypeTable{{
+    {"auth_failed", ServerEvent::AuthFailed},
+    {"channel_info", ServerEvent::ChannelInfo},
+    {"chat_history", ServerEvent::ChatHistory},
+    {"error", ServerEvent::Error},
+    {"incoming_call", ServerEvent::IncomingCall},
+    {"login_success", ServerEvent::LoginSuccess},
+    {"member_joined", ServerEvent::MemberJoined},
+    {"message", ServerEvent::Message},
+    {"message_deleted", ServerEvent::MessageDeleted},
+    {"message_pinned", ServerEvent::MessagePinned},
+    {"message_seen_update", ServerEvent::MessageSeenUpdate},
+    {"message_unpinned", ServerEvent::MessageUnpinned},
+    {"message_updated", ServerEvent::MessageUpdated},
+    {"new_chat_info", ServerEvent::NewChatInfo},
+    {"password_changed", ServerEvent::PasswordChanged},
+    {"presence_update", ServerEvent::PresenceUpdate},
+    {"typing", ServerEvent::Typing},
+    {"user_list_update", ServerEvent::UserListUpdate},
+    {"user_updated", ServerEvent::UserUpdated},
+    {"voice_chat_update", ServerEvent::VoiceChatUpdate},
+}};
+
+constexpr bool latin1Less(const char* a, const char* b)
+{
+    while (*a && *a == *b) {
+        ++a;
+        ++b;
+    }
+    return static_cast<unsigned char>(*a) < static_cast<unsigned char>(*b);
+}
+
+constexpr bool isStrictlySorted()
+{
+    for (size_t i = 1; i < kTypeTable.size(); ++i) {
+        if (!latin1Less(kTypeTable[i - 1].name, kTypeTable[i].name)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(isStrictlySorted(), "kTypeTable must stay sorted for the binary search");
+static_assert(kTypeTable.size() == static_cast<size_t>(ServerEvent::Count) - 1,
+              "every ServerEvent except Unknown needs a type name");
+
+// <0, 0, >0 like strcmp; type names are ASCII so UTF-16 units compare directly.
+int compareType(QStringView type, const char* name)
+{
+    qsizetype i = 0;
+    for (; i < type.size() && name[i]; ++i) {
+        const ushort lhs = type[i].unicode();
+        const ushort rhs = static_cast<unsigned char>(name[i]);
+        if (lhs != rhs) {
+            return lhs < rhs ? -1 : 1;
+        }
+    }
+    if (i < type.size()) {
+        return 1;
+    }
+    return name[i] ? -1 : 0;
+}
+}
+
+ServerEvent serverEventFromType(QStringView type)
+{
+    const auto it = std::lower_bound(kTypeTable.begin(), kTypeTable.end(), type, [](const TypeEntry& entry, QStringView key) {
+        return compareType(key, entry.name) > 0;
+    });
+    if (it == kTypeTable.end() || compareType(type, it->name) != 0) {
+        return ServerEvent::Unknown;
+    }
+    return it->event;
+}
+
+const char* serverEventName(ServerEvent event)
+{
+    for (const TypeEntry& entry : kTypeTable) {
+        if (entry.event == event) {
+            return entry.name;
+        }
+    }
+    return "unknown";
+}
@@ -0,0 +1,38 @@
+#ifndef SERVEREVENT_H
+#define SERVEREVENT_H
+
+#include <QStringView>
+
+// Every server frame "type" the client understands. Values index the
+// worker's handler table, so Count must stay last.
+enum class ServerEvent {
+    Unknown,
+    LoginSuccess,
+    AuthFailed,
+    ChatHistory,
+    Message,
+    UserListUpdate,
+    NewChatInfo,
+    MessageSeenUpdate,
+    MessageUpdated,
+    MessageDeleted,
+    PresenceUpdate,
+    Typing,
+    ChannelInfo,
+    MemberJoined,
+    MessagePinned,
+    MessageUnpinned,
+    PasswordChanged,
+    VoiceChatUpdate,
+    IncomingCall,
+    UserUpdated,
+    Error,
+    Count
+};
+
+// Binary search over a compile-time sorted table of Latin-1 type names; no
+// allocation and no string construction per frame.
+ServerEvent serverEventFromType(QStringView type);
+const char* serverEventName(ServerEvent event);
+
+#endif // SERVEREVENT_H
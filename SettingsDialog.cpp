@@ -8,8 +8,10 @@
 #include <QLineEdit>
 #include <QMap>
 #include <QPushButton>
+#include <QScrollArea>
 #include <QSignalBlocker>
 #include <QStackedWidget>
+#include <QTimer>
 #include <QVBoxLayout>
 
 namespace {
@@ -36,6 +38,8 @@ QString settingsText(const QString& languageCode, const QString& key)
             {QStringLiteral("menu_profile"), QStringLiteral("Profile")},
             {QStringLiteral("menu_account"), QStringLiteral("Account")},
             {QStringLiteral("menu_preferences"), QStringLiteral("Preferences")},
+            {QStringLiteral("menu_diagnostics"), QStringLiteral("Diagnostics")},
+            {QStringLiteral("diagnostics_title"), QStringLiteral("Diagnostics")},
             {QStringLiteral("display_name_placeholder"), QStringLiteral("Display name")},
             {QStringLiteral("save"), QStringLiteral("Save")},
             {QStringLiteral("change_password"), QStringLiteral("Change Password")},
@@ -59,6 +63,8 @@ QString settingsText(const QString& languageCode, const QString& key)
             {QStringLiteral("menu_profile"), QStringLiteral("پروفایل")},
             {QStringLiteral("menu_account"), QStringLiteral("حساب")},
             {QStringLiteral("menu_preferences"), QStringLiteral("ترجیحات")},
+            {QStringLiteral("menu_diagnostics"), QStringLiteral("عیب‌یابی")},
+            {QStringLiteral("diagnostics_title"), QStringLiteral("عیب‌یابی")},
             {QStringLiteral("display_name_placeholder"), QStringLiteral("نام نمایشی")},
             {QStringLiteral("save"), QStringLiteral("ذخیره")},
             {QStringLiteral("change_password"), QStringLiteral("تغییر رمز عبور")},
@@ -82,6 +88,8 @@ QString settingsText(const QString& languageCode, const QString& key)
             {QStringLiteral("menu_profile"), QStringLiteral("الملف الشخصي")},
             {QStringLiteral("menu_account"), QStringLiteral("الحساب")},
             {QStringLiteral("menu_preferences"), QStringLiteral("التفضيلات")},
+            {QStringLiteral("menu_diagnostics"), QStringLiteral("التشخيص")},
+            {QStringLiteral("diagnostics_title"), QStringLiteral("التشخيص")},
             {QStringLiteral("display_name_placeholder"), QStringLiteral("الاسم المعروض")},
             {QStringLiteral("save"), QStringLiteral("حفظ")},
             {QStringLiteral("change_password"), QStringLiteral("تغيير كلمة المرور")},
@@ -105,6 +113,8 @@ QString settingsText(const QString& languageCode, const QString& key)
             {QStringLiteral("menu_profile"), QStringLiteral("Профиль")},
             {QStringLiteral("menu_account"), QStringLiteral("Аккаунт")},
             {QStringLiteral("menu_preferences"), QStringLiteral("Предпочтения")},
+            {QStringLiteral("menu_diagnostics"), QStringLiteral("Диагностика")},
+            {QStringLiteral("diagnostics_title"), QStringLiteral("Диагностика")},
             {QStringLiteral("display_name_placeholder"), QStringLiteral("Отображаемое имя")},
             {QStringLiteral("save"), QStringLiteral("Сохранить")},
             {QStringLiteral("change_password"), QStringLiteral("Изменить пароль")},
@@ -128,6 +138,8 @@ QString settingsText(const QString& languageCode, const QString& key)
             {QStringLiteral("menu_profile"), QStringLiteral("个人资料")},
             {QStringLiteral("menu_account"), QStringLiteral("账户")},
             {QStringLiteral("menu_preferences"), QStringLiteral("偏好设置")},
+            {QStringLiteral("menu_diagnostics"), QStringLiteral("诊断")},
+            {QStringLiteral("diagnostics_title"), QStringLiteral("诊断")},
             {QStringLiteral("display_name_placeholder"), QStringLiteral("显示名称")},
             {QStringLiteral("save"), QStringLiteral("保存")},
             {QStringLiteral("change_password"), QStringLiteral("修改密码")},
@@ -206,15 +218,19 @@ SettingsDialog::SettingsDialog(QWidget* parent)
     m_menuProfileButton = new QPushButton(QStringLiteral("Profile"), menuPage);
     m_menuAccountButton = new QPushButton(QStringLiteral("Account"), menuPage);
     m_menuPreferencesButton = new QPushButton(QStringLiteral("Preferences"), menuPage);
+    m_menuDiagnosticsButton = new QPushButton(QStringLiteral("Diagnostics"), menuPage);
     m_menuProfileButton->setObjectName(QStringLiteral("menuOption"));
     m_menuAccountButton->setObjectName(QStringLiteral("menuOption"));
     m_menuPreferencesButton->setObjectName(QStringLiteral("menuOption"));
+    m_menuDiagnosticsButton->setObjectName(QStringLiteral("menuOption"));
     m_menuProfileButton->setCursor(Qt::PointingHandCursor);
     m_menuAccountButton->setCursor(Qt::PointingHandCursor);
     m_menuPreferencesButton->setCursor(Qt::PointingHandCursor);
+    m_menuDiagnosticsButton->setCursor(Qt::PointingHandCursor);
     menuLayout->addWidget(m_menuProfileButton);
     menuLayout->addWidget(m_menuAccountButton);
     menuLayout->addWidget(m_menuPreferencesButton);
+    menuLayout->addWidget(m_menuDiagnosticsButton);
     menuLayout->addStretch();
     m_sections->addWidget(menuPage);
 
@@ -312,12 +328,29 @@ SettingsDialog::SettingsDialog(QWidget* parent)
     prefLayout->addStretch();
     m_sections->addWidget(prefPage);
 
+    auto* diagnosticsPage = new QScrollArea(m_sections);
+    diagnosticsPage->setObjectName(QStringLiteral("diagnosticsPage"));
+    diagnosticsPage->setWidgetResizable(true);
+    diagnosticsPage->setFrameShape(QFrame::NoFrame);
+    m_diagnosticsLabel = new QLabel(diagnosticsPage);
+    m_diagnosticsLabel->setObjectName(QStringLiteral("diagnosticsText"));
+    m_diagnosticsLabel->setAlignment(Qt::AlignLeft | Qt::AlignTop);
+    m_diagnosticsLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    m_diagnosticsLabel->setContentsMargins(14, 14, 14, 14);
+    diagnosticsPage->setWidget(m_diagnosticsLabel);
+    m_sections->addWidget(diagnosticsPage);
+
+    m_diagnosticsTimer = new QTimer(this);
+    m_diagnosticsTimer->setInterval(1000);
+    connect(m_diagnosticsTimer, &QTimer::timeout, this, &SettingsDialog::refreshDiagnostics);
+
     connect(m_backButton, &QPushButton::clicked, this, &SettingsDialog::showMenu);
     connect(m_closeButton, &QPushButton::clicked, this, &SettingsDialog::hide);
 
     connect(m_menuProfileButton, &QPushButton::clicked, this, [this]() { switchSection(Section::Profile); });
     connect(m_menuAccountButton, &QPushButton::clicked, this, [this]() { switchSection(Section::Account); });
     connect(m_menuPreferencesButton, &QPushButton::clicked, this, [this]() { switchSection(Section::Preferences); });
+    connect(m_menuDiagnosticsButton, &QPushButton::clicked, this, [this]() { switchSection(Section::Diagnostics); });
 
     connect(m_saveProfileButton, &QPushButton::clicked, this, [this]() {
         emit saveDisplayNameRequested(m_editDisplayNameInput->text().trimmed());
@@ -408,6 +441,9 @@ void SettingsDialog::setLanguage(const QString& languageCode)
     if (m_menuPreferencesButton) {
         m_menuPreferencesButton->setText(settingsText(m_languageCode, QStringLiteral("menu_preferences")));
     }
+    if (m_menuDiagnosticsButton) {
+        m_menuDiagnosticsButton->setText(settingsText(m_languageCode, QStringLiteral("menu_diagnostics")));
+    }
     if (m_editDisplayNameInput) {
         m_editDisplayNameInput->setPlaceholderText(settingsText(m_languageCode, QStringLiteral("display_name_placeholder")));
     }
@@ -488,6 +524,8 @@ void SettingsDialog::applyTheme()
         "QLineEdit, QComboBox {"
         " padding: 8px 10px; border: 1px solid %8; border-radius: 8px; background: %7; color: %2; }"
         "QCheckBox { color: %2; }"
+        "QScrollArea#diagnosticsPage, QScrollArea#diagnosticsPage > QWidget { background: transparent; }"
+        "#diagnosticsText { font-family: monospace; font-size: 12px; color: %2; }"
         "QPushButton#primaryAction {"
         " background: #2563eb; color: #ffffff; border: none; border-radius: 8px; padding: 8px 12px; }"
         "QPushButton#primaryAction:hover { background: #1d4ed8; }"
@@ -504,6 +542,7 @@ void SettingsDialog::switchSection(Section section)
 {
     m_sections->setCurrentIndex(static_cast<int>(section));
     syncHeaderForSection(section);
+    updateDiagnosticsActive();
 }
 
 void SettingsDialog::syncHeaderForSection(Section section)
@@ -525,5 +564,126 @@ void SettingsDialog::syncHeaderForSection(Section section)
         m_titleLabel->setText(settingsText(m_languageCode, QStringLiteral("preferences_title")));
         m_backButton->setVisible(true);
         break;
+    case Section::Diagnostics:
+        m_titleLabel->setText(settingsText(m_languageCode, QStringLiteral("diagnostics_title")));
+        m_backButton->setVisible(true);
+        break;
+    }
+}
+
+void SettingsDialog::showEvent(QShowEvent* event)
+{
+    QDialog::showEvent(event);
+    updateDiagnosticsActive();
+}
+
+void SettingsDialog::hideEvent(QHideEvent* event)
+{
+    QDialog::hideEvent(event);
+    updateDiagnosticsActive();
+}
+
+void SettingsDialog::updateDiagnosticsActive()
+{
+    const bool active = isVisible() && m_sections->currentIndex() == static_cast<int>(Section::Diagnostics);
+    if (active == m_diagnosticsActive) {
+        return;
     }
+    m_diagnosticsActive = active;
+    emit diagnosticsActiveChanged(active);
+    if (active) {
+        m_lastDiagnostics = Metrics::snapshot();
+        m_lastDiagnosticsClock.start();
+        refreshDiagnostics();
+        m_diagnosticsTimer->start();
+    } else {
+        m_diagnosticsTimer->stop();
+    }
+}
+
+// Plain monospace text so the page can be selected and pasted into a report.
+void SettingsDialog::refreshDiagnostics()
+{
+    using Metrics::Counter;
+    using Metrics::Gauge;
+
+    const Metrics::Snapshot now = Metrics::snapshot();
+    const double seconds = qMax<qint64>(1, m_lastDiagnosticsClock.restart()) / 1000.0;
+    const auto rate = [&](Counter counter) {
+        return (now.counter(counter) - m_lastDiagnostics.counter(counter)) / seconds;
+    };
+    const auto gauge = [&](Gauge g) {
+        const qint64 value = now.gauge(g);
+        return value < 0 ? QStringLiteral("-") : QString::number(value);
+    };
+    const auto megabytes = [&](Gauge g) {
+        const qint64 value = now.gauge(g);
+        return value < 0 ? QStringLiteral("-") : QString::number(value / (1024.0 * 1024.0), 'f', 1);
+    };
+    const auto hitRate = [&](Gauge hits, Gauge misses) {
+        const qint64 h = now.gauge(hits);
+        const qint64 total = h + now.gauge(misses);
+        return (h < 0 || total <= 0) ? QStringLiteral("-") : QString::number(100.0 * h / total, 'f', 1) + QLatin1Char('%');
+    };
+
+    QStringList lines;
+    lines << QStringLiteral("Network")
+          << QStringLiteral("  in   %1 frames/s  %2 KB/s")
+                 .arg(rate(Counter::WsFramesIn), 7, 'f', 1)
+                 .arg(rate(Counter::WsBytesIn) / 1024.0, 8, 'f', 1)
+          << QStringLiteral("  out  %1 frames/s  %2 KB/s")
+                 .arg(rate(Counter::WsFramesOut), 7, 'f', 1)
+                 .arg(rate(Counter::WsBytesOut) / 1024.0, 8, 'f', 1)
+          << QString();
+
+    lines << QStringLiteral("Parse + dispatch per event (avg / max us, count)");
+    for (int i = 0; i < static_cast<int>(ServerEvent::Count); ++i) {
+        const ServerEvent event = static_cast<ServerEvent>(i);
+        const Metrics::EventTiming& timing = now.event(event);
+        if (timing.count == 0) {
+            continue;
+        }
+        lines << QStringLiteral("  %1 %2 / %3  (%4)")
+                     .arg(QString::fromLatin1(serverEventName(event)), -20)
+                     .arg(timing.totalNs / timing.count / 1000, 6)
+                     .arg(timing.maxNs / 1000, 6)
+                     .arg(timing.count);
+    }
+    lines << QString();
+
+    lines << QStringLiteral("Messages")
+          << QStringLiteral("  pending sends    %1").arg(gauge(Gauge::PendingMessages))
+          << QStringLiteral("  outbox           %1 queued, %2 in flight").arg(gauge(Gauge::OutboxQueued), gauge(Gauge::OutboxInFlight))
+          << QStringLiteral("  message widgets  %1").arg(gauge(Gauge::MessageWidgets))
+          << QStringLiteral("  widget pool      %1 built, %2 reused, %3 idle")
+                 .arg(gauge(Gauge::MessageWidgetsCreated), gauge(Gauge::MessageWidgetsReused), gauge(Gauge::MessageWidgetsIdle))
+          << QStringLiteral("  last chat switch %1 ms").arg(gauge(Gauge::ChatSwitchMs))
+          << QString();
+
+    lines << QStringLiteral("Media cache")
+          << QStringLiteral("  memory  %1 hits  %2 / %3 MB")
+                 .arg(hitRate(Gauge::MediaMemoryHits, Gauge::MediaMemoryMisses), megabytes(Gauge::MediaMemoryBytes), megabytes(Gauge::MediaMemoryBudgetBytes))
+          << QStringLiteral("  disk    %1 hits  %2 MB")
+                 .arg(hitRate(Gauge::MediaDiskHits, Gauge::MediaDiskMisses), megabytes(Gauge::MediaDiskBytes))
+          << QString();
+
+    const qint64 fromLocalStore = now.gauge(Gauge::FirstRenderFromLocalStore);
+    const QString firstRenderSource = fromLocalStore < 0 ? QString()
+                                      : fromLocalStore > 0 ? QStringLiteral(" (local store)")
+                                                           : QStringLiteral(" (server)");
+    lines << QStringLiteral("GUI")
+          << QStringLiteral("  event-loop lag   %1 ms (peak %2 ms)").arg(gauge(Gauge::EventLoopLagMs), gauge(Gauge::EventLoopLagPeakMs))
+          << QStringLiteral("  first render     %1 ms%2").arg(gauge(Gauge::FirstRenderMs), firstRenderSource)
+          << QStringLiteral("  first chat row   %1 ms").arg(gauge(Gauge::FirstChatRowMs))
+          << QString();
+
+    lines << QStringLiteral("Voice playback");
+    if (now.gauge(Gauge::VoiceBufferFillPercent) < 0) {
+        lines << QStringLiteral("  not in a call");
+    } else {
+        lines << QStringLiteral("  buffer fill      %1% (%2 ms queued)").arg(gauge(Gauge::VoiceBufferFillPercent), gauge(Gauge::VoiceQueuedMs));
+    }
+
+    m_diagnosticsLabel->setText(lines.join(QLatin1Char('\n')));
+    m_lastDiagnostics = now;
 }
@@ -2,6 +2,9 @@
 #define SETTINGSDIALOG_H
 
 #include <QDialog>
+#include <QElapsedTimer>
+
+#include "Metrics.h"
 
 class QCheckBox;
 class QComboBox;
@@ -9,6 +12,7 @@ class QLabel;
 class QLineEdit;
 class QPushButton;
 class QStackedWidget;
+class QTimer;
 
 class SettingsDialog : public QDialog
 {
@@ -37,18 +41,28 @@ signals:
     void downloadUpdateRequested();
     void installUpdateRequested();
     void languageChanged(const QString& languageCode);
+    // True while the Diagnostics page is on screen; the owner publishes its
+    // gauges to Metrics only then.
+    void diagnosticsActiveChanged(bool active);
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
 
 private:
     enum class Section {
         Menu = 0,
         Profile,
         Account,
-        Preferences
+        Preferences,
+        Diagnostics
     };
 
     void applyTheme();
     void switchSection(Section section);
     void syncHeaderForSection(Section section);
+    void updateDiagnosticsActive();
+    void refreshDiagnostics();
     bool m_darkMode = false;
     QString m_languageCode = QStringLiteral("en");
     QString m_currentUserId;
@@ -61,6 +75,7 @@ private:
     QPushButton* m_menuProfileButton = nullptr;
     QPushButton* m_menuAccountButton = nullptr;
     QPushButton* m_menuPreferencesButton = nullptr;
+    QPushButton* m_menuDiagnosticsButton = nullptr;
     QLabel* m_profileUsernameLabel = nullptr;
     QLabel* m_profileUserIdLabel = nullptr;
     QLineEdit* m_editDisplayNameInput = nullptr;
@@ -80,6 +95,13 @@ private:
     QPushButton* m_checkUpdateButton = nullptr;
     QPushButton* m_downloadUpdateButton = nullptr;
     QPushButton* m_installUpdateButton = nullptr;
+
+    QLabel* m_diagnosticsLabel = nullptr;
+    QTimer* m_diagnosticsTimer = nullptr;
+    bool m_diagnosticsActive = false;
+    // Previous sample, for per-second rates.
+    Metrics::Snapshot m_lastDiagnostics;
+    QElapsedTimer m_lastDiagnosticsClock;
 };
 
 #endif // SETTINGSDIALOG_H
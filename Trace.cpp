@@ -0,0 +1,150 @@
+#include "Trace.h"
+
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <memory>
+#include <vector>
+
+namespace Trace {
+namespace detail {
+std::atomic<bool> g_enabled{false};
+}
+
+namespace {
+// About 24 MB per thread; later spans are counted but not kept.
+constexpr size_t kMaxEventsPerThread = 1000000;
+
+struct Event {
+    const char* name;
+    qint64 startUs;
+    qint64 durationUs;
+};
+
+// Owned by the registry rather than the thread, so spans from threads that
+// have already exited still make it into the file.
+struct ThreadBuffer {
+    QMutex mutex;
+    int tid = 0;
+    const char* threadName = nullptr;
+    std::vector<Event> events;
+    quint64 dropped = 0;
+};
+
+QMutex g_registryMutex;
+std::vector<std::shared_ptr<ThreadBuffer>> g_buffers;
+QString g_path;
+qint64 g_originUs = 0;
+
+ThreadBuffer& localBuffer()
+{
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        buffer = std::make_shared<ThreadBuffer>();
+        QMutexLocker locker(&g_registryMutex);
+        buffer->tid = static_cast<int>(g_buffers.size()) + 1;
+        g_buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+QByteArray jsonString(const char* text)
+{
+    QByteArray escaped;
+    for (const char* p = text; *p; ++p) {
+        if (*p == '"' || *p == '\\') {
+            escaped.append('\\');
+        }
+        escaped.append(*p);
+    }
+    return '"' + escaped + '"';
+}
+}
+
+namespace detail {
+void record(const char* name, qint64 startUs, qint64 endUs)
+{
+    ThreadBuffer& buffer = localBuffer();
+    QMutexLocker locker(&buffer.mutex);
+    if (buffer.events.size() >= kMaxEventsPerThread) {
+        ++buffer.dropped;
+        return;
+    }
+    buffer.events.push_back(Event{name, startUs, endUs - startUs});
+}
+}
+
+bool start(const QString& path)
+{
+#ifdef NOVEO_TRACING
+    if (path.isEmpty()) {
+        return false;
+    }
+    QMutexLocker locker(&g_registryMutex);
+    g_path = path;
+    g_originUs = detail::nowMicros();
+    for (const auto& buffer : g_buffers) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        buffer->events.clear();
+        buffer->dropped = 0;
+    }
+    detail::g_enabled.store(true, std::memory_order_relaxed);
+    return true;
+#else
+    Q_UNUSED(path);
+    return false;
+#endif
+}
+
+void stop()
+{
+    if (!detail::g_enabled.exchange(false)) {
+        return;
+    }
+    QMutexLocker locker(&g_registryMutex);
+    QFile file(g_path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return;
+    }
+
+    file.write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    const auto writeLine = [&file, &first](const QByteArray& line) {
+        if (!first) {
+            file.write(",\n");
+        }
+        file.write(line);
+        first = false;
+    };
+    for (const auto& buffer : g_buffers) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        const QByteArray tid = QByteArray::number(buffer->tid);
+        if (buffer->threadName) {
+            writeLine("{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" + tid +
+                      ",\"args\":{\"name\":" + jsonString(buffer->threadName) + "}}");
+        }
+        for (const Event& event : buffer->events) {
+            writeLine("{\"ph\":\"X\",\"cat\":\"noveo\",\"name\":" + jsonString(event.name) +
+                      ",\"ts\":" + QByteArray::number(event.startUs - g_originUs) +
+                      ",\"dur\":" + QByteArray::number(event.durationUs) +
+                      ",\"pid\":1,\"tid\":" + tid + "}");
+        }
+        if (buffer->dropped > 0) {
+            writeLine("{\"ph\":\"i\",\"s\":\"t\",\"name\":\"trace buffer full, dropped " +
+                      QByteArray::number(buffer->dropped) + " spans\",\"ts\":0,\"pid\":1,\"tid\":" + tid + "}");
+        }
+        buffer->events.clear();
+        buffer->events.shrink_to_fit();
+    }
+    file.write("\n]}\n");
+}
+
+void setThreadName(const char* name)
+{
+    ThreadBuffer& buffer = localBuffer();
+    QMutexLocker locker(&buffer.mutex);
+    buffer.threadName = name;
+}
+
+} // namespace Trace
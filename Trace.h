@@ -0,0 +1,75 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+#include <QtGlobal>
+
+#include <atomic>
+#include <chrono>
+
+// Scoped timing spans written as Chrome trace-event JSON (open the file in
+// chrome://tracing or Perfetto). Built only with -DNOVEO_ENABLE_TRACING=ON;
+// otherwise NOVEO_TRACE_SCOPE expands to nothing. When built in, recording
+// starts only if NOVEO_TRACE names an output file.
+namespace Trace {
+
+namespace detail {
+extern std::atomic<bool> g_enabled;
+
+inline qint64 nowMicros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void record(const char* name, qint64 startUs, qint64 endUs);
+} // namespace detail
+
+inline bool isEnabled()
+{
+    return detail::g_enabled.load(std::memory_order_relaxed);
+}
+
+// Starts recording to path; returns false if tracing was not built in.
+bool start(const QString& path);
+// Stops recording and writes the file. Safe to call when never started.
+void stop();
+// Labels the calling thread in the trace viewer.
+void setThreadName(const char* name);
+
+class Scope
+{
+public:
+    explicit Scope(const char* name)
+        : m_name(isEnabled() ? name : nullptr),
+          m_startUs(m_name ? detail::nowMicros() : 0)
+    {
+    }
+
+    ~Scope()
+    {
+        if (m_name) {
+            detail::record(m_name, m_startUs, detail::nowMicros());
+        }
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* m_name;
+    qint64 m_startUs;
+};
+
+} // namespace Trace
+
+// name must outlive the trace: a string literal or another static string.
+#ifdef NOVEO_TRACING
+#define NOVEO_TRACE_CONCAT_INNER(a, b) a##b
+#define NOVEO_TRACE_CONCAT(a, b) NOVEO_TRACE_CONCAT_INNER(a, b)
+#define NOVEO_TRACE_SCOPE(name) ::Trace::Scope NOVEO_TRACE_CONCAT(noveoTraceScope, __LINE__)(name)
+#else
+#define NOVEO_TRACE_SCOPE(name) static_cast<void>(0)
+#endif
+
+#endif // TRACE_H
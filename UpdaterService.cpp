@@ -4,13 +4,34 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QJsonDocument>
-#include <QJsonObject>
-#include <QProcess>
+#include <QTimer>
+
+namespace {
+// The updater is killed only if it goes this long without printing anything,
+// so a slow but progressing download is never cut off.
+constexpr int kUpdaterIdleTimeoutMs = 120000;
+}
 
 UpdaterService::UpdaterService(QObject* parent)
     : QObject(parent)
 {
     qRegisterMetaType<UpdaterService::UpdateInfo>("UpdaterService::UpdateInfo");
+
+    m_idleTimer = new QTimer(this);
+    m_idleTimer->setSingleShot(true);
+    m_idleTimer->setInterval(kUpdaterIdleTimeoutMs);
+    connect(m_idleTimer, &QTimer::timeout, this, [this]() {
+        failCommand(QStringLiteral("Updater process timed out."));
+    });
+}
+
+UpdaterService::~UpdaterService()
+{
+    if (m_process) {
+        m_process->disconnect(this);
+        m_process->kill();
+        m_process->waitForFinished(1000);
+    }
 }
 
 void UpdaterService::setUpdaterExecutable(const QString& updaterExecutablePath)
@@ -38,8 +59,16 @@ UpdaterService::UpdateInfo UpdaterService::availableUpdate() const
     return m_availableUpdate;
 }
 
+bool UpdaterService::isBusy() const
+{
+    return m_operation != Operation::None;
+}
+
 void UpdaterService::checkForUpdates()
 {
+    if (isBusy()) {
+        return;
+    }
     setStatus(Status::Checking, QStringLiteral("Checking for updates..."));
 
     QString error;
@@ -52,23 +81,15 @@ void UpdaterService::checkForUpdates()
         return;
     }
 
-    QByteArray stdOut;
-    QByteArray stdErr;
-    const QString processError = runUpdaterCommand(
-        QStringList() << QStringLiteral("--check") << QStringLiteral("--feed") << m_feedUrl << QStringLiteral("--json"),
-        &stdOut,
-        &stdErr);
-
-    if (!processError.isEmpty()) {
-        setStatus(Status::Error, processError);
-        return;
-    }
-
-    parseCheckResponse(stdOut);
+    startUpdaterCommand(Operation::Check,
+                        QStringList() << QStringLiteral("--check") << QStringLiteral("--feed") << m_feedUrl << QStringLiteral("--json"));
 }
 
 void UpdaterService::downloadUpdate()
 {
+    if (isBusy()) {
+        return;
+    }
     if (m_status != Status::UpdateAvailable) {
         setStatus(Status::Error, QStringLiteral("No update is available to download."));
         return;
@@ -83,23 +104,15 @@ void UpdaterService::downloadUpdate()
     setStatus(Status::Downloading, QStringLiteral("Downloading update..."));
     emit downloadProgress(0);
 
-    QByteArray stdOut;
-    QByteArray stdErr;
-    const QString processError = runUpdaterCommand(
-        QStringList() << QStringLiteral("--download") << QStringLiteral("--feed") << m_feedUrl << QStringLiteral("--json"),
-        &stdOut,
-        &stdErr);
-
-    if (!processError.isEmpty()) {
-        setStatus(Status::Error, processError);
-        return;
-    }
-
-    parseDownloadResponse(stdOut);
+    startUpdaterCommand(Operation::Download,
+                        QStringList() << QStringLiteral("--download") << QStringLiteral("--feed") << m_feedUrl << QStringLiteral("--json"));
 }
 
 void UpdaterService::restartAndInstall()
 {
+    if (isBusy()) {
+        return;
+    }
     if (m_status != Status::Downloaded) {
         setStatus(Status::Error, QStringLiteral("Update has not been downloaded yet."));
         return;
@@ -111,30 +124,24 @@ void UpdaterService::restartAndInstall()
         return;
     }
 
-    QByteArray stdOut;
-    QByteArray stdErr;
-    const QString processError = runUpdaterCommand(
-        QStringList() << QStringLiteral("--install") << QStringLiteral("--restart"),
-        &stdOut,
-        &stdErr);
-
-    if (!processError.isEmpty()) {
-        setStatus(Status::Error, processError);
-        return;
-    }
+    startUpdaterCommand(Operation::Install, QStringList() << QStringLiteral("--install") << QStringLiteral("--restart"));
 }
 
-bool UpdaterService::ensureUpdaterBinary(QString* errorMessage) const
+QString UpdaterService::updaterExecutablePath() const
 {
-    QString executable = m_updaterExecutable;
-    if (executable.isEmpty()) {
+    if (!m_updaterExecutable.isEmpty()) {
+        return m_updaterExecutable;
+    }
 #ifdef Q_OS_WIN
-        executable = QDir(QCoreApplication::applicationDirPath()).filePath(QStringLiteral("noveo-updater.exe"));
+    return QDir(QCoreApplication::applicationDirPath()).filePath(QStringLiteral("noveo-updater.exe"));
 #else
-        executable = QDir(QCoreApplication::applicationDirPath()).filePath(QStringLiteral("noveo-updater"));
+    return QDir(QCoreApplication::applicationDirPath()).filePath(QStringLiteral("noveo-updater"));
 #endif
-    }
+}
 
+bool UpdaterService::ensureUpdaterBinary(QString* errorMessage) const
+{
+    const QString executable = updaterExecutablePath();
     QFileInfo fi(executable);
     if (!fi.exists() || !fi.isFile()) {
         if (errorMessage) {
@@ -152,15 +159,155 @@ void UpdaterService::setStatus(Status status, const QString& message)
     emit statusChanged(status, message);
 }
 
-void UpdaterService::parseCheckResponse(const QByteArray& output)
+void UpdaterService::startUpdaterCommand(Operation operation, const QStringList& args)
+{
+    resetCommand();
+    m_operation = operation;
+    m_process = new QProcess(this);
+    connect(m_process, &QProcess::readyReadStandardOutput, this, &UpdaterService::readUpdaterOutput);
+    connect(m_process, &QProcess::readyReadStandardError, this, [this]() {
+        m_stdErr += m_process->readAllStandardError();
+        m_idleTimer->start();
+    });
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, &UpdaterService::onUpdaterFinished);
+    connect(m_process, &QProcess::errorOccurred, this, &UpdaterService::onUpdaterError);
+    m_idleTimer->start();
+    m_process->start(updaterExecutablePath(), args);
+}
+
+void UpdaterService::readUpdaterOutput()
+{
+    if (!m_process) {
+        return;
+    }
+    m_idleTimer->start();
+    const QByteArray chunk = m_process->readAllStandardOutput();
+    m_stdOut += chunk;
+    m_lineBuffer += chunk;
+
+    int newline = -1;
+    while ((newline = m_lineBuffer.indexOf('\n')) >= 0) {
+        const QByteArray line = m_lineBuffer.left(newline).trimmed();
+        m_lineBuffer.remove(0, newline + 1);
+        if (!line.isEmpty()) {
+            handleUpdaterLine(line);
+        }
+    }
+}
+
+void UpdaterService::handleUpdaterLine(const QByteArray& line)
+{
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        // Part of a multi-line document; it is parsed as a whole on exit.
+        return;
+    }
+    const QJsonObject obj = doc.object();
+    if (obj.value(QStringLiteral("type")).toString() == QStringLiteral("progress")) {
+        handleProgress(obj);
+        return;
+    }
+    m_result = obj;
+}
+
+void UpdaterService::handleProgress(const QJsonObject& progress)
+{
+    if (m_operation != Operation::Download) {
+        return;
+    }
+    int percent = -1;
+    if (progress.contains(QStringLiteral("percent"))) {
+        percent = progress.value(QStringLiteral("percent")).toInt();
+    } else {
+        const double received = progress.value(QStringLiteral("received")).toDouble();
+        const double total = progress.value(QStringLiteral("total")).toDouble();
+        if (total > 0) {
+            percent = static_cast<int>(received * 100.0 / total);
+        }
+    }
+    percent = qBound(0, percent, 100);
+    if (percent != m_lastPercent) {
+        m_lastPercent = percent;
+        emit downloadProgress(percent);
+    }
+}
+
+void UpdaterService::onUpdaterFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (!m_process) {
+        return;
+    }
+    readUpdaterOutput();
+    m_stdErr += m_process->readAllStandardError();
+    if (!m_lineBuffer.trimmed().isEmpty()) {
+        handleUpdaterLine(m_lineBuffer.trimmed());
+        m_lineBuffer.clear();
+    }
+
+    if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+        const QString err = QString::fromUtf8(m_stdErr).trimmed();
+        failCommand(err.isEmpty() ? QStringLiteral("Updater process failed.") : err);
+        return;
+    }
+
+    // A pretty-printed document parses whole, and its inner lines that
+    // happen to be complete objects must not stand in for it. Only JSON-lines
+    // output (progress events, then the result) fails here and falls back to
+    // the last result line.
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(m_stdOut, &parseError);
+    const QJsonObject result = (parseError.error == QJsonParseError::NoError && document.isObject()) ? document.object() : m_result;
+    const Operation operation = m_operation;
+    resetCommand();
+
+    if (operation == Operation::Check) {
+        parseCheckResponse(result);
+    } else if (operation == Operation::Download) {
+        parseDownloadResponse(result);
+    }
+}
+
+void UpdaterService::onUpdaterError(QProcess::ProcessError error)
+{
+    if (error == QProcess::FailedToStart) {
+        failCommand(QStringLiteral("Failed to start updater process."));
+    }
+    // Crashes and read/write errors are reported through finished().
+}
+
+void UpdaterService::failCommand(const QString& message)
+{
+    resetCommand();
+    setStatus(Status::Error, message);
+}
+
+void UpdaterService::resetCommand()
+{
+    m_idleTimer->stop();
+    if (m_process) {
+        m_process->disconnect(this);
+        if (m_process->state() != QProcess::NotRunning) {
+            m_process->kill();
+        }
+        m_process->deleteLater();
+        m_process = nullptr;
+    }
+    m_operation = Operation::None;
+    m_lineBuffer.clear();
+    m_stdOut.clear();
+    m_stdErr.clear();
+    m_result = QJsonObject();
+    m_lastPercent = -1;
+}
+
+void UpdaterService::parseCheckResponse(const QJsonObject& root)
 {
-    const QJsonDocument doc = QJsonDocument::fromJson(output);
-    if (!doc.isObject()) {
+    if (root.isEmpty()) {
         setStatus(Status::Error, QStringLiteral("Updater returned invalid JSON."));
         return;
     }
 
-    const QJsonObject root = doc.object();
     const bool hasUpdate = root.value(QStringLiteral("available")).toBool(false);
     if (!hasUpdate) {
         setStatus(Status::UpToDate, QStringLiteral("You are on the latest version."));
@@ -177,15 +324,13 @@ void UpdaterService::parseCheckResponse(const QByteArray& output)
     emit updateAvailable(m_availableUpdate);
 }
 
-void UpdaterService::parseDownloadResponse(const QByteArray& output)
+void UpdaterService::parseDownloadResponse(const QJsonObject& root)
 {
-    const QJsonDocument doc = QJsonDocument::fromJson(output);
-    if (!doc.isObject()) {
+    if (root.isEmpty()) {
         setStatus(Status::Error, QStringLiteral("Updater returned invalid download JSON."));
         return;
     }
 
-    const QJsonObject root = doc.object();
     const int percent = root.value(QStringLiteral("percent")).toInt(100);
     emit downloadProgress(percent);
 
@@ -198,39 +343,3 @@ void UpdaterService::parseDownloadResponse(const QByteArray& output)
     setStatus(Status::Downloaded, QStringLiteral("Update downloaded. Ready to install."));
     emit readyToInstall();
 }
-
-QString UpdaterService::runUpdaterCommand(const QStringList& args, QByteArray* stdOut, QByteArray* stdErr) const
-{
-    QString executable = m_updaterExecutable;
-    if (executable.isEmpty()) {
-#ifdef Q_OS_WIN
-        executable = QDir(QCoreApplication::applicationDirPath()).filePath(QStringLiteral("noveo-updater.exe"));
-#else
-        executable = QDir(QCoreApplication::applicationDirPath()).filePath(QStringLiteral("noveo-updater"));
-#endif
-    }
-
-    QProcess process;
-    process.start(executable, args);
-    if (!process.waitForStarted(5000)) {
-        return QStringLiteral("Failed to start updater process.");
-    }
-    if (!process.waitForFinished(120000)) {
-        process.kill();
-        return QStringLiteral("Updater process timed out.");
-    }
-
-    if (stdOut) {
-        *stdOut = process.readAllStandardOutput();
-    }
-    const QByteArray stderrBytes = process.readAllStandardError();
-    if (stdErr) {
-        *stdErr = stderrBytes;
-    }
-
-    if (process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0) {
-        const QString err = QString::fromUtf8(stderrBytes).trimmed();
-        return err.isEmpty() ? QStringLiteral("Updater process failed.") : err;
-    }
-    return QString();
-}
@@ -1,10 +1,21 @@
 #ifndef UPDATERSERVICE_H
 #define UPDATERSERVICE_H
 
+#include <QByteArray>
+#include <QJsonObject>
 #include <QObject>
+#include <QProcess>
 #include <QString>
 #include <QMetaType>
 
+class QTimer;
+
+// Drives the external noveo-updater binary without blocking the GUI thread.
+// Each command is a QProcess whose stdout is read as JSON lines:
+// {"type":"progress",...} lines report download progress as they arrive and
+// the last other object is the command's result. A single (possibly
+// pretty-printed) JSON document, as older updaters print, is still accepted.
+
 class UpdaterService : public QObject
 {
     Q_OBJECT
@@ -27,6 +38,7 @@ public:
     };
 
     explicit UpdaterService(QObject* parent = nullptr);
+    ~UpdaterService() override;
 
     void setUpdaterExecutable(const QString& updaterExecutablePath);
     void setFeedUrl(const QString& feedUrl);
@@ -34,6 +46,7 @@ public:
     Status status() const;
     QString statusText() const;
     UpdateInfo availableUpdate() const;
+    bool isBusy() const;
 
 public slots:
     void checkForUpdates();
@@ -47,17 +60,41 @@ signals:
     void readyToInstall();
 
 private:
+    enum class Operation {
+        None,
+        Check,
+        Download,
+        Install
+    };
+
+    QString updaterExecutablePath() const;
     bool ensureUpdaterBinary(QString* errorMessage = nullptr) const;
     void setStatus(Status status, const QString& message);
-    void parseCheckResponse(const QByteArray& output);
-    void parseDownloadResponse(const QByteArray& output);
-    QString runUpdaterCommand(const QStringList& args, QByteArray* stdOut, QByteArray* stdErr) const;
+    void startUpdaterCommand(Operation operation, const QStringList& args);
+    void readUpdaterOutput();
+    void handleUpdaterLine(const QByteArray& line);
+    void handleProgress(const QJsonObject& progress);
+    void onUpdaterFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onUpdaterError(QProcess::ProcessError error);
+    void failCommand(const QString& message);
+    void resetCommand();
+    void parseCheckResponse(const QJsonObject& root);
+    void parseDownloadResponse(const QJsonObject& root);
 
     QString m_updaterExecutable;
     QString m_feedUrl;
     Status m_status = Status::Idle;
     QString m_statusText = QStringLiteral("Idle");
     UpdateInfo m_availableUpdate;
+
+    QProcess* m_process = nullptr;
+    QTimer* m_idleTimer = nullptr;
+    Operation m_operation = Operation::None;
+    QByteArray m_lineBuffer;
+    QByteArray m_stdOut;
+    QByteArray m_stdErr;
+    QJsonObject m_result;
+    int m_lastPercent = -1;
 };
 
 Q_DECLARE_METATYPE(UpdaterService::UpdateInfo)
@@ -1,10 +1,39 @@
 #include "VoiceAudioBridge.h"
 
 #include <QAudioDeviceInfo>
+#include <QTimer>
+#include <QtEndian>
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+constexpr int kSampleRate = 24000;
+constexpr int kFrameMs = 20;
+constexpr int kFrameSamples = kSampleRate * kFrameMs / 1000;
+constexpr int kMixTickMs = 10;
+// Keep the device queue shallow; the jitter buffers are where latency lives.
+constexpr int kOutputQueueFrames = 3;
+constexpr double kMinTargetMs = 40.0;
+constexpr double kMaxTargetMs = 300.0;
+// A buffer allowed to grow this far past its target is trimmed back to it.
+constexpr int kMaxExcessMs = 120;
+// A gap longer than this is the end of a talk spurt, not jitter.
+constexpr qint64 kTalkSpurtGapMs = 250;
+constexpr qint64 kParticipantIdleMs = 5000;
+}
 
 VoiceAudioBridge::VoiceAudioBridge(QObject* parent)
     : QObject(parent)
 {
+    m_clock.start();
+    m_mixAccumulator.resize(kFrameSamples);
+    m_mixFrame.resize(kFrameSamples * static_cast<int>(sizeof(qint16)));
+
+    m_mixTimer = new QTimer(this);
+    m_mixTimer->setTimerType(Qt::PreciseTimer);
+    m_mixTimer->setInterval(kMixTickMs);
+    connect(m_mixTimer, &QTimer::timeout, this, &VoiceAudioBridge::mixTick);
 }
 
 VoiceAudioBridge::~VoiceAudioBridge()
@@ -58,11 +87,14 @@ bool VoiceAudioBridge::start()
         }
     });
 
+    m_mixTimer->start();
     return true;
 }
 
 void VoiceAudioBridge::stop()
 {
+    m_mixTimer->stop();
+    m_buffers.clear();
     if (m_audioInput) {
         m_audioInput->stop();
     }
@@ -80,21 +112,146 @@ bool VoiceAudioBridge::isRunning() const
     return m_audioInput && m_audioOutput && m_inputDevice && m_outputDevice;
 }
 
-void VoiceAudioBridge::playPcm(const QByteArray& pcm16le)
+VoiceAudioBridge::Stats VoiceAudioBridge::stats() const
+{
+    Stats result;
+    result.mixedFrames = m_mixedFrames;
+    result.clippedSamples = m_clippedSamples;
+    if (m_audioOutput && m_outputDevice) {
+        const int bufferBytes = m_audioOutput->bufferSize();
+        const int queuedBytes = qMax(0, bufferBytes - m_audioOutput->bytesFree());
+        result.outputQueuedMs = samplesToMs(queuedBytes / static_cast<int>(sizeof(qint16)));
+        result.outputBufferFillPercent = bufferBytes > 0 ? static_cast<int>(qint64(queuedBytes) * 100 / bufferBytes) : 0;
+    }
+    for (auto it = m_buffers.constBegin(); it != m_buffers.constEnd(); ++it) {
+        ParticipantStats participant;
+        participant.userId = it.key();
+        participant.bufferedMs = samplesToMs(static_cast<qint64>(it->samples.size()));
+        participant.targetMs = samplesToMs(it->targetSamples);
+        participant.jitterMs = it->jitterMs;
+        participant.packets = it->packets;
+        participant.underruns = it->underruns;
+        participant.droppedMs = static_cast<quint64>(samplesToMs(static_cast<qint64>(it->droppedSamples)));
+        result.participants.append(participant);
+    }
+    return result;
+}
+
+void VoiceAudioBridge::playPcm(const QString& userId, const QByteArray& pcm16le)
 {
-    if (pcm16le.isEmpty()) {
+    const int sampleCount = pcm16le.size() / static_cast<int>(sizeof(qint16));
+    if (userId.isEmpty() || sampleCount == 0) {
         return;
     }
     if (!ensureOutputStarted()) {
         return;
     }
-    m_outputDevice->write(pcm16le);
+
+    JitterBuffer& buffer = m_buffers[userId];
+    const qint64 now = m_clock.elapsed();
+    const double packetMs = sampleCount * 1000.0 / kSampleRate;
+
+    // RFC 3550-style interarrival jitter: smoothed deviation of the arrival
+    // spacing from the packet duration. Talk-spurt gaps are not jitter.
+    if (buffer.lastArrivalMs >= 0 && now - buffer.lastArrivalMs < kTalkSpurtGapMs) {
+        const double deviation = qAbs(static_cast<double>(now - buffer.lastArrivalMs) - packetMs);
+        buffer.jitterMs += (deviation - buffer.jitterMs) / 16.0;
+    }
+    buffer.lastArrivalMs = now;
+    buffer.lastPacketMs = now;
+    ++buffer.packets;
+    buffer.targetSamples = msToSamples(qBound(kMinTargetMs, packetMs + 2.0 * buffer.jitterMs, kMaxTargetMs));
+
+    const auto* data = reinterpret_cast<const uchar*>(pcm16le.constData());
+    for (int i = 0; i < sampleCount; ++i) {
+        buffer.samples.push_back(qFromLittleEndian<qint16>(data + i * sizeof(qint16)));
+    }
+
+    const size_t ceiling = static_cast<size_t>(buffer.targetSamples + msToSamples(kMaxExcessMs));
+    if (buffer.samples.size() > ceiling) {
+        const size_t excess = buffer.samples.size() - static_cast<size_t>(buffer.targetSamples);
+        buffer.samples.erase(buffer.samples.begin(), buffer.samples.begin() + static_cast<std::ptrdiff_t>(excess));
+        buffer.droppedSamples += excess;
+    }
+}
+
+void VoiceAudioBridge::mixTick()
+{
+    if (!m_audioOutput || !m_outputDevice) {
+        return;
+    }
+
+    const qint64 now = m_clock.elapsed();
+    for (auto it = m_buffers.begin(); it != m_buffers.end();) {
+        if (it->samples.empty() && now - it->lastPacketMs > kParticipantIdleMs) {
+            it = m_buffers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    const int frameBytes = m_mixFrame.size();
+    int queuedBytes = m_audioOutput->bufferSize() - m_audioOutput->bytesFree();
+    while (queuedBytes < kOutputQueueFrames * frameBytes && m_audioOutput->bytesFree() >= frameBytes) {
+        std::fill(m_mixAccumulator.begin(), m_mixAccumulator.end(), 0);
+
+        for (auto it = m_buffers.begin(); it != m_buffers.end(); ++it) {
+            JitterBuffer& buffer = it.value();
+            if (!buffer.primed) {
+                if (buffer.samples.empty() || static_cast<int>(buffer.samples.size()) < buffer.targetSamples) {
+                    continue;
+                }
+                buffer.primed = true;
+            }
+            const int available = qMin(kFrameSamples, static_cast<int>(buffer.samples.size()));
+            for (int i = 0; i < available; ++i) {
+                m_mixAccumulator[i] += buffer.samples[static_cast<size_t>(i)];
+            }
+            buffer.samples.erase(buffer.samples.begin(), buffer.samples.begin() + available);
+            if (available < kFrameSamples) {
+                // Ran dry: re-prime to the target depth before playing again.
+                // Running out right after the last packet is just the end of
+                // a talk spurt and is not counted.
+                buffer.primed = false;
+                if (now - buffer.lastPacketMs < kTalkSpurtGapMs) {
+                    ++buffer.underruns;
+                }
+            }
+        }
+
+        auto* out = reinterpret_cast<uchar*>(m_mixFrame.data());
+        for (int i = 0; i < kFrameSamples; ++i) {
+            qint32 sample = m_mixAccumulator[i];
+            if (sample > std::numeric_limits<qint16>::max() || sample < std::numeric_limits<qint16>::min()) {
+                ++m_clippedSamples;
+                sample = qBound<qint32>(std::numeric_limits<qint16>::min(), sample, std::numeric_limits<qint16>::max());
+            }
+            qToLittleEndian<qint16>(static_cast<qint16>(sample), out + i * sizeof(qint16));
+        }
+
+        const qint64 written = m_outputDevice->write(m_mixFrame);
+        if (written <= 0) {
+            break;
+        }
+        ++m_mixedFrames;
+        queuedBytes += static_cast<int>(written);
+    }
+}
+
+int VoiceAudioBridge::msToSamples(double ms) const
+{
+    return static_cast<int>(ms * kSampleRate / 1000.0);
+}
+
+int VoiceAudioBridge::samplesToMs(qint64 samples) const
+{
+    return static_cast<int>(samples * 1000 / kSampleRate);
 }
 
 QAudioFormat VoiceAudioBridge::createPcmFormat() const
 {
     QAudioFormat format;
-    format.setSampleRate(24000);
+    format.setSampleRate(kSampleRate);
     format.setChannelCount(1);
     format.setSampleSize(16);
     format.setCodec("audio/pcm");
@@ -122,5 +279,6 @@ bool VoiceAudioBridge::ensureOutputStarted()
         emit audioError("Failed to start output audio stream.");
         return false;
     }
+    m_mixTimer->start();
     return true;
 }
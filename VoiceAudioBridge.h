@@ -4,14 +4,45 @@
 #include <QAudioFormat>
 #include <QAudioInput>
 #include <QAudioOutput>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QIODevice>
 #include <QObject>
 #include <QScopedPointer>
+#include <QVector>
 
+#include <deque>
+
+class QTimer;
+
+// Captures microphone PCM and plays back remote participants. Incoming
+// packets land in a per-participant adaptive jitter buffer; a fixed-cadence
+// mixer sums whatever every participant has ready into a single output
+// stream, so overlapping speakers are mixed rather than concatenated and
+// network jitter does not turn into unbounded playback latency.
 class VoiceAudioBridge : public QObject
 {
     Q_OBJECT
 public:
+    struct ParticipantStats {
+        QString userId;
+        int bufferedMs = 0;
+        int targetMs = 0;
+        double jitterMs = 0.0;
+        quint64 packets = 0;
+        quint64 underruns = 0;
+        quint64 droppedMs = 0;
+    };
+
+    struct Stats {
+        QVector<ParticipantStats> participants;
+        quint64 mixedFrames = 0;
+        quint64 clippedSamples = 0;
+        int outputQueuedMs = 0;
+        // Share of QAudioOutput's device buffer holding unplayed audio.
+        int outputBufferFillPercent = 0;
+    };
+
     explicit VoiceAudioBridge(QObject* parent = nullptr);
     ~VoiceAudioBridge() override;
 
@@ -19,21 +50,46 @@ public:
     void stop();
     bool isRunning() const;
 
+    Stats stats() const;
+
 public slots:
-    void playPcm(const QByteArray& pcm16le);
+    void playPcm(const QString& userId, const QByteArray& pcm16le);
 
 signals:
     void pcmCaptured(const QByteArray& pcm16le);
     void audioError(const QString& message);
 
 private:
+    struct JitterBuffer {
+        std::deque<qint16> samples;
+        bool primed = false;
+        int targetSamples = 0;
+        double jitterMs = 0.0;
+        qint64 lastArrivalMs = -1;
+        qint64 lastPacketMs = 0;
+        quint64 packets = 0;
+        quint64 underruns = 0;
+        quint64 droppedSamples = 0;
+    };
+
     QAudioFormat createPcmFormat() const;
     bool ensureOutputStarted();
+    void mixTick();
+    int msToSamples(double ms) const;
+    int samplesToMs(qint64 samples) const;
 
     QScopedPointer<QAudioInput> m_audioInput;
     QScopedPointer<QAudioOutput> m_audioOutput;
     QIODevice* m_inputDevice = nullptr;
     QIODevice* m_outputDevice = nullptr;
+
+    QTimer* m_mixTimer = nullptr;
+    QElapsedTimer m_clock;
+    QHash<QString, JitterBuffer> m_buffers;
+    QVector<qint32> m_mixAccumulator;
+    QByteArray m_mixFrame;
+    quint64 m_mixedFrames = 0;
+    quint64 m_clippedSamples = 0;
 };
 
 #endif // VOICEAUDIOBRIDGE_H
@@ -1,41 +1,57 @@
 #ifndef WEBSOCKETCLIENT_H
 #define WEBSOCKETCLIENT_H
 
-#include <QJsonArray>
-#include <QJsonDocument>
+#include <QHash>
 #include <QJsonObject>
 #include <QObject>
-#include <QSslError>
-#include <QUrl>
-#include <QWebSocket>
+#include <QSet>
+#include <QStringList>
 
 #include "DataStructures.h"
+#include "Outbox.h"
 
+class QThread;
+class QTimer;
+class WebSocketWorker;
+
+// GUI-thread facade over WebSocketWorker. The socket and all JSON decoding
+// run on a dedicated network thread; results arrive here as queued signals.
 class WebSocketClient : public QObject
 {
     Q_OBJECT
 public:
     explicit WebSocketClient(QObject* parent = nullptr);
+    ~WebSocketClient() override;
 
     void connectToServer();
     void disconnectFromServer();
 
     void login(const QString& username, const QString& password);
     void registerUser(const QString& username, const QString& password);
-    void reconnectWithToken(const QString& userId, const QString& token);
-
+    // syncCursors maps chatId -> newest message timestamp already held. A
+    // server that supports it answers with the messages at or after it
+    // (chatDeltaReceived), which the receiver deduplicates by id; otherwise
+    // the full chat_history arrives as usual.
+    void reconnectWithToken(const QString& userId,
+                            const QString& token,
+                            const QHash<QString, qint64>& syncCursors = QHash<QString, qint64>());
+
+    // Sends, edits and deletes are queued in a durable outbox and delivered
+    // once a session is established; each returns the operation's
+    // idempotency key (clientMessageId), which the server echo carries back.
     // Compatibility send helper used by old UI.
-    void sendMessage(const QString& chatId, const QString& text, const QString& replyToId = QString());
+    QString sendMessage(const QString& chatId, const QString& text, const QString& replyToId = QString());
     // Full payload message send used by parity features.
-    void sendMessagePayload(const QString& chatId,
-                            const QJsonObject& content,
-                            const QString& replyToId = QString(),
-                            const QString& recipientId = QString());
+    QString sendMessagePayload(const QString& chatId,
+                               const QJsonObject& content,
+                               const QString& replyToId = QString(),
+                               const QString& recipientId = QString());
 
     void fetchHistory(const QString& chatId, qint64 beforeTimestamp);
+    // Receipts are coalesced per chat for a short window and sent as one batch.
     void sendMessageSeen(const QString& chatId, const QString& messageId);
-    void editMessage(const QString& chatId, const QString& messageId, const QString& newText);
-    void deleteMessage(const QString& chatId, const QString& messageId);
+    QString editMessage(const QString& chatId, const QString& messageId, const QString& newText);
+    QString deleteMessage(const QString& chatId, const QString& messageId);
 
     void sendTyping(const QString& chatId);
     void joinChannel(const QString& chatId);
@@ -55,9 +71,13 @@ public:
     void logout();
 
     bool isConnected() const;
+    // Seeds currentUserId() from local data before the server confirms the
+    // session; the next loginSuccess replaces it.
+    void setCachedUser(const User& user);
     QString currentUserId() const { return m_currentUser.userId; }
     QString currentToken() const { return m_token; }
     qint64 tokenExpiresAt() const { return m_tokenExpiresAt; }
+    Outbox::Stats outboxStats() const { return m_outboxStats; }
 
 signals:
     void connected();
@@ -67,6 +87,12 @@ signals:
     void authFailed(const QString& message);
 
     void chatHistoryReceived(const std::vector<Chat>& chats);
+    // Only messages newer than the cursors sent with reconnectWithToken.
+    void chatDeltaReceived(const std::vector<Chat>& chats);
+    // Large full histories arrive as several batches instead of one
+    // chatHistoryReceived, most recently active chats first. Together the
+    // batches from first to last are the complete chat list.
+    void chatHistoryBatchReceived(const std::vector<Chat>& chats, bool first, bool last);
     void messageReceived(const Message& msg);
     void userListUpdated(const std::vector<User>& users);
     void errorOccurred(const QString& msg);
@@ -94,47 +120,26 @@ signals:
     // PCM voice packet from websocket binary frames.
     void binaryAudioReceived(const QString& userId, const QByteArray& pcm16Payload);
 
-private slots:
-    void onConnected();
-    void onTextMessageReceived(const QString& message);
-    void onBinaryMessageReceived(const QByteArray& message);
-    void onSslErrors(const QList<QSslError>& errors);
+    void outboxChanged(const Outbox::Stats& stats);
 
 private:
-    void sendJson(const QJsonObject& payload);
-
-    void handleLoginSuccess(const QJsonObject& data);
-    void handleChatHistory(const QJsonObject& data);
-    void handleMessage(const QJsonObject& data);
-    void handleUserListUpdate(const QJsonObject& data);
-    void handleNewChat(const QJsonObject& data);
-    void handleMessageSeenUpdate(const QJsonObject& data);
-    void handleMessageUpdated(const QJsonObject& data);
-    void handleMessageDeleted(const QJsonObject& data);
-    void handlePresenceUpdate(const QJsonObject& data);
-    void handleTyping(const QJsonObject& data);
-    void handleChannelInfo(const QJsonObject& data);
-    void handleMemberJoined(const QJsonObject& data);
-    void handleMessagePinned(const QJsonObject& data);
-    void handleMessageUnpinned(const QJsonObject& data);
-    void handlePasswordChanged(const QJsonObject& data);
-    void handleVoiceChatUpdate(const QJsonObject& data);
-    void handleIncomingCall(const QJsonObject& data);
-    void handleUserUpdated(const QJsonObject& data);
-
-    static QJsonObject parseContentObject(const QJsonValue& contentValue);
-    static Message parseMessageObject(const QJsonObject& obj);
-    static User parseUserObject(const QJsonObject& obj);
-    static Chat parseChatObject(const QJsonObject& obj);
-    static QString extractMessageText(const QJsonObject& contentObj);
-    static FileAttachment parseFileAttachment(const QJsonValue& value);
-    static ForwardedInfo parseForwardedInfo(const QJsonValue& value);
-    static VoiceChatParticipants parseVoiceParticipantsMap(const QJsonObject& value);
-
-    QWebSocket m_webSocket;
+    template <typename Fn>
+    void post(Fn&& fn);
+    void flushSeenReceipts();
+
+    QThread* m_thread = nullptr;
+    WebSocketWorker* m_worker = nullptr;
+
+    QTimer* m_seenFlushTimer = nullptr;
+    QHash<QString, QStringList> m_pendingSeenByChat;
+    QSet<QString> m_pendingSeenIds;
+
+    // Mirrors of worker state so GUI code can read them without crossing threads.
+    bool m_connected = false;
     User m_currentUser;
     QString m_token;
     qint64 m_tokenExpiresAt = 0;
+    Outbox::Stats m_outboxStats;
 };
 
 #endif // WEBSOCKETCLIENT_H
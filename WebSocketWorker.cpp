@@ -0,0 +1,956 @@
+#include "WebSocketWorker.h"
+
+#include "AppConfig.h"
+#include "Metrics.h"
+#include "Trace.h"
+
+#include <QElapsedTimer>
+#include <QNetworkRequest>
+#include <QJsonValue>
+#include <QJsonParseError>
+#include <QSet>
+#include <QSslError>
+#include <QStringList>
+#include <QTimer>
+#include <QVariant>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <utility>
+
+namespace {
+// Unacknowledged operations allowed on the wire at once.
+constexpr int kOutboxMaxInFlight = 4;
+// An operation without an echo after this long is written again; the
+// idempotency key makes the duplicate harmless.
+constexpr qint64 kOutboxResendAfterMs = 15000;
+constexpr int kOutboxRetryIntervalMs = 5000;
+// Full histories with more chats than this are emitted progressively.
+constexpr int kChatHistoryBatchSize = 25;
+
+QJsonObject parsePossiblyNestedJsonObjectString(const QString& input)
+{
+    QString raw = input.trimmed();
+    for (int depth = 0; depth < 3 && !raw.isEmpty(); ++depth) {
+        QJsonParseError error;
+        const QJsonDocument parsed = QJsonDocument::fromJson(raw.toUtf8(), &error);
+        if (error.error != QJsonParseError::NoError) {
+            return QJsonObject();
+        }
+        if (parsed.isObject()) {
+            return parsed.object();
+        }
+        if (parsed.isArray()) {
+            return QJsonObject();
+        }
+        if (parsed.isNull()) {
+            return QJsonObject();
+        }
+
+        // Some backends double-encode JSON: first parse yields a JSON string.
+        const QVariant variant = parsed.toVariant();
+        if (variant.type() == QVariant::String) {
+            const QString nested = variant.toString().trimmed();
+            if (nested == raw) {
+                return QJsonObject();
+            }
+            raw = nested;
+            continue;
+        }
+        return QJsonObject();
+    }
+    return QJsonObject();
+}
+}
+
+WebSocketWorker::WebSocketWorker(QObject* parent)
+    : QObject(parent)
+{
+}
+
+void WebSocketWorker::start()
+{
+    Trace::setThreadName("NoveoNetwork");
+    // Created here rather than in the constructor so the socket and its
+    // internal timers belong to the network thread.
+    m_webSocket = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this);
+    connect(m_webSocket, &QWebSocket::connected, this, &WebSocketWorker::onConnected);
+    connect(m_webSocket, &QWebSocket::disconnected, this, &WebSocketWorker::onDisconnected);
+    connect(m_webSocket, &QWebSocket::textMessageReceived, this, &WebSocketWorker::onTextMessageReceived);
+    connect(m_webSocket, &QWebSocket::binaryMessageReceived, this, &WebSocketWorker::onBinaryMessageReceived);
+    connect(m_webSocket, &QWebSocket::sslErrors, this, &WebSocketWorker::onSslErrors);
+
+    m_outboxRetryTimer = new QTimer(this);
+    m_outboxRetryTimer->setInterval(kOutboxRetryIntervalMs);
+    connect(m_outboxRetryTimer, &QTimer::timeout, this, [this]() {
+        m_outbox.requeueInFlight(kOutboxResendAfterMs);
+        flushOutbox();
+    });
+}
+
+void WebSocketWorker::connectToServer()
+{
+    QNetworkRequest request(AppConfig::websocketUrl());
+    request.setRawHeader("Origin", "https://noveo.ir");
+    m_webSocket->open(request);
+}
+
+void WebSocketWorker::disconnectFromServer()
+{
+    m_webSocket->close();
+}
+
+void WebSocketWorker::login(const QString& username, const QString& password)
+{
+    sendJson(QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("login_with_password")},
+        {QStringLiteral("username"), username},
+        {QStringLiteral("password"), password},
+    });
+}
+
+void WebSocketWorker::registerUser(const QString& username, const QString& password)
+{
+    sendJson(QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("register")},
+        {QStringLiteral("username"), username},
+        {QStringLiteral("password"), password},
+    });
+}
+
+void WebSocketWorker::reconnectWithToken(const QString& userId, const QString& token, const QHash<QString, qint64>& syncCursors)
+{
+    QJsonObject payload{
+        {QStringLiteral("type"), QStringLiteral("reconnect")},
+        {QStringLiteral("userId"), userId},
+        {QStringLiteral("token"), token},
+    };
+    if (!syncCursors.isEmpty()) {
+        QJsonObject since;
+        for (auto it = syncCursors.constBegin(); it != syncCursors.constEnd(); ++it) {
+            since.insert(it.key(), static_cast<double>(it.value()));
+        }
+        payload.insert(QStringLiteral("since"), since);
+    }
+    sendJson(payload);
+}
+
+void WebSocketWorker::sendMessage(const QString& chatId, const QString& text, const QString& replyToId, const QString& clientMessageId)
+{
+    QJsonObject content;
+    content.insert(QStringLiteral("text"), text);
+    content.insert(QStringLiteral("file"), QJsonValue::Null);
+    content.insert(QStringLiteral("theme"), QJsonValue::Null);
+
+    QString recipientId;
+    if (chatId.startsWith(QStringLiteral("temp_"))) {
+        recipientId = chatId.mid(5);
+    } else if (chatId.contains('_')) {
+        const QStringList ids = chatId.split('_', Qt::SkipEmptyParts);
+        if (ids.size() == 2) {
+            recipientId = (ids[0] == m_currentUser.userId) ? ids[1] : ids[0];
+        }
+    }
+    sendMessagePayload(chatId, content, replyToId, recipientId, clientMessageId);
+}
+
+void WebSocketWorker::sendMessagePayload(const QString& chatId,
+                                         const QJsonObject& content,
+                                         const QString& replyToId,
+                                         const QString& recipientId,
+                                         const QString& clientMessageId)
+{
+    QJsonObject payload;
+    payload.insert(QStringLiteral("type"), QStringLiteral("message"));
+    payload.insert(QStringLiteral("content"), content);
+
+    if (!recipientId.isEmpty()) {
+        payload.insert(QStringLiteral("recipientId"), recipientId);
+    } else {
+        payload.insert(QStringLiteral("chatId"), chatId);
+    }
+
+    if (replyToId.isEmpty()) {
+        payload.insert(QStringLiteral("replyToId"), QJsonValue::Null);
+    } else {
+        payload.insert(QStringLiteral("replyToId"), replyToId);
+    }
+    payload.insert(QStringLiteral("clientMessageId"), clientMessageId);
+    queueOperation(clientMessageId, payload);
+}
+
+void WebSocketWorker::fetchHistory(const QString& chatId, qint64 beforeTimestamp)
+{
+    sendJson(QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("get_history")},
+        {QStringLiteral("chatId"), chatId},
+        {QStringLiteral("before"), static_cast<double>(beforeTimestamp)},
+    });
+}
+
+void WebSocketWorker::sendMessageSeen(const QString& chatId, const QString& messageId)
+{
+    sendJson(QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("message_seen")},
+        {QStringLiteral("chatId"), chatId},
+        {QStringLiteral("messageId"), messageId},
+    });
+}
+
+void WebSocketWorker::sendMessagesSeen(const QString& chatId, const QStringList& messageIds)
+{
+    if (messageIds.isEmpty()) {
+        return;
+    }
+    if (!m_supportsSeenBatch) {
+        for (const QString& messageId : messageIds) {
+            sendMessageSeen(chatId, messageId);
+        }
+        return;
+    }
+    sendJson(QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("message_seen_batch")},
+        {QStringLiteral("chatId"), chatId},
+        {QStringLiteral("messageIds"), QJsonArray::fromStringList(messageIds)},
+        {QStringLiteral("upToMessageId"), messageIds.last()},
+    });
+}
+
+void WebSocketWorker::editMessage(const QString& chatId, const QString& messageId, const QString& newText, const QString& clientMessageId)
+{
+    queueOperation(clientMessageId, QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("edit_message")},
+        {QStringLiteral("chatId"), chatId},
+        {QStringLiteral("messageId"), messageId},
+        {QStringLiteral("newContent"), newText},
+        {QStringLiteral("clientMessageId"), clientMessageId},
+    });
+}
+
+void WebSocketWorker::deleteMessage(const QString& chatId, const QString& messageId, const QString& clientMessageId)
+{
+    queueOperation(clientMessageId, QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("delete_message")},
+        {QStringLiteral("chatId"), chatId},
+        {QStringLiteral("messageId"), messageId},
+        {QStringLiteral("clientMessageId"), clientMessageId},
+    });
+}
+
+void WebSocketWorker::sendTyping(const QString& chatId)
+{
+    sendJson(QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("typing")},
+        {QStringLiteral("chatId"), chatId},
+    });
+}
+
+void WebSocketWorker::joinChannel(const QString& chatId)
+{
+    sendJson(QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("join_channel")},
+        {QStringLiteral("chatId"), chatId},
+    });
+}
+
+void WebSocketWorker::requestChannelByHandle(const QString& handle)
+{
+    sendJson(QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("get_channel_by_handle")},
+        {QStringLiteral("handle"), handle},
+    });
+}
+
+void WebSocketWorker::pinMessage(const QString& chatId, const QString& messageId)
+{
+    sendJson(QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("pin_message")},
+        {QStringLiteral("chatId"), chatId},
+        {QStringLiteral("messageId"), messageId},
+    });
+}
+
+void WebSocketWorker::unpinMessage(const QString& chatId)
+{
+    sendJson(QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("unpin_message")},
+        {QStringLiteral("chatId"), chatId},
+    });
+}
+
+void WebSocketWorker::updateUsername(const QString& username)
+{
+    sendJson(QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("update_username")},
+        {QStringLiteral("username"), username},
+    });
+}
+
+void WebSocketWorker::changePassword(const QString& oldPassword, const QString& newPassword)
+{
+    sendJson(QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("change_password")},
+        {QStringLiteral("oldPassword"), oldPassword},
+        {QStringLiteral("newPassword"), newPassword},
+    });
+}
+
+void WebSocketWorker::deleteAccount(const QString& password)
+{
+    sendJson(QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("delete_account")},
+        {QStringLiteral("password"), password},
+    });
+}
+
+void WebSocketWorker::voiceStart(const QString& chatId)
+{
+    sendJson(QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("voice_start")},
+        {QStringLiteral("chatId"), chatId},
+    });
+}
+
+void WebSocketWorker::voiceJoin(const QString& chatId)
+{
+    sendJson(QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("voice_join")},
+        {QStringLiteral("chatId"), chatId},
+    });
+}
+
+void WebSocketWorker::voiceLeave(const QString& chatId)
+{
+    sendJson(QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("voice_leave")},
+        {QStringLiteral("chatId"), chatId},
+    });
+}
+
+void WebSocketWorker::sendBinaryAudio(const QByteArray& audioPayload)
+{
+    if (!isConnected() || audioPayload.isEmpty()) {
+        return;
+    }
+    countOutgoing(m_webSocket->sendBinaryMessage(audioPayload));
+}
+
+void WebSocketWorker::logout()
+{
+    m_outbox.wipe();
+    emit outboxChanged(m_outbox.stats());
+    m_authenticated = false;
+    m_supportsSeenBatch = false;
+    m_supportsClientMessageId = false;
+    m_currentUser = User();
+    m_token.clear();
+    m_tokenExpiresAt = 0;
+    m_webSocket->close();
+}
+
+bool WebSocketWorker::isConnected() const
+{
+    return m_webSocket && m_webSocket->state() == QAbstractSocket::ConnectedState;
+}
+
+void WebSocketWorker::onConnected()
+{
+    emit connected();
+}
+
+void WebSocketWorker::onDisconnected()
+{
+    // Nothing written on the old connection is known to have arrived.
+    m_authenticated = false;
+    m_outboxRetryTimer->stop();
+    if (m_supportsClientMessageId) {
+        m_outbox.requeueInFlight();
+    }
+    emit outboxChanged(m_outbox.stats());
+    emit disconnected();
+}
+
+void WebSocketWorker::onTextMessageReceived(const QString& message)
+{
+    QElapsedTimer decodeTimer;
+    decodeTimer.start();
+    QJsonObject frame;
+    {
+        NOVEO_TRACE_SCOPE("ws.parse_json");
+        const QByteArray utf8 = message.toUtf8();
+        Metrics::add(Metrics::Counter::WsFramesIn);
+        Metrics::add(Metrics::Counter::WsBytesIn, static_cast<quint64>(utf8.size()));
+        const QJsonDocument doc = QJsonDocument::fromJson(utf8);
+        if (!doc.isObject()) {
+            return;
+        }
+        frame = doc.object();
+    }
+    dispatchFrame(frame, decodeTimer.nsecsElapsed());
+}
+
+void WebSocketWorker::dispatchFrame(const QJsonObject& obj, qint64 decodeNs)
+{
+    const ServerEvent event = serverEventFromType(obj.value(QStringLiteral("type")).toString());
+    NOVEO_TRACE_SCOPE(serverEventName(event));
+    QElapsedTimer handlerTimer;
+    handlerTimer.start();
+
+    // Echoes (and errors) for outbox operations carry their key back.
+    const QString clientMessageId = obj.value(QStringLiteral("clientMessageId")).toString();
+    if (!clientMessageId.isEmpty() && m_outbox.acknowledge(clientMessageId)) {
+        flushOutbox();
+    }
+
+    if (const EventHandler handler = handlerFor(event)) {
+        (this->*handler)(obj);
+    }
+    Metrics::recordEvent(event, decodeNs + handlerTimer.nsecsElapsed());
+}
+
+WebSocketWorker::EventHandler WebSocketWorker::handlerFor(ServerEvent event)
+{
+    using Table = std::array<EventHandler, static_cast<size_t>(ServerEvent::Count)>;
+    static const Table handlers = []() {
+        Table table{};
+        const auto set = [&table](ServerEvent e, EventHandler handler) { table[static_cast<size_t>(e)] = handler; };
+        set(ServerEvent::LoginSuccess, &WebSocketWorker::handleLoginSuccess);
+        set(ServerEvent::AuthFailed, &WebSocketWorker::handleAuthFailed);
+        set(ServerEvent::ChatHistory, &WebSocketWorker::handleChatHistory);
+        set(ServerEvent::Message, &WebSocketWorker::handleMessage);
+        set(ServerEvent::UserListUpdate, &WebSocketWorker::handleUserListUpdate);
+        set(ServerEvent::NewChatInfo, &WebSocketWorker::handleNewChat);
+        set(ServerEvent::MessageSeenUpdate, &WebSocketWorker::handleMessageSeenUpdate);
+        set(ServerEvent::MessageUpdated, &WebSocketWorker::handleMessageUpdated);
+        set(ServerEvent::MessageDeleted, &WebSocketWorker::handleMessageDeleted);
+        set(ServerEvent::PresenceUpdate, &WebSocketWorker::handlePresenceUpdate);
+        set(ServerEvent::Typing, &WebSocketWorker::handleTyping);
+        set(ServerEvent::ChannelInfo, &WebSocketWorker::handleChannelInfo);
+        set(ServerEvent::MemberJoined, &WebSocketWorker::handleMemberJoined);
+        set(ServerEvent::MessagePinned, &WebSocketWorker::handleMessagePinned);
+        set(ServerEvent::MessageUnpinned, &WebSocketWorker::handleMessageUnpinned);
+        set(ServerEvent::PasswordChanged, &WebSocketWorker::handlePasswordChanged);
+        set(ServerEvent::VoiceChatUpdate, &WebSocketWorker::handleVoiceChatUpdate);
+        set(ServerEvent::IncomingCall, &WebSocketWorker::handleIncomingCall);
+        set(ServerEvent::UserUpdated, &WebSocketWorker::handleUserUpdated);
+        set(ServerEvent::Error, &WebSocketWorker::handleError);
+        return table;
+    }();
+    return handlers[static_cast<size_t>(event)];
+}
+
+void WebSocketWorker::onBinaryMessageReceived(const QByteArray& message)
+{
+    if (message.isEmpty()) {
+        return;
+    }
+    Metrics::add(Metrics::Counter::WsFramesIn);
+    Metrics::add(Metrics::Counter::WsBytesIn, static_cast<quint64>(message.size()));
+
+    const quint8 userIdLength = static_cast<quint8>(message.at(0));
+    if (message.size() < 1 + userIdLength) {
+        return;
+    }
+
+    const QString userId = QString::fromUtf8(message.mid(1, userIdLength));
+    const QByteArray audioPayload = message.mid(1 + userIdLength);
+    if (userId.isEmpty() || audioPayload.isEmpty()) {
+        return;
+    }
+    emit binaryAudioReceived(userId, audioPayload);
+}
+
+void WebSocketWorker::onSslErrors(const QList<QSslError>& errors)
+{
+    Q_UNUSED(errors);
+    m_webSocket->ignoreSslErrors();
+}
+
+void WebSocketWorker::sendJson(const QJsonObject& payload)
+{
+    if (!isConnected()) {
+        return;
+    }
+    const QByteArray json = QJsonDocument(payload).toJson(QJsonDocument::Compact);
+    m_webSocket->sendTextMessage(QString::fromUtf8(json));
+    countOutgoing(json.size());
+}
+
+void WebSocketWorker::countOutgoing(qint64 bytes)
+{
+    Metrics::add(Metrics::Counter::WsFramesOut);
+    Metrics::add(Metrics::Counter::WsBytesOut, static_cast<quint64>(qMax<qint64>(0, bytes)));
+}
+
+void WebSocketWorker::queueOperation(const QString& key, const QJsonObject& payload)
+{
+    m_outbox.enqueue(key, payload);
+    flushOutbox();
+}
+
+void WebSocketWorker::flushOutbox()
+{
+    if (m_authenticated && isConnected()) {
+        if (m_supportsClientMessageId) {
+            for (const QJsonObject& payload : m_outbox.takeSendable(kOutboxMaxInFlight)) {
+                sendJson(payload);
+            }
+        } else {
+            // No echo will ever name the key, so a successful write is the
+            // best delivery signal available; nothing is resent.
+            for (const QJsonObject& payload : m_outbox.takeSendable(std::numeric_limits<int>::max())) {
+                sendJson(payload);
+            }
+            m_outbox.acknowledgeInFlight();
+        }
+    }
+    emit outboxChanged(m_outbox.stats());
+}
+
+void WebSocketWorker::handleLoginSuccess(const QJsonObject& data)
+{
+    m_currentUser = parseUserObject(data.value(QStringLiteral("user")).toObject());
+    m_token = data.value(QStringLiteral("token")).toString();
+    m_tokenExpiresAt = static_cast<qint64>(data.value(QStringLiteral("expiresAt")).toDouble());
+    const QJsonArray features = data.value(QStringLiteral("features")).toArray();
+    m_supportsSeenBatch = features.contains(QStringLiteral("message_seen_batch"));
+    m_supportsClientMessageId = features.contains(QStringLiteral("client_message_id"));
+    m_authenticated = true;
+    if (!m_currentUser.userId.isEmpty()) {
+        m_outbox.open(m_currentUser.userId);
+    }
+    emit loginSuccess(m_currentUser, m_token, m_tokenExpiresAt);
+
+    if (m_supportsClientMessageId) {
+        m_outboxRetryTimer->start();
+    }
+    flushOutbox();
+}
+
+void WebSocketWorker::handleChatHistory(const QJsonObject& data)
+{
+    const QJsonArray chatsArray = data.value(QStringLiteral("chats")).toArray();
+    const bool delta = data.value(QStringLiteral("delta")).toBool();
+    if (!delta && chatsArray.size() > kChatHistoryBatchSize) {
+        emitChatHistoryInBatches(chatsArray);
+    } else {
+        std::vector<Chat> chats;
+        chats.reserve(static_cast<size_t>(chatsArray.size()));
+        for (const QJsonValue& value : chatsArray) {
+            chats.push_back(parseChatObject(value.toObject()));
+        }
+        if (delta) {
+            emit chatDeltaReceived(chats);
+        } else {
+            emit chatHistoryReceived(chats);
+        }
+    }
+
+    if (data.contains(QStringLiteral("activeVoiceChats"))) {
+        emit voiceChatUpdated(parseVoiceParticipantsMap(data.value(QStringLiteral("activeVoiceChats")).toObject()));
+    }
+}
+
+void WebSocketWorker::emitChatHistoryInBatches(const QJsonArray& chatsArray)
+{
+    // Most recently active first, judged by each chat's last message without
+    // parsing the chat itself.
+    std::vector<std::pair<qint64, int>> order;
+    order.reserve(static_cast<size_t>(chatsArray.size()));
+    for (int i = 0; i < chatsArray.size(); ++i) {
+        const QJsonArray messages = chatsArray.at(i).toObject().value(QStringLiteral("messages")).toArray();
+        const qint64 lastActivity = messages.isEmpty()
+                                        ? 0
+                                        : static_cast<qint64>(messages.last().toObject().value(QStringLiteral("timestamp")).toDouble());
+        order.emplace_back(lastActivity, i);
+    }
+    std::stable_sort(order.begin(), order.end(), [](const std::pair<qint64, int>& a, const std::pair<qint64, int>& b) {
+        return a.first > b.first;
+    });
+
+    // Each batch is queued to the GUI thread as soon as it is parsed, so the
+    // sidebar fills while the rest is still being decoded here.
+    std::vector<Chat> batch;
+    batch.reserve(kChatHistoryBatchSize);
+    bool first = true;
+    for (size_t n = 0; n < order.size(); ++n) {
+        batch.push_back(parseChatObject(chatsArray.at(order[n].second).toObject()));
+        const bool last = (n + 1 == order.size());
+        if (static_cast<int>(batch.size()) == kChatHistoryBatchSize || last) {
+            emit chatHistoryBatchReceived(batch, first, last);
+            batch.clear();
+            first = false;
+        }
+    }
+}
+
+void WebSocketWorker::handleAuthFailed(const QJsonObject& data)
+{
+    emit authFailed(data.value(QStringLiteral("message")).toString());
+}
+
+void WebSocketWorker::handleError(const QJsonObject& data)
+{
+    emit errorOccurred(data.value(QStringLiteral("message")).toString());
+}
+
+void WebSocketWorker::handleMessage(const QJsonObject& data)
+{
+    emit messageReceived(parseMessageObject(data));
+}
+
+void WebSocketWorker::handleUserListUpdate(const QJsonObject& data)
+{
+    std::vector<User> users;
+    const QJsonArray usersArr = data.value(QStringLiteral("users")).toArray();
+    users.reserve(static_cast<size_t>(usersArr.size()));
+
+    QSet<QString> onlineUsers;
+    const QJsonArray onlineArr = data.value(QStringLiteral("online")).toArray();
+    for (const QJsonValue& onlineVal : onlineArr) {
+        onlineUsers.insert(onlineVal.toString());
+    }
+
+    for (const QJsonValue& userVal : usersArr) {
+        User user = parseUserObject(userVal.toObject());
+        if (!onlineUsers.isEmpty()) {
+            user.online = onlineUsers.contains(user.userId);
+        }
+        users.push_back(user);
+    }
+    emit userListUpdated(users);
+}
+
+void WebSocketWorker::handleNewChat(const QJsonObject& data)
+{
+    emit newChatCreated(parseChatObject(data.value(QStringLiteral("chat")).toObject()));
+}
+
+void WebSocketWorker::handleMessageSeenUpdate(const QJsonObject& data)
+{
+    emit messageSeenUpdate(data.value(QStringLiteral("chatId")).toString(),
+                           data.value(QStringLiteral("messageId")).toString(),
+                           data.value(QStringLiteral("userId")).toString());
+}
+
+void WebSocketWorker::handleMessageUpdated(const QJsonObject& data)
+{
+    Message edited;
+    applyContent(parseContentObject(data.value(QStringLiteral("newContent"))), &edited);
+    unwrapSerializedText(&edited);
+    emit messageUpdated(data.value(QStringLiteral("chatId")).toString(),
+                        data.value(QStringLiteral("messageId")).toString(),
+                        edited.text,
+                        static_cast<qint64>(data.value(QStringLiteral("editedAt")).toDouble()));
+}
+
+void WebSocketWorker::handleMessageDeleted(const QJsonObject& data)
+{
+    emit messageDeleted(data.value(QStringLiteral("chatId")).toString(),
+                        data.value(QStringLiteral("messageId")).toString());
+}
+
+void WebSocketWorker::handlePresenceUpdate(const QJsonObject& data)
+{
+    emit presenceUpdated(data.value(QStringLiteral("userId")).toString(),
+                         data.value(QStringLiteral("online")).toBool());
+}
+
+void WebSocketWorker::handleTyping(const QJsonObject& data)
+{
+    emit typingReceived(data.value(QStringLiteral("chatId")).toString(),
+                        data.value(QStringLiteral("senderId")).toString());
+}
+
+void WebSocketWorker::handleChannelInfo(const QJsonObject& data)
+{
+    emit channelInfoReceived(parseChatObject(data.value(QStringLiteral("channel")).toObject()));
+}
+
+void WebSocketWorker::handleMemberJoined(const QJsonObject& data)
+{
+    QStringList members;
+    const QJsonArray membersArr = data.value(QStringLiteral("members")).toArray();
+    for (const QJsonValue& member : membersArr) {
+        members.push_back(member.toString());
+    }
+    emit memberJoined(data.value(QStringLiteral("chatId")).toString(), members);
+}
+
+void WebSocketWorker::handleMessagePinned(const QJsonObject& data)
+{
+    emit messagePinned(data.value(QStringLiteral("chatId")).toString(),
+                       parseMessageObject(data.value(QStringLiteral("message")).toObject()));
+}
+
+void WebSocketWorker::handleMessageUnpinned(const QJsonObject& data)
+{
+    emit messageUnpinned(data.value(QStringLiteral("chatId")).toString());
+}
+
+void WebSocketWorker::handlePasswordChanged(const QJsonObject& data)
+{
+    const QString token = data.value(QStringLiteral("token")).toString();
+    const qint64 expiresAt = static_cast<qint64>(data.value(QStringLiteral("expiresAt")).toDouble());
+    const QString warning = data.value(QStringLiteral("warning")).toString();
+    if (!token.isEmpty()) {
+        m_token = token;
+    }
+    if (expiresAt > 0) {
+        m_tokenExpiresAt = expiresAt;
+    }
+    emit passwordChanged(m_token, m_tokenExpiresAt, warning);
+}
+
+void WebSocketWorker::handleVoiceChatUpdate(const QJsonObject& data)
+{
+    emit voiceChatUpdated(parseVoiceParticipantsMap(data.value(QStringLiteral("activeVoiceChats")).toObject()));
+}
+
+void WebSocketWorker::handleIncomingCall(const QJsonObject& data)
+{
+    emit incomingCall(data.value(QStringLiteral("chatId")).toString(),
+                      data.value(QStringLiteral("callerId")).toString(),
+                      data.value(QStringLiteral("chatName")).toString(),
+                      data.value(QStringLiteral("callerName")).toString(),
+                      data.value(QStringLiteral("callerAvatar")).toString());
+}
+
+void WebSocketWorker::handleUserUpdated(const QJsonObject& data)
+{
+    emit userUpdated(parseUserObject(data));
+}
+
+QJsonObject WebSocketWorker::parseContentObject(const QJsonValue& contentValue)
+{
+    if (contentValue.isObject()) {
+        return contentValue.toObject();
+    }
+    if (contentValue.isString()) {
+        const QString raw = contentValue.toString();
+        const QJsonObject parsedObj = parsePossiblyNestedJsonObjectString(raw);
+        if (!parsedObj.isEmpty()) {
+            return parsedObj;
+        }
+        QJsonObject fallback;
+        fallback.insert(QStringLiteral("text"), raw);
+        return fallback;
+    }
+    return QJsonObject();
+}
+
+Message WebSocketWorker::parseMessageObject(const QJsonObject& obj)
+{
+    Message msg;
+    msg.messageId = obj.value(QStringLiteral("messageId")).toString();
+    msg.chatId = obj.value(QStringLiteral("chatId")).toString();
+    msg.senderId = obj.value(QStringLiteral("senderId")).toString();
+    msg.clientMessageId = obj.value(QStringLiteral("clientMessageId")).toString();
+    msg.senderName = obj.value(QStringLiteral("senderName")).toString();
+    if (msg.senderName.isEmpty()) {
+        msg.senderName = obj.value(QStringLiteral("username")).toString();
+    }
+    msg.senderAvatarUrl = obj.value(QStringLiteral("senderAvatarUrl")).toString();
+    if (msg.senderAvatarUrl.isEmpty()) {
+        msg.senderAvatarUrl = obj.value(QStringLiteral("senderAvatar")).toString();
+    }
+    if (msg.senderAvatarUrl.isEmpty()) {
+        msg.senderAvatarUrl = obj.value(QStringLiteral("avatarUrl")).toString();
+    }
+    const QJsonObject senderObj = obj.value(QStringLiteral("sender")).toObject();
+    if (!senderObj.isEmpty()) {
+        if (msg.senderId.isEmpty()) {
+            msg.senderId = senderObj.value(QStringLiteral("userId")).toString();
+        }
+        if (msg.senderName.isEmpty()) {
+            msg.senderName = senderObj.value(QStringLiteral("username")).toString();
+        }
+        if (msg.senderName.isEmpty()) {
+            msg.senderName = senderObj.value(QStringLiteral("name")).toString();
+        }
+        if (msg.senderAvatarUrl.isEmpty()) {
+            msg.senderAvatarUrl = senderObj.value(QStringLiteral("avatarUrl")).toString();
+        }
+    }
+    msg.timestamp = static_cast<qint64>(obj.value(QStringLiteral("timestamp")).toDouble());
+    msg.editedAt = static_cast<qint64>(obj.value(QStringLiteral("editedAt")).toDouble());
+    msg.replyToId = obj.value(QStringLiteral("replyToId")).toString();
+
+    applyContent(parseContentObject(obj.value(QStringLiteral("content"))), &msg);
+
+    // Legacy/fallback payload support: content fields may be at top level.
+    if (msg.text.isEmpty() && obj.value(QStringLiteral("text")).isString()) {
+        msg.text = obj.value(QStringLiteral("text")).toString();
+    }
+    if (msg.file.isNull() && obj.contains(QStringLiteral("file"))) {
+        msg.file = parseFileAttachment(obj.value(QStringLiteral("file")));
+    }
+    if (msg.theme.isEmpty() && obj.value(QStringLiteral("theme")).isString()) {
+        msg.theme = obj.value(QStringLiteral("theme")).toString();
+    }
+
+    unwrapSerializedText(&msg);
+
+    if (obj.contains(QStringLiteral("seenBy")) && obj.value(QStringLiteral("seenBy")).isArray()) {
+        const QJsonArray seenByArr = obj.value(QStringLiteral("seenBy")).toArray();
+        for (const QJsonValue& val : seenByArr) {
+            msg.seenBy.append(val.toString());
+        }
+    }
+
+    if (msg.text.isEmpty() && !msg.file.isNull()) {
+        msg.text = msg.file.name.isEmpty() ? QStringLiteral("[Attachment]") : QStringLiteral("[%1]").arg(msg.file.name);
+    }
+    return msg;
+}
+
+User WebSocketWorker::parseUserObject(const QJsonObject& obj)
+{
+    User user;
+    user.userId = obj.value(QStringLiteral("userId")).toString();
+    user.username = obj.value(QStringLiteral("username")).toString();
+    user.avatarUrl = obj.value(QStringLiteral("avatarUrl")).toString();
+    user.online = obj.value(QStringLiteral("online")).toBool(false);
+    user.blockGroupInvites = obj.value(QStringLiteral("blockGroupInvites")).toBool(false);
+    return user;
+}
+
+Chat WebSocketWorker::parseChatObject(const QJsonObject& obj)
+{
+    Chat chat;
+    chat.chatId = obj.value(QStringLiteral("chatId")).toString();
+    chat.chatName = obj.value(QStringLiteral("chatName")).toString();
+    if (chat.chatName.isEmpty()) {
+        chat.chatName = obj.value(QStringLiteral("name")).toString();
+    }
+    chat.chatType = obj.value(QStringLiteral("chatType")).toString();
+    chat.ownerId = obj.value(QStringLiteral("ownerId")).toString();
+    chat.handle = obj.value(QStringLiteral("handle")).toString();
+    chat.avatarUrl = obj.value(QStringLiteral("avatarUrl")).toString();
+    chat.unreadCount = obj.value(QStringLiteral("unreadCount")).toInt(0);
+    chat.isVerified = obj.value(QStringLiteral("isVerified")).toBool(false);
+    chat.createdAt = static_cast<qint64>(obj.value(QStringLiteral("created_at")).toDouble());
+    if (chat.createdAt <= 0) {
+        chat.createdAt = static_cast<qint64>(obj.value(QStringLiteral("createdAt")).toDouble());
+    }
+
+    const QJsonArray members = obj.value(QStringLiteral("members")).toArray();
+    for (const QJsonValue& member : members) {
+        chat.members.append(member.toString());
+    }
+
+    const QJsonArray messages = obj.value(QStringLiteral("messages")).toArray();
+    chat.messages.reserve(static_cast<size_t>(messages.size()));
+    for (const QJsonValue& value : messages) {
+        Message msg = parseMessageObject(value.toObject());
+        if (msg.chatId.isEmpty()) {
+            msg.chatId = chat.chatId;
+        }
+        chat.upsertMessage(msg);
+    }
+
+    if (obj.contains(QStringLiteral("pinnedMessage")) && obj.value(QStringLiteral("pinnedMessage")).isObject()) {
+        chat.hasPinnedMessage = true;
+        chat.pinnedMessage = parseMessageObject(obj.value(QStringLiteral("pinnedMessage")).toObject());
+        if (chat.pinnedMessage.chatId.isEmpty()) {
+            chat.pinnedMessage.chatId = chat.chatId;
+        }
+    }
+    return chat;
+}
+
+void WebSocketWorker::applyContent(const QJsonObject& contentObj, Message* msg)
+{
+    msg->text = extractMessageText(contentObj);
+    msg->file = parseFileAttachment(contentObj.value(QStringLiteral("file")));
+    msg->theme = contentObj.value(QStringLiteral("theme")).toString();
+    msg->forwardedInfo = parseForwardedInfo(contentObj.value(QStringLiteral("forwardedInfo")));
+}
+
+void WebSocketWorker::unwrapSerializedText(Message* msg)
+{
+    msg->text = msg->text.trimmed();
+    // Only a JSON object or a JSON-encoded string can hide a content
+    // object; everything else is returned without touching the parser.
+    if (!msg->text.startsWith(QLatin1Char('{')) && !msg->text.startsWith(QLatin1Char('"'))) {
+        return;
+    }
+    const QJsonObject nestedContent = parsePossiblyNestedJsonObjectString(msg->text);
+    if (nestedContent.isEmpty() ||
+        !(nestedContent.contains(QStringLiteral("text")) ||
+          nestedContent.contains(QStringLiteral("file")) ||
+          nestedContent.contains(QStringLiteral("theme")))) {
+        return;
+    }
+    const QJsonValue nestedText = nestedContent.value(QStringLiteral("text"));
+    if (nestedText.isString()) {
+        msg->text = nestedText.toString().trimmed();
+    } else if (nestedText.isBool() || nestedText.isDouble()) {
+        msg->text = nestedText.toVariant().toString().trimmed();
+    } else {
+        msg->text.clear();
+    }
+    if (nestedContent.contains(QStringLiteral("file"))) {
+        msg->file = parseFileAttachment(nestedContent.value(QStringLiteral("file")));
+    }
+    msg->theme = nestedContent.value(QStringLiteral("theme")).toString();
+    msg->forwardedInfo = parseForwardedInfo(nestedContent.value(QStringLiteral("forwardedInfo")));
+}
+
+QString WebSocketWorker::extractMessageText(const QJsonObject& contentObj)
+{
+    const QJsonValue textValue = contentObj.value(QStringLiteral("text"));
+    if (textValue.isString()) {
+        return textValue.toString();
+    }
+    return QString();
+}
+
+FileAttachment WebSocketWorker::parseFileAttachment(const QJsonValue& value)
+{
+    FileAttachment file;
+    if (value.isObject()) {
+        const QJsonObject obj = value.toObject();
+        file.url = obj.value(QStringLiteral("url")).toString();
+        file.name = obj.value(QStringLiteral("name")).toString();
+        file.type = obj.value(QStringLiteral("type")).toString();
+        file.size = static_cast<qint64>(obj.value(QStringLiteral("size")).toDouble());
+    } else if (value.isString()) {
+        file.url = value.toString();
+    }
+    return file;
+}
+
+ForwardedInfo WebSocketWorker::parseForwardedInfo(const QJsonValue& value)
+{
+    ForwardedInfo info;
+    if (!value.isObject()) {
+        return info;
+    }
+    const QJsonObject obj = value.toObject();
+    info.from = obj.value(QStringLiteral("from")).toString();
+    info.originalTs = static_cast<qint64>(obj.value(QStringLiteral("originalTs")).toDouble());
+    return info;
+}
+
+VoiceChatParticipants WebSocketWorker::parseVoiceParticipantsMap(const QJsonObject& value)
+{
+    VoiceChatParticipants result;
+    for (auto it = value.constBegin(); it != value.constEnd(); ++it) {
+        QStringList participants;
+        if (it.value().isObject()) {
+            const QJsonArray arr = it.value().toObject().value(QStringLiteral("participants")).toArray();
+            for (const QJsonValue& participant : arr) {
+                participants.push_back(participant.toString());
+            }
+        } else if (it.value().isArray()) {
+            const QJsonArray arr = it.value().toArray();
+            for (const QJsonValue& participant : arr) {
+                participants.push_back(participant.toString());
+            }
+        }
+        result.insert(it.key(), participants);
+    }
+    return result;
+}
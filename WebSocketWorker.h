@@ -0,0 +1,181 @@
+#ifndef WEBSOCKETWORKER_H
+#define WEBSOCKETWORKER_H
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QObject>
+#include <QSslError>
+#include <QUrl>
+#include <QWebSocket>
+
+#include "DataStructures.h"
+#include "Outbox.h"
+#include "ServerEvent.h"
+
+class QTimer;
+
+// Owns the websocket and decodes every server frame. Lives on the network
+// thread behind WebSocketClient; only fully parsed structs leave it.
+class WebSocketWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WebSocketWorker(QObject* parent = nullptr);
+
+public slots:
+    void start();
+
+public:
+    void connectToServer();
+    void disconnectFromServer();
+
+    void login(const QString& username, const QString& password);
+    void registerUser(const QString& username, const QString& password);
+    void reconnectWithToken(const QString& userId, const QString& token, const QHash<QString, qint64>& syncCursors);
+
+    // Sends, edits and deletes go through the outbox under clientMessageId,
+    // so they survive disconnects and are resent until acknowledged.
+    void sendMessage(const QString& chatId, const QString& text, const QString& replyToId, const QString& clientMessageId);
+    void sendMessagePayload(const QString& chatId,
+                            const QJsonObject& content,
+                            const QString& replyToId,
+                            const QString& recipientId,
+                            const QString& clientMessageId);
+
+    void fetchHistory(const QString& chatId, qint64 beforeTimestamp);
+    void sendMessageSeen(const QString& chatId, const QString& messageId);
+    // One frame per chat when the server advertised batch receipts, otherwise
+    // falls back to a message_seen per id.
+    void sendMessagesSeen(const QString& chatId, const QStringList& messageIds);
+    void editMessage(const QString& chatId, const QString& messageId, const QString& newText, const QString& clientMessageId);
+    void deleteMessage(const QString& chatId, const QString& messageId, const QString& clientMessageId);
+
+    void sendTyping(const QString& chatId);
+    void joinChannel(const QString& chatId);
+    void requestChannelByHandle(const QString& handle);
+    void pinMessage(const QString& chatId, const QString& messageId);
+    void unpinMessage(const QString& chatId);
+
+    void updateUsername(const QString& username);
+    void changePassword(const QString& oldPassword, const QString& newPassword);
+    void deleteAccount(const QString& password);
+
+    void voiceStart(const QString& chatId);
+    void voiceJoin(const QString& chatId);
+    void voiceLeave(const QString& chatId);
+    void sendBinaryAudio(const QByteArray& audioPayload);
+
+    void logout();
+
+    bool isConnected() const;
+
+    // Routes one decoded control frame to its handler, exactly as frames
+    // read from the socket are. decodeNs is the time already spent turning
+    // the wire frame into obj.
+    void dispatchFrame(const QJsonObject& obj, qint64 decodeNs = 0);
+
+    // Frame payload -> model parsing; pure, so usable from any thread.
+    static QJsonObject parseContentObject(const QJsonValue& contentValue);
+    // Produces the fully normalized message (text, file, theme,
+    // forwardedInfo); nothing downstream parses content JSON again.
+    static Message parseMessageObject(const QJsonObject& obj);
+    static void applyContent(const QJsonObject& contentObj, Message* msg);
+    static void unwrapSerializedText(Message* msg);
+    static User parseUserObject(const QJsonObject& obj);
+    static Chat parseChatObject(const QJsonObject& obj);
+    static QString extractMessageText(const QJsonObject& contentObj);
+    static FileAttachment parseFileAttachment(const QJsonValue& value);
+    static ForwardedInfo parseForwardedInfo(const QJsonValue& value);
+    static VoiceChatParticipants parseVoiceParticipantsMap(const QJsonObject& value);
+
+signals:
+    void connected();
+    void disconnected();
+
+    void loginSuccess(const User& user, const QString& token, qint64 expiresAt);
+    void authFailed(const QString& message);
+
+    void chatHistoryReceived(const std::vector<Chat>& chats);
+    void chatDeltaReceived(const std::vector<Chat>& chats);
+    void chatHistoryBatchReceived(const std::vector<Chat>& chats, bool first, bool last);
+    void messageReceived(const Message& msg);
+    void userListUpdated(const std::vector<User>& users);
+    void errorOccurred(const QString& msg);
+    void newChatCreated(const Chat& chat);
+
+    void messageSeenUpdate(const QString& chatId, const QString& messageId, const QString& userId);
+    void messageUpdated(const QString& chatId, const QString& messageId, const QString& newContent, qint64 editedAt);
+    void messageDeleted(const QString& chatId, const QString& messageId);
+
+    void presenceUpdated(const QString& userId, bool online);
+    void typingReceived(const QString& chatId, const QString& senderId);
+    void channelInfoReceived(const Chat& channel);
+    void memberJoined(const QString& chatId, const QStringList& members);
+    void messagePinned(const QString& chatId, const Message& message);
+    void messageUnpinned(const QString& chatId);
+    void passwordChanged(const QString& token, qint64 expiresAt, const QString& warning);
+    void voiceChatUpdated(const VoiceChatParticipants& participantsByChat);
+    void incomingCall(const QString& chatId,
+                      const QString& callerId,
+                      const QString& chatName,
+                      const QString& callerName,
+                      const QString& callerAvatar);
+    void userUpdated(const User& user);
+
+    // PCM voice packet from websocket binary frames.
+    void binaryAudioReceived(const QString& userId, const QByteArray& pcm16Payload);
+
+    void outboxChanged(const Outbox::Stats& stats);
+
+private slots:
+    void onConnected();
+    void onDisconnected();
+    void onTextMessageReceived(const QString& message);
+    void onBinaryMessageReceived(const QByteArray& message);
+    void onSslErrors(const QList<QSslError>& errors);
+
+private:
+    void sendJson(const QJsonObject& payload);
+    void countOutgoing(qint64 bytes);
+    void queueOperation(const QString& key, const QJsonObject& payload);
+    void flushOutbox();
+
+    using EventHandler = void (WebSocketWorker::*)(const QJsonObject& data);
+    // Indexed by ServerEvent; null for Unknown.
+    static EventHandler handlerFor(ServerEvent event);
+
+    void handleLoginSuccess(const QJsonObject& data);
+    void handleAuthFailed(const QJsonObject& data);
+    void handleError(const QJsonObject& data);
+    void handleChatHistory(const QJsonObject& data);
+    void emitChatHistoryInBatches(const QJsonArray& chatsArray);
+    void handleMessage(const QJsonObject& data);
+    void handleUserListUpdate(const QJsonObject& data);
+    void handleNewChat(const QJsonObject& data);
+    void handleMessageSeenUpdate(const QJsonObject& data);
+    void handleMessageUpdated(const QJsonObject& data);
+    void handleMessageDeleted(const QJsonObject& data);
+    void handlePresenceUpdate(const QJsonObject& data);
+    void handleTyping(const QJsonObject& data);
+    void handleChannelInfo(const QJsonObject& data);
+    void handleMemberJoined(const QJsonObject& data);
+    void handleMessagePinned(const QJsonObject& data);
+    void handleMessageUnpinned(const QJsonObject& data);
+    void handlePasswordChanged(const QJsonObject& data);
+    void handleVoiceChatUpdate(const QJsonObject& data);
+    void handleIncomingCall(const QJsonObject& data);
+    void handleUserUpdated(const QJsonObject& data);
+
+    QWebSocket* m_webSocket = nullptr;
+    User m_currentUser;
+    QString m_token;
+    qint64 m_tokenExpiresAt = 0;
+    bool m_supportsSeenBatch = false;
+    bool m_supportsClientMessageId = false;
+    bool m_authenticated = false;
+    Outbox m_outbox;
+    QTimer* m_outboxRetryTimer = nullptr;
+};
+
+#endif // WEBSOCKETWORKER_H
@@ -0,0 +1,805 @@
+#include <QCborMap>
+#include <QCborValue>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QIcon>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QListWidget>
+#include <QPainter>
+#include <QPixmap>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QTimer>
+#include <QtTest>
+
+#include "DataStructures.h"
+#include "MainWindow.h"
+#include "MessageItemWidget.h"
+#include "ServerEvent.h"
+#include "Trace.h"
+#include "WebSocketWorker.h"
+
+// Benchmarks for the protocol and render hot paths, over synthetic corpora
+// generated deterministically from the row index. Run with a machine
+// readable logger to compare releases, e.g.
+//   noveo_bench -o results.xml,xml -o -,txt
+class NoveoBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void parseMessageObject_data();
+    void parseMessageObject();
+    void parseChatObject_data();
+    void parseChatObject();
+    void normalizeContent_data();
+    void normalizeContent();
+    void displayTextForMessage_data();
+    void displayTextForMessage();
+    void mergeHistory_data();
+    void mergeHistory();
+    void serverEventLookup_data();
+    void serverEventLookup();
+    void dispatchFrame();
+    void historyGuiStall_data();
+    void historyGuiStall();
+    void traceScope_data();
+    void traceScope();
+    void wireSize_data();
+    void wireSize();
+    void wireDecode_data();
+    void wireDecode();
+    void userListDelegatePaint_data();
+    void userListDelegatePaint();
+    void bubbleConstruction_data();
+    void bubbleConstruction();
+    void bubbleRebind_data();
+    void bubbleRebind();
+};
+
+namespace {
+const QString kChatId = QStringLiteral("chat_bench");
+constexpr qint64 kBaseTimestamp = 1700000000;
+
+void addCorpusSizes()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("1k") << 1000;
+    QTest::newRow("10k") << 10000;
+    QTest::newRow("100k") << 100000;
+}
+
+// Cycles through the content shapes the server actually sends: plain text,
+// text serialized into a JSON string, attachments, bare upload links and
+// forwards.
+QJsonObject messageJson(int i, qint64 timestamp)
+{
+    QJsonObject content;
+    switch (i % 6) {
+    case 0:
+        content.insert(QStringLiteral("text"), QStringLiteral("Message number %1 with some ordinary chat text").arg(i));
+        break;
+    case 1:
+        content.insert(QStringLiteral("text"), QString::fromUtf8(QJsonDocument(QJsonObject{
+            {QStringLiteral("text"), QStringLiteral("Serialized body %1").arg(i)},
+        }).toJson(QJsonDocument::Compact)));
+        break;
+    case 2:
+        content.insert(QStringLiteral("text"), QString());
+        content.insert(QStringLiteral("file"), QJsonObject{
+            {QStringLiteral("url"), QStringLiteral("/static/uploads/photo_%1.jpg").arg(i)},
+            {QStringLiteral("name"), QStringLiteral("photo_%1.jpg").arg(i)},
+            {QStringLiteral("type"), QStringLiteral("image/jpeg")},
+            {QStringLiteral("size"), 123456},
+        });
+        break;
+    case 3:
+        content.insert(QStringLiteral("text"), QStringLiteral("See attached"));
+        content.insert(QStringLiteral("file"), QJsonObject{
+            {QStringLiteral("url"), QStringLiteral("/static/uploads/report_%1.pdf").arg(i)},
+            {QStringLiteral("name"), QStringLiteral("report_%1.pdf").arg(i)},
+            {QStringLiteral("type"), QStringLiteral("application/pdf")},
+            {QStringLiteral("size"), 45678},
+        });
+        break;
+    case 4:
+        content.insert(QStringLiteral("text"), QStringLiteral("https://noveo.ir:8443/static/uploads/clip_%1.png").arg(i));
+        break;
+    default:
+        content.insert(QStringLiteral("text"), QStringLiteral("Forwarded text %1").arg(i));
+        content.insert(QStringLiteral("forwardedInfo"), QJsonObject{
+            {QStringLiteral("from"), QStringLiteral("someone")},
+            {QStringLiteral("originalTs"), static_cast<double>(timestamp - 3600)},
+        });
+        break;
+    }
+    content.insert(QStringLiteral("theme"), QJsonValue::Null);
+
+    return QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("message")},
+        {QStringLiteral("messageId"), QStringLiteral("m%1").arg(i)},
+        {QStringLiteral("chatId"), kChatId},
+        {QStringLiteral("senderId"), QStringLiteral("user_%1").arg(i % 17)},
+        {QStringLiteral("senderName"), QStringLiteral("User %1").arg(i % 17)},
+        {QStringLiteral("content"), content},
+        {QStringLiteral("timestamp"), static_cast<double>(timestamp)},
+        {QStringLiteral("seenBy"), QJsonArray{QStringLiteral("user_1"), QStringLiteral("user_2")}},
+    };
+}
+
+QJsonArray messagesJson(int count)
+{
+    QJsonArray messages;
+    for (int i = 0; i < count; ++i) {
+        messages.append(messageJson(i, kBaseTimestamp + i * 10));
+    }
+    return messages;
+}
+
+QJsonObject chatJson(int count)
+{
+    return QJsonObject{
+        {QStringLiteral("chatId"), kChatId},
+        {QStringLiteral("chatName"), QStringLiteral("Benchmark chat")},
+        {QStringLiteral("chatType"), QStringLiteral("group")},
+        {QStringLiteral("members"), QJsonArray{QStringLiteral("user_1"), QStringLiteral("user_2"), QStringLiteral("user_3")}},
+        {QStringLiteral("messages"), messagesJson(count)},
+    };
+}
+
+// Messages spaced 10 s apart starting at firstTimestamp.
+std::vector<Message> makeMessages(int count, int firstId, qint64 firstTimestamp)
+{
+    std::vector<Message> messages;
+    messages.reserve(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        Message msg;
+        msg.messageId = QStringLiteral("m%1").arg(firstId + i);
+        msg.chatId = kChatId;
+        msg.senderId = QStringLiteral("user_%1").arg(i % 17);
+        msg.text = QStringLiteral("Message number %1").arg(firstId + i);
+        msg.timestamp = firstTimestamp + static_cast<qint64>(i) * 10;
+        messages.push_back(msg);
+    }
+    return messages;
+}
+
+// Up to three levels of JSON-in-a-string, as the render path used to unwrap.
+QJsonObject legacyNestedContentObject(const QString& text)
+{
+    QString raw = text.trimmed();
+    for (int depth = 0; depth < 3 && !raw.isEmpty(); ++depth) {
+        QJsonParseError error;
+        const QJsonDocument parsed = QJsonDocument::fromJson(raw.toUtf8(), &error);
+        if (error.error != QJsonParseError::NoError) {
+            return QJsonObject();
+        }
+        if (parsed.isObject()) {
+            return parsed.object();
+        }
+        if (parsed.isArray() || parsed.isNull()) {
+            return QJsonObject();
+        }
+        const QVariant variant = parsed.toVariant();
+        if (variant.type() != QVariant::String) {
+            return QJsonObject();
+        }
+        const QString nested = variant.toString().trimmed();
+        if (nested == raw) {
+            return QJsonObject();
+        }
+        raw = nested;
+    }
+    return QJsonObject();
+}
+
+bool isContentObject(const QJsonObject& obj)
+{
+    return !obj.isEmpty() &&
+           (obj.contains(QStringLiteral("text")) || obj.contains(QStringLiteral("file")) || obj.contains(QStringLiteral("theme")));
+}
+
+// Content handling before it moved into the parser: the parser kept a
+// re-serialized rawContent and retried text that looked like an object, and
+// every row build then re-parsed the text (extractRenderableMessageText).
+// Kept as the baseline for normalizeContent.
+void legacyNormalize(const QJsonValue& contentValue, Message* msg)
+{
+    const QJsonObject contentObj = WebSocketWorker::parseContentObject(contentValue);
+    QString rawContent = QString::fromUtf8(QJsonDocument(contentObj).toJson(QJsonDocument::Compact));
+    msg->text = WebSocketWorker::extractMessageText(contentObj);
+    msg->file = WebSocketWorker::parseFileAttachment(contentObj.value(QStringLiteral("file")));
+    msg->theme = contentObj.value(QStringLiteral("theme")).toString();
+    msg->forwardedInfo = WebSocketWorker::parseForwardedInfo(contentObj.value(QStringLiteral("forwardedInfo")));
+    const QString trimmedText = msg->text.trimmed();
+    if (trimmedText.startsWith('{') && trimmedText.endsWith('}')) {
+        const QJsonObject nested = legacyNestedContentObject(trimmedText);
+        if (isContentObject(nested)) {
+            rawContent = QString::fromUtf8(QJsonDocument(nested).toJson(QJsonDocument::Compact));
+            msg->text = WebSocketWorker::extractMessageText(nested);
+            msg->file = WebSocketWorker::parseFileAttachment(nested.value(QStringLiteral("file")));
+            msg->theme = nested.value(QStringLiteral("theme")).toString();
+            msg->forwardedInfo = WebSocketWorker::parseForwardedInfo(nested.value(QStringLiteral("forwardedInfo")));
+        }
+    }
+    Q_UNUSED(rawContent);
+
+    QString text = msg->text.trimmed();
+    const QJsonObject rendered = legacyNestedContentObject(text);
+    if (isContentObject(rendered)) {
+        const QJsonValue renderedText = rendered.value(QStringLiteral("text"));
+        if (renderedText.isString()) {
+            text = renderedText.toString().trimmed();
+        } else if (renderedText.isBool() || renderedText.isDouble()) {
+            text = renderedText.toVariant().toString().trimmed();
+        } else {
+            text.clear();
+        }
+        if (msg->file.isNull() && rendered.contains(QStringLiteral("file"))) {
+            msg->file = WebSocketWorker::parseFileAttachment(rendered.value(QStringLiteral("file")));
+        }
+    }
+    msg->text = text;
+}
+
+// The string-comparison chain onTextMessageReceived used before the
+// ServerEvent table, kept as the baseline for serverEventLookup.
+ServerEvent legacyEventFromType(const QString& type)
+{
+    if (type == QStringLiteral("login_success")) {
+        return ServerEvent::LoginSuccess;
+    } else if (type == QStringLiteral("auth_failed")) {
+        return ServerEvent::AuthFailed;
+    } else if (type == QStringLiteral("chat_history")) {
+        return ServerEvent::ChatHistory;
+    } else if (type == QStringLiteral("message")) {
+        return ServerEvent::Message;
+    } else if (type == QStringLiteral("user_list_update")) {
+        return ServerEvent::UserListUpdate;
+    } else if (type == QStringLiteral("new_chat_info")) {
+        return ServerEvent::NewChatInfo;
+    } else if (type == QStringLiteral("message_seen_update")) {
+        return ServerEvent::MessageSeenUpdate;
+    } else if (type == QStringLiteral("message_updated")) {
+        return ServerEvent::MessageUpdated;
+    } else if (type == QStringLiteral("message_deleted")) {
+        return ServerEvent::MessageDeleted;
+    } else if (type == QStringLiteral("presence_update")) {
+        return ServerEvent::PresenceUpdate;
+    } else if (type == QStringLiteral("typing")) {
+        return ServerEvent::Typing;
+    } else if (type == QStringLiteral("channel_info")) {
+        return ServerEvent::ChannelInfo;
+    } else if (type == QStringLiteral("member_joined")) {
+        return ServerEvent::MemberJoined;
+    } else if (type == QStringLiteral("message_pinned")) {
+        return ServerEvent::MessagePinned;
+    } else if (type == QStringLiteral("message_unpinned")) {
+        return ServerEvent::MessageUnpinned;
+    } else if (type == QStringLiteral("password_changed")) {
+        return ServerEvent::PasswordChanged;
+    } else if (type == QStringLiteral("voice_chat_update")) {
+        return ServerEvent::VoiceChatUpdate;
+    } else if (type == QStringLiteral("incoming_call")) {
+        return ServerEvent::IncomingCall;
+    } else if (type == QStringLiteral("user_updated")) {
+        return ServerEvent::UserUpdated;
+    } else if (type == QStringLiteral("error")) {
+        return ServerEvent::Error;
+    }
+    return ServerEvent::Unknown;
+}
+}
+
+void NoveoBench::parseMessageObject_data()
+{
+    addCorpusSizes();
+}
+
+void NoveoBench::parseMessageObject()
+{
+    QFETCH(int, count);
+    const QJsonArray messages = messagesJson(count);
+    QBENCHMARK {
+        for (const QJsonValue& value : messages) {
+            const Message msg = WebSocketWorker::parseMessageObject(value.toObject());
+            Q_UNUSED(msg);
+        }
+    }
+}
+
+void NoveoBench::parseChatObject_data()
+{
+    addCorpusSizes();
+}
+
+void NoveoBench::parseChatObject()
+{
+    QFETCH(int, count);
+    const QJsonObject chat = chatJson(count);
+    QBENCHMARK {
+        const Chat parsed = WebSocketWorker::parseChatObject(chat);
+        Q_UNUSED(parsed);
+    }
+}
+
+void NoveoBench::normalizeContent_data()
+{
+    QTest::addColumn<bool>("legacy");
+    QTest::newRow("parser") << false;
+    QTest::newRow("legacy") << true;
+}
+
+// Content normalization alone, per 10k messages: once in the parser, against
+// the earlier parse plus render-time re-parse.
+void NoveoBench::normalizeContent()
+{
+    QFETCH(bool, legacy);
+    std::vector<QJsonValue> contents;
+    const QJsonArray messages = messagesJson(10000);
+    for (const QJsonValue& value : messages) {
+        contents.push_back(value.toObject().value(QStringLiteral("content")));
+    }
+    if (legacy) {
+        QBENCHMARK {
+            for (const QJsonValue& content : contents) {
+                Message msg;
+                legacyNormalize(content, &msg);
+            }
+        }
+    } else {
+        QBENCHMARK {
+            for (const QJsonValue& content : contents) {
+                Message msg;
+                WebSocketWorker::applyContent(WebSocketWorker::parseContentObject(content), &msg);
+            }
+        }
+    }
+}
+
+void NoveoBench::displayTextForMessage_data()
+{
+    addCorpusSizes();
+}
+
+void NoveoBench::displayTextForMessage()
+{
+    QFETCH(int, count);
+    std::vector<Message> messages;
+    messages.reserve(static_cast<size_t>(count));
+    const QJsonArray json = messagesJson(count);
+    for (const QJsonValue& value : json) {
+        messages.push_back(WebSocketWorker::parseMessageObject(value.toObject()));
+    }
+    QBENCHMARK {
+        for (const Message& msg : messages) {
+            const QString text = MainWindow::displayTextForMessage(msg);
+            Q_UNUSED(text);
+        }
+    }
+}
+
+void NoveoBench::mergeHistory_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<QString>("shape");
+    const QList<QPair<QByteArray, int>> sizes{{"1k", 1000}, {"10k", 10000}, {"100k", 100000}};
+    for (const auto& size : sizes) {
+        for (const QString& shape : {QStringLiteral("delta"), QStringLiteral("page"), QStringLiteral("interleaved"), QStringLiteral("replay")}) {
+            QTest::newRow((size.first + '/' + shape.toLatin1()).constData()) << size.second << shape;
+        }
+    }
+}
+
+// Merges a 50-message batch into a chat already holding count messages:
+// a reconnect delta (newer), an older history page, a batch interleaved with
+// what is held, or a replay of messages already present. Each run needs a
+// fresh copy of the chat, so only the merge itself is timed and reported.
+void NoveoBench::mergeHistory()
+{
+    QFETCH(int, count);
+    QFETCH(QString, shape);
+    constexpr int kBatch = 50;
+
+    Chat base;
+    base.chatId = kChatId;
+    base.mergeMessages(makeMessages(count, 0, kBaseTimestamp));
+
+    std::vector<Message> batch;
+    if (shape == QStringLiteral("delta")) {
+        batch = makeMessages(kBatch, count, kBaseTimestamp + static_cast<qint64>(count) * 10);
+    } else if (shape == QStringLiteral("page")) {
+        batch = makeMessages(kBatch, -kBatch - 1000000, kBaseTimestamp - kBatch * 10);
+    } else if (shape == QStringLiteral("interleaved")) {
+        batch = makeMessages(kBatch, count, kBaseTimestamp + 5);
+        for (size_t i = 0; i < batch.size(); ++i) {
+            batch[i].timestamp = kBaseTimestamp + 5 + static_cast<qint64>(i) * (count / kBatch) * 10;
+        }
+    } else {
+        batch = makeMessages(kBatch, count - kBatch, kBaseTimestamp + static_cast<qint64>(count - kBatch) * 10);
+    }
+
+    constexpr int kRuns = 20;
+    qint64 totalNs = 0;
+    for (int run = 0; run < kRuns; ++run) {
+        Chat chat = base;
+        QElapsedTimer timer;
+        timer.start();
+        chat.mergeMessages(batch);
+        totalNs += timer.nsecsElapsed();
+    }
+    QTest::setBenchmarkResult(static_cast<qreal>(totalNs) / kRuns / 1e6, QTest::WalltimeMilliseconds);
+}
+
+void NoveoBench::serverEventLookup_data()
+{
+    QTest::addColumn<bool>("legacy");
+    QTest::newRow("table") << false;
+    QTest::newRow("ifchain") << true;
+}
+
+// Type resolution for a live-traffic mix: the sorted ServerEvent table
+// against the comparison chain it replaced.
+void NoveoBench::serverEventLookup()
+{
+    QFETCH(bool, legacy);
+    const QStringList types{
+        QStringLiteral("message"), QStringLiteral("presence_update"), QStringLiteral("typing"),
+        QStringLiteral("message_seen_update"), QStringLiteral("message_updated"), QStringLiteral("voice_chat_update"),
+        QStringLiteral("user_list_update"), QStringLiteral("chat_history"), QStringLiteral("not_a_type"),
+    };
+    if (legacy) {
+        QBENCHMARK {
+            for (const QString& type : types) {
+                const ServerEvent event = legacyEventFromType(type);
+                Q_UNUSED(event);
+            }
+        }
+    } else {
+        QBENCHMARK {
+            for (const QString& type : types) {
+                const ServerEvent event = serverEventFromType(type);
+                Q_UNUSED(event);
+            }
+        }
+    }
+}
+
+// A realistic live-traffic mix through the whole worker dispatch path
+// (lookup, handler call, parse and signal emission with no receivers).
+void NoveoBench::dispatchFrame()
+{
+    std::vector<QJsonObject> frames;
+    for (int i = 0; i < 1000; ++i) {
+        switch (i % 5) {
+        case 0:
+        case 1:
+            frames.push_back(messageJson(i, kBaseTimestamp + i));
+            break;
+        case 2:
+            frames.push_back(QJsonObject{
+                {QStringLiteral("type"), QStringLiteral("typing")},
+                {QStringLiteral("chatId"), kChatId},
+                {QStringLiteral("senderId"), QStringLiteral("user_%1").arg(i % 17)},
+            });
+            break;
+        case 3:
+            frames.push_back(QJsonObject{
+                {QStringLiteral("type"), QStringLiteral("presence_update")},
+                {QStringLiteral("userId"), QStringLiteral("user_%1").arg(i % 17)},
+                {QStringLiteral("online"), (i & 1) == 0},
+            });
+            break;
+        default:
+            frames.push_back(QJsonObject{
+                {QStringLiteral("type"), QStringLiteral("message_seen_update")},
+                {QStringLiteral("chatId"), kChatId},
+                {QStringLiteral("messageId"), QStringLiteral("m%1").arg(i)},
+                {QStringLiteral("userId"), QStringLiteral("user_%1").arg(i % 17)},
+            });
+            break;
+        }
+    }
+
+    WebSocketWorker worker;
+    QBENCHMARK {
+        for (const QJsonObject& frame : frames) {
+            worker.dispatchFrame(frame);
+        }
+    }
+}
+
+void NoveoBench::historyGuiStall_data()
+{
+    QTest::addColumn<bool>("threaded");
+    QTest::newRow("inline") << false;
+    QTest::newRow("threaded") << true;
+}
+
+// A ~50 MB chat_history text frame through WebSocketWorker, with the worker
+// on the GUI thread (the layout before the network thread) or on a thread
+// of its own. The result is the longest the GUI event loop went without
+// running a 1 ms timer from handing over the frame until the last parsed
+// batch was delivered; frame size and end-to-end time are logged with it.
+// Run on its own, e.g. noveo_bench historyGuiStall
+void NoveoBench::historyGuiStall()
+{
+    QFETCH(bool, threaded);
+    constexpr qint64 kTargetBytes = 50LL * 1024 * 1024;
+    constexpr int kChats = 40;
+
+    qRegisterMetaType<std::vector<Chat>>("std::vector<Chat>");
+
+    const qint64 bytesPerMessage = QJsonDocument(chatJson(1000)).toJson(QJsonDocument::Compact).size() / 1000;
+    const int messagesPerChat = static_cast<int>(kTargetBytes / kChats / qMax<qint64>(1, bytesPerMessage)) + 1;
+    QJsonArray chats;
+    for (int c = 0; c < kChats; ++c) {
+        QJsonObject chat = chatJson(messagesPerChat);
+        chat.insert(QStringLiteral("chatId"), QStringLiteral("chat_%1").arg(c));
+        chats.append(chat);
+    }
+    const QByteArray utf8 = QJsonDocument(QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("chat_history")},
+        {QStringLiteral("chats"), chats},
+    }).toJson(QJsonDocument::Compact);
+    const QString frame = QString::fromUtf8(utf8);
+
+    QThread networkThread;
+    WebSocketWorker worker;
+    if (threaded) {
+        worker.moveToThread(&networkThread);
+        networkThread.start();
+    }
+
+    QEventLoop loop;
+    bool delivered = false;
+    const auto finish = [&]() {
+        delivered = true;
+        loop.quit();
+    };
+    connect(&worker, &WebSocketWorker::chatHistoryReceived, &loop, finish);
+    connect(&worker, &WebSocketWorker::chatHistoryBatchReceived, &loop,
+            [&](const std::vector<Chat>&, bool, bool last) {
+                if (last) {
+                    finish();
+                }
+            });
+
+    QTimer tick;
+    tick.setTimerType(Qt::PreciseTimer);
+    tick.setInterval(1);
+    QElapsedTimer sinceTick;
+    qint64 longestStallNs = 0;
+    connect(&tick, &QTimer::timeout, &loop, [&]() {
+        longestStallNs = qMax(longestStallNs, sinceTick.nsecsElapsed());
+        sinceTick.restart();
+    });
+
+    QElapsedTimer total;
+    QTimer::singleShot(0, &loop, [&]() {
+        total.start();
+        sinceTick.start();
+        tick.start();
+        // Queued either way, as a frame from the socket would be.
+        QMetaObject::invokeMethod(&worker, "onTextMessageReceived", Qt::QueuedConnection, Q_ARG(QString, frame));
+    });
+    QTimer::singleShot(120000, &loop, &QEventLoop::quit);
+    loop.exec();
+    longestStallNs = qMax(longestStallNs, sinceTick.nsecsElapsed());
+    tick.stop();
+    const qint64 totalMs = total.elapsed();
+
+    if (threaded) {
+        networkThread.quit();
+        networkThread.wait();
+    }
+    QVERIFY(delivered);
+
+    qInfo().noquote() << QStringLiteral("%1 MB frame, %2 ms end to end, longest GUI stall %3 ms")
+                             .arg(utf8.size() / (1024.0 * 1024.0), 0, 'f', 1)
+                             .arg(totalMs)
+                             .arg(longestStallNs / 1e6, 0, 'f', 1);
+    QTest::setBenchmarkResult(longestStallNs / 1e6, QTest::WalltimeMilliseconds);
+}
+
+void NoveoBench::traceScope_data()
+{
+    QTest::addColumn<bool>("recording");
+    QTest::newRow("idle") << false;
+    QTest::newRow("recording") << true;
+}
+
+// Cost of 1000 trace spans, compiled in but not recording, and recording.
+// Set against the per-frame dispatchFrame time this bounds the tracing
+// overhead; comparing whole runs of a NOVEO_ENABLE_TRACING=ON and OFF build
+// gives the end-to-end figure.
+void NoveoBench::traceScope()
+{
+    QFETCH(bool, recording);
+    QTemporaryDir dir;
+    if (recording && !Trace::start(dir.filePath(QStringLiteral("bench_trace.json")))) {
+        QSKIP("Built without NOVEO_ENABLE_TRACING.");
+    }
+    QBENCHMARK {
+        for (int i = 0; i < 1000; ++i) {
+            Trace::Scope scope("bench.span");
+        }
+    }
+    Trace::stop();
+}
+
+void NoveoBench::wireSize_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("cbor");
+    QTest::newRow("json/1k") << 1000 << false;
+    QTest::newRow("cbor/1k") << 1000 << true;
+    QTest::newRow("json/10k") << 10000 << false;
+    QTest::newRow("cbor/10k") << 10000 << true;
+}
+
+// Encoded size of a chat_history frame. Not a timing, and QTest has no
+// byte-count metric, so it is logged as a QINFO line per row.
+void NoveoBench::wireSize()
+{
+    QFETCH(int, count);
+    QFETCH(bool, cbor);
+    const QJsonObject frame{
+        {QStringLiteral("type"), QStringLiteral("chat_history")},
+        {QStringLiteral("chats"), QJsonArray{chatJson(count)}},
+    };
+    const QByteArray encoded = cbor ? QCborValue::fromJsonValue(frame).toCbor()
+                                    : QJsonDocument(frame).toJson(QJsonDocument::Compact);
+    qInfo().noquote() << QStringLiteral("%1 bytes").arg(encoded.size());
+}
+
+void NoveoBench::wireDecode_data()
+{
+    wireSize_data();
+}
+
+// Decoding a chat_history frame up to the QJsonObject the handlers read.
+// The client speaks JSON only; the cbor rows show what a CBOR wire format
+// would cost while the handlers still take QJsonObject.
+void NoveoBench::wireDecode()
+{
+    QFETCH(int, count);
+    QFETCH(bool, cbor);
+    const QJsonObject frame{
+        {QStringLiteral("type"), QStringLiteral("chat_history")},
+        {QStringLiteral("chats"), QJsonArray{chatJson(count)}},
+    };
+    if (cbor) {
+        const QByteArray encoded = QCborValue::fromJsonValue(frame).toCbor();
+        QBENCHMARK {
+            const QJsonObject decoded = QCborValue::fromCbor(encoded).toMap().toJsonObject();
+            Q_UNUSED(decoded);
+        }
+    } else {
+        const QString encoded = QString::fromUtf8(QJsonDocument(frame).toJson(QJsonDocument::Compact));
+        QBENCHMARK {
+            const QJsonObject decoded = QJsonDocument::fromJson(encoded.toUtf8()).object();
+            Q_UNUSED(decoded);
+        }
+    }
+}
+
+void NoveoBench::userListDelegatePaint_data()
+{
+    QTest::addColumn<bool>("tagged");
+    QTest::newRow("plain") << false;
+    QTest::newRow("tagged") << true;
+}
+
+// One full sidebar viewport (12 rows) painted through UserListDelegate.
+void NoveoBench::userListDelegatePaint()
+{
+    QFETCH(bool, tagged);
+    constexpr int kRows = 12;
+    constexpr int kRowHeight = 60;
+
+    QListWidget list;
+    list.resize(320, kRows * kRowHeight);
+    UserListDelegate delegate;
+    QPixmap avatar(40, 40);
+    avatar.fill(Qt::darkCyan);
+    for (int i = 0; i < kRows; ++i) {
+        const QString name = tagged ? QStringLiteral("User %1 [#3390ec, \"Admin\"]").arg(i) : QStringLiteral("User %1").arg(i);
+        list.addItem(new QListWidgetItem(QIcon(avatar), name));
+    }
+
+    QImage target(320, kRows * kRowHeight, QImage::Format_ARGB32_Premultiplied);
+    QStyleOptionViewItem option;
+    option.initFrom(&list);
+    option.widget = &list;
+    QBENCHMARK {
+        QPainter painter(&target);
+        for (int i = 0; i < kRows; ++i) {
+            option.rect = QRect(0, i * kRowHeight, 320, kRowHeight);
+            delegate.paint(&painter, option, list.model()->index(i, 0));
+        }
+    }
+}
+
+void NoveoBench::bubbleConstruction_data()
+{
+    QTest::addColumn<int>("kind");
+    QTest::newRow("text") << 0;
+    QTest::newRow("serialized") << 1;
+    QTest::newRow("image") << 2;
+    QTest::newRow("file") << 3;
+    QTest::newRow("forwarded") << 5;
+}
+
+// Construction and teardown of one MessageItemWidget, as done for every
+// bubble that scrolls into view.
+void NoveoBench::bubbleConstruction()
+{
+    QFETCH(int, kind);
+    const Message msg = WebSocketWorker::parseMessageObject(messageJson(kind, kBaseTimestamp));
+    QPixmap avatar(34, 34);
+    avatar.fill(Qt::darkCyan);
+    const QString fileUrl = msg.file.isNull() ? QString() : QStringLiteral("http://127.0.0.1:1") + msg.file.url;
+    QBENCHMARK {
+        MessageItemWidget widget(msg,
+                                 msg.senderName,
+                                 QString(),
+                                 avatar,
+                                 fileUrl,
+                                 QStringLiteral("User 2"),
+                                 QStringLiteral("Earlier message being replied to"),
+                                 QStringLiteral("user_1"),
+                                 QStringLiteral("group"),
+                                 false,
+                                 false);
+        widget.adjustSize();
+        // Run what bind() deferred, as the event loop would between bubbles.
+        QCoreApplication::processEvents();
+    }
+}
+
+void NoveoBench::bubbleRebind_data()
+{
+    bubbleConstruction_data();
+}
+
+// What a warm MessageWidgetPool does instead: reset a parked widget and bind
+// it to the next message. Alternates two messages so nothing is a no-op.
+void NoveoBench::bubbleRebind()
+{
+    QFETCH(int, kind);
+    const Message first = WebSocketWorker::parseMessageObject(messageJson(kind, kBaseTimestamp));
+    const Message second = WebSocketWorker::parseMessageObject(messageJson(kind + 6, kBaseTimestamp + 1));
+    QPixmap avatar(34, 34);
+    avatar.fill(Qt::darkCyan);
+    const auto fileUrlFor = [](const Message& msg) {
+        return msg.file.isNull() ? QString() : QStringLiteral("http://127.0.0.1:1") + msg.file.url;
+    };
+    MessageItemWidget widget;
+    int i = 0;
+    QBENCHMARK {
+        const Message& msg = (i++ % 2 == 0) ? first : second;
+        widget.reset();
+        widget.bind(msg,
+                    msg.senderName,
+                    QString(),
+                    avatar,
+                    fileUrlFor(msg),
+                    QStringLiteral("User 2"),
+                    QStringLiteral("Earlier message being replied to"),
+                    QStringLiteral("user_1"),
+                    QStringLiteral("group"),
+                    false,
+                    false);
+        widget.adjustSize();
+        // bind() defers work with zero-time single shots; drain them so they
+        // are paid per iteration instead of piling up on the one widget.
+        QCoreApplication::processEvents();
+    }
+}
+
+QTEST_MAIN(NoveoBench)
+#include "noveo_bench.moc"
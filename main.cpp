@@ -1,4 +1,6 @@
+#include "AppConfig.h"
 #include "MainWindow.h"
+#include "Trace.h"
 #include <QApplication>
 #include <QFont>
 #include <QPalette>
@@ -7,6 +9,10 @@
 int main(int argc, char* argv[])
 {
     QApplication a(argc, argv);
+    if (Trace::start(AppConfig::traceOutputPath())) {
+        Trace::setThreadName("GUI");
+        QObject::connect(&a, &QCoreApplication::aboutToQuit, []() { Trace::stop(); });
+    }
 
     // Set a cross-platform default font
     QFont font("Sans Serif", 10);
@@ -0,0 +1,156 @@
+#include "AppConfig.h"
+#include "ChatStore.h"
+#include "Trace.h"
+#include "WebSocketClient.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QTextStream>
+#include <QTimer>
+
+// Drives the real protocol and chat state without a display: logs in, loads
+// history, optionally sends at a fixed rate, and prints timings. Point it at
+// the mock server (or a staging server) with NOVEO_WS_URL.
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("noveo-headless-client"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Headless Noveo client for load runs and profiling."));
+    parser.addHelpOption();
+    const QCommandLineOption userOption(QStringLiteral("username"), QStringLiteral("Account name."), QStringLiteral("name"), QStringLiteral("bench"));
+    const QCommandLineOption passwordOption(QStringLiteral("password"), QStringLiteral("Account password."), QStringLiteral("password"), QStringLiteral("bench"));
+    const QCommandLineOption registerOption(QStringLiteral("register"), QStringLiteral("Register the account instead of logging in."));
+    const QCommandLineOption durationOption(QStringLiteral("duration"), QStringLiteral("Seconds to stay connected after history."), QStringLiteral("seconds"), QStringLiteral("10"));
+    const QCommandLineOption sendRateOption(QStringLiteral("send-rate"), QStringLiteral("Messages per second sent to the most recent chat."), QStringLiteral("rate"), QStringLiteral("0"));
+    parser.addOptions({userOption, passwordOption, registerOption, durationOption, sendRateOption});
+    parser.process(app);
+
+    if (Trace::start(AppConfig::traceOutputPath())) {
+        Trace::setThreadName("Main");
+        QObject::connect(&app, &QCoreApplication::aboutToQuit, []() { Trace::stop(); });
+    }
+
+    QTextStream out(stdout);
+    WebSocketClient client;
+    ChatStore store;
+    store.attach(&client);
+
+    QElapsedTimer clock;
+    clock.start();
+    qint64 loginMs = -1;
+    qint64 historyMs = -1;
+    int received = 0;
+    int confirmed = 0;
+    qint64 totalEchoMs = 0;
+    qint64 maxEchoMs = 0;
+    QHash<QString, qint64> sentAtByPendingId;
+
+    QTimer sendTimer;
+    const double sendRate = parser.value(sendRateOption).toDouble();
+    if (sendRate > 0.0) {
+        sendTimer.setInterval(qMax(1, static_cast<int>(1000.0 / sendRate)));
+    }
+
+    const auto report = [&]() {
+        int messages = 0;
+        for (const Chat& chat : store.chats()) {
+            messages += static_cast<int>(chat.messages.size());
+        }
+        out << "login_ms " << loginMs << "\n"
+            << "history_ms " << historyMs << "\n"
+            << "chats " << store.chats().size() << "\n"
+            << "messages " << messages << "\n"
+            << "users " << store.users().size() << "\n"
+            << "received " << received << "\n"
+            << "confirmed " << confirmed << "\n"
+            << "echo_avg_ms " << (confirmed > 0 ? totalEchoMs / confirmed : -1) << "\n"
+            << "echo_max_ms " << maxEchoMs << "\n";
+        out.flush();
+    };
+
+    QObject::connect(&client, &WebSocketClient::connected, &app, [&]() {
+        if (parser.isSet(registerOption)) {
+            client.registerUser(parser.value(userOption), parser.value(passwordOption));
+        } else {
+            client.login(parser.value(userOption), parser.value(passwordOption));
+        }
+    });
+    QObject::connect(&client, &WebSocketClient::authFailed, &app, [&](const QString& message) {
+        out << "auth failed: " << message << "\n";
+        out.flush();
+        app.exit(1);
+    });
+    QObject::connect(&client, &WebSocketClient::loginSuccess, &app, [&]() {
+        loginMs = clock.elapsed();
+    });
+    const auto historyLoaded = [&]() {
+        if (historyMs >= 0) {
+            return;
+        }
+        historyMs = clock.elapsed();
+        if (sendRate > 0.0) {
+            sendTimer.start();
+        }
+        QTimer::singleShot(parser.value(durationOption).toInt() * 1000, &app, [&]() {
+            report();
+            client.disconnectFromServer();
+            app.quit();
+        });
+    };
+    // Small accounts get the history in one frame; larger ones in batches.
+    QObject::connect(&client, &WebSocketClient::chatHistoryReceived, &app, [&](const std::vector<Chat>& chats) {
+        store.applyHistory(chats, false);
+        historyLoaded();
+    });
+    QObject::connect(&client, &WebSocketClient::chatHistoryBatchReceived, &app, [&](const std::vector<Chat>& batch, bool, bool last) {
+        store.applyBatch(batch);
+        if (last) {
+            historyLoaded();
+        }
+    });
+    QObject::connect(&client, &WebSocketClient::chatDeltaReceived, &app, [&](const std::vector<Chat>& deltas) {
+        for (const Chat& delta : deltas) {
+            store.applyDelta(delta);
+        }
+    });
+    QObject::connect(&store, &ChatStore::messageAdded, &app, [&](const Message&, const QString& pendingId) {
+        ++received;
+        const auto it = sentAtByPendingId.find(pendingId);
+        if (pendingId.isEmpty() || it == sentAtByPendingId.end()) {
+            return;
+        }
+        const qint64 echoMs = clock.elapsed() - it.value();
+        sentAtByPendingId.erase(it);
+        ++confirmed;
+        totalEchoMs += echoMs;
+        maxEchoMs = qMax(maxEchoMs, echoMs);
+    });
+    QObject::connect(&sendTimer, &QTimer::timeout, &app, [&]() {
+        if (store.chats().isEmpty()) {
+            return;
+        }
+        const Chat* target = nullptr;
+        for (const Chat& chat : store.chats()) {
+            if (!target || chat.syncCursor() > target->syncCursor()) {
+                target = &chat;
+            }
+        }
+        Message pending;
+        pending.chatId = target->chatId;
+        pending.senderId = client.currentUserId();
+        pending.text = QStringLiteral("load %1").arg(clock.elapsed());
+        pending.pending = true;
+        pending.status = MessageStatus::Pending;
+        pending.clientMessageId = client.sendMessage(pending.chatId, pending.text);
+        pending.messageId = QStringLiteral("temp_") + pending.clientMessageId;
+        store.trackPending(pending);
+        sentAtByPendingId.insert(pending.messageId, clock.elapsed());
+    });
+
+    client.connectToServer();
+    return app.exec();
+}
@@ -0,0 +1,179 @@
+#include "MockHttpServer.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+namespace {
+constexpr int kMaxRequestBytes = 64 * 1024 * 1024;
+
+QByteArray headerParameter(const QByteArray& header, const QByteArray& name)
+{
+    const QByteArray key = name + '=';
+    for (QByteArray part : header.split(';')) {
+        part = part.trimmed();
+        if (part.startsWith(key)) {
+            QByteArray value = part.mid(key.size());
+            if (value.size() >= 2 && value.startsWith('"') && value.endsWith('"')) {
+                value = value.mid(1, value.size() - 2);
+            }
+            return value;
+        }
+    }
+    return QByteArray();
+}
+
+QByteArray reasonPhrase(int status)
+{
+    switch (status) {
+    case 200: return QByteArrayLiteral("OK");
+    case 400: return QByteArrayLiteral("Bad Request");
+    case 404: return QByteArrayLiteral("Not Found");
+    case 413: return QByteArrayLiteral("Payload Too Large");
+    default: return QByteArrayLiteral("Error");
+    }
+}
+}
+
+MockHttpServer::MockHttpServer(QObject* parent)
+    : QObject(parent),
+      m_server(new QTcpServer(this))
+{
+    connect(m_server, &QTcpServer::newConnection, this, &MockHttpServer::onNewConnection);
+}
+
+bool MockHttpServer::listen(quint16 port)
+{
+    return m_server->listen(QHostAddress::Any, port);
+}
+
+quint16 MockHttpServer::port() const
+{
+    return m_server->serverPort();
+}
+
+void MockHttpServer::onNewConnection()
+{
+    while (QTcpSocket* socket = m_server->nextPendingConnection()) {
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            m_buffers.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void MockHttpServer::onReadyRead(QTcpSocket* socket)
+{
+    QByteArray& buffer = m_buffers[socket];
+    buffer.append(socket->readAll());
+
+    const int headerEnd = buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        return;
+    }
+    const QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+    const QList<QByteArray> requestLine = lines.value(0).trimmed().split(' ');
+    QHash<QByteArray, QByteArray> headers;
+    for (int i = 1; i < lines.size(); ++i) {
+        const int colon = lines.at(i).indexOf(':');
+        if (colon > 0) {
+            headers.insert(lines.at(i).left(colon).trimmed().toLower(), lines.at(i).mid(colon + 1).trimmed());
+        }
+    }
+
+    const int contentLength = headers.value(QByteArrayLiteral("content-length")).toInt();
+    if (contentLength > kMaxRequestBytes) {
+        respond(socket, 413, QByteArrayLiteral("text/plain"), QByteArray());
+        socket->disconnectFromHost();
+        return;
+    }
+    const int bodyStart = headerEnd + 4;
+    if (buffer.size() - bodyStart < contentLength) {
+        return;
+    }
+    const QByteArray body = buffer.mid(bodyStart, contentLength);
+    buffer.remove(0, bodyStart + contentLength);
+    handleRequest(socket, requestLine.value(0), requestLine.value(1), headers, body);
+}
+
+void MockHttpServer::handleRequest(QTcpSocket* socket, const QByteArray& method, const QByteArray& path,
+                                   const QHash<QByteArray, QByteArray>& headers, const QByteArray& body)
+{
+    if (method == "POST" && path.startsWith("/upload/")) {
+        handleUpload(socket, headers.value(QByteArrayLiteral("content-type")), body);
+        return;
+    }
+    if (method == "GET") {
+        const auto it = m_files.constFind(path);
+        if (it != m_files.constEnd()) {
+            respond(socket, 200, it->mimeType, it->data);
+            return;
+        }
+    }
+    respond(socket, 404, QByteArrayLiteral("text/plain"), QByteArray());
+}
+
+void MockHttpServer::handleUpload(QTcpSocket* socket, const QByteArray& contentType, const QByteArray& body)
+{
+    const QByteArray boundary = headerParameter(contentType, QByteArrayLiteral("boundary"));
+    if (boundary.isEmpty()) {
+        respond(socket, 400, QByteArrayLiteral("text/plain"), QByteArray());
+        return;
+    }
+
+    // RestClient sends a single file part; take the first one that has a filename.
+    const QByteArray delimiter = "--" + boundary;
+    int partStart = body.indexOf(delimiter);
+    while (partStart >= 0) {
+        partStart += delimiter.size() + 2;
+        const int partEnd = body.indexOf("\r\n" + delimiter, partStart);
+        const int headerEnd = body.indexOf("\r\n\r\n", partStart);
+        if (partEnd < 0 || headerEnd < 0 || headerEnd > partEnd) {
+            break;
+        }
+
+        QByteArray disposition;
+        QByteArray mimeType = QByteArrayLiteral("application/octet-stream");
+        for (const QByteArray& line : body.mid(partStart, headerEnd - partStart).split('\n')) {
+            const QByteArray lower = line.trimmed().toLower();
+            if (lower.startsWith("content-disposition:")) {
+                disposition = line.trimmed();
+            } else if (lower.startsWith("content-type:")) {
+                mimeType = line.mid(line.indexOf(':') + 1).trimmed();
+            }
+        }
+        const QByteArray fileName = headerParameter(disposition, QByteArrayLiteral("filename"));
+        if (!fileName.isEmpty()) {
+            StoredFile file;
+            file.data = body.mid(headerEnd + 4, partEnd - headerEnd - 4);
+            file.mimeType = mimeType;
+            const QByteArray url = "/files/" + QByteArray::number(m_nextFileId++) + '/' + fileName;
+            const QJsonObject response{
+                {QStringLiteral("success"), true},
+                {QStringLiteral("file"), QJsonObject{
+                    {QStringLiteral("url"), QString::fromUtf8(url)},
+                    {QStringLiteral("name"), QString::fromUtf8(fileName)},
+                    {QStringLiteral("type"), QString::fromUtf8(mimeType)},
+                    {QStringLiteral("size"), static_cast<double>(file.data.size())},
+                }},
+            };
+            m_files.insert(url, file);
+            respond(socket, 200, QByteArrayLiteral("application/json"), QJsonDocument(response).toJson(QJsonDocument::Compact));
+            return;
+        }
+        partStart = partEnd + 2;
+    }
+    respond(socket, 400, QByteArrayLiteral("text/plain"), QByteArray());
+}
+
+void MockHttpServer::respond(QTcpSocket* socket, int status, const QByteArray& contentType, const QByteArray& body)
+{
+    QByteArray response = "HTTP/1.1 " + QByteArray::number(status) + ' ' + reasonPhrase(status) + "\r\n";
+    response += "Content-Type: " + contentType + "\r\n";
+    response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    response += "Connection: keep-alive\r\n\r\n";
+    response += body;
+    socket->write(response);
+}
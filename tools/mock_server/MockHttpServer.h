@@ -0,0 +1,41 @@
+#ifndef MOCKHTTPSERVER_H
+#define MOCKHTTPSERVER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+
+class QTcpServer;
+class QTcpSocket;
+
+// Just enough HTTP/1.1 for RestClient's chat uploads: POST /upload/file with
+// a multipart body, and GET of what was uploaded. Files stay in memory.
+class MockHttpServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MockHttpServer(QObject* parent = nullptr);
+
+    bool listen(quint16 port);
+    quint16 port() const;
+
+private:
+    struct StoredFile {
+        QByteArray data;
+        QByteArray mimeType;
+    };
+
+    void onNewConnection();
+    void onReadyRead(QTcpSocket* socket);
+    void handleRequest(QTcpSocket* socket, const QByteArray& method, const QByteArray& path,
+                       const QHash<QByteArray, QByteArray>& headers, const QByteArray& body);
+    void handleUpload(QTcpSocket* socket, const QByteArray& contentType, const QByteArray& body);
+    void respond(QTcpSocket* socket, int status, const QByteArray& contentType, const QByteArray& body);
+
+    QTcpServer* m_server = nullptr;
+    QHash<QTcpSocket*, QByteArray> m_buffers;
+    QHash<QByteArray, StoredFile> m_files;
+    int m_nextFileId = 1;
+};
+
+#endif // MOCKHTTPSERVER_H
@@ -0,0 +1,476 @@
+#include "MockServer.h"
+
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QTimer>
+#include <QWebSocket>
+#include <QWebSocketServer>
+
+#include <algorithm>
+
+namespace {
+constexpr int kInitialMessagesPerChat = 50;
+constexpr int kHistoryPageSize = 50;
+
+const QStringList kWords = {
+    QStringLiteral("hello"), QStringLiteral("noveo"), QStringLiteral("meeting"), QStringLiteral("tomorrow"),
+    QStringLiteral("build"), QStringLiteral("release"), QStringLiteral("coffee"), QStringLiteral("sounds"),
+    QStringLiteral("good"), QStringLiteral("check"), QStringLiteral("this"), QStringLiteral("out"),
+    QStringLiteral("later"), QStringLiteral("thanks"), QStringLiteral("profile"), QStringLiteral("latency"),
+};
+}
+
+MockServer::MockServer(const Workload& workload, QObject* parent)
+    : QObject(parent),
+      m_workload(workload),
+      m_random(workload.seed),
+      m_server(new QWebSocketServer(QStringLiteral("noveo-mock"), QWebSocketServer::NonSecureMode, this))
+{
+    connect(m_server, &QWebSocketServer::newConnection, this, &MockServer::onNewConnection);
+    generateCorpus();
+
+    if (m_workload.burstMessagesPerSec > 0.0) {
+        m_burstTimer = new QTimer(this);
+        m_burstTimer->setTimerType(Qt::PreciseTimer);
+        m_burstTimer->setInterval(qMax(1, static_cast<int>(1000.0 / m_workload.burstMessagesPerSec)));
+        connect(m_burstTimer, &QTimer::timeout, this, &MockServer::emitBurstMessage);
+        m_burstTimer->start();
+    }
+    if (m_workload.presenceChangesPerSec > 0.0) {
+        m_presenceTimer = new QTimer(this);
+        m_presenceTimer->setTimerType(Qt::PreciseTimer);
+        m_presenceTimer->setInterval(qMax(1, static_cast<int>(1000.0 / m_workload.presenceChangesPerSec)));
+        connect(m_presenceTimer, &QTimer::timeout, this, &MockServer::emitPresenceChange);
+        m_presenceTimer->start();
+    }
+}
+
+bool MockServer::listen(quint16 port)
+{
+    return m_server->listen(QHostAddress::Any, port);
+}
+
+void MockServer::generateCorpus()
+{
+    for (int i = 0; i < m_workload.users; ++i) {
+        const QString userId = QStringLiteral("user_%1").arg(i);
+        m_userIds.append(userId);
+        if (m_random.bounded(2) == 0) {
+            m_onlineUsers.insert(userId);
+        }
+    }
+
+    // Chats end at staggered times so their order in the sidebar is stable.
+    const qint64 now = nowSecs();
+    for (int c = 0; c < m_workload.chats; ++c) {
+        MockChat chat;
+        chat.chatId = QStringLiteral("chat_%1").arg(c);
+        chat.chatName = QStringLiteral("Mock chat %1").arg(c);
+        chat.chatType = QStringLiteral("group");
+        const int memberCount = qMin(m_userIds.size(), 2 + static_cast<int>(m_random.bounded(8)));
+        for (int m = 0; m < memberCount; ++m) {
+            const QString& member = m_userIds.at(static_cast<int>(m_random.bounded(m_userIds.size())));
+            if (!chat.members.contains(member)) {
+                chat.members.append(member);
+            }
+        }
+
+        qint64 timestamp = now - static_cast<qint64>(c) * 600 - static_cast<qint64>(m_workload.messagesPerChat) * 30;
+        chat.messages.reserve(static_cast<size_t>(m_workload.messagesPerChat));
+        for (int m = 0; m < m_workload.messagesPerChat; ++m) {
+            MockMessage message;
+            message.messageId = nextMessageId();
+            message.senderId = chat.members.isEmpty() ? QString() : chat.members.at(static_cast<int>(m_random.bounded(chat.members.size())));
+            const int words = 1 + static_cast<int>(m_random.bounded(20));
+            QStringList text;
+            for (int w = 0; w < words; ++w) {
+                text.append(kWords.at(static_cast<int>(m_random.bounded(kWords.size()))));
+            }
+            message.text = text.join(QLatin1Char(' '));
+            timestamp += 1 + static_cast<qint64>(m_random.bounded(30));
+            message.timestamp = timestamp;
+            chat.messages.push_back(message);
+        }
+        m_chatIndexById.insert(chat.chatId, m_chats.size());
+        m_chats.append(chat);
+    }
+}
+
+void MockServer::onNewConnection()
+{
+    while (QWebSocket* socket = m_server->nextPendingConnection()) {
+        Session session;
+        session.socket = socket;
+        m_sessions.insert(socket, session);
+        connect(socket, &QWebSocket::textMessageReceived, this, [this, socket](const QString& text) { onTextFrame(socket, text); });
+        connect(socket, &QWebSocket::binaryMessageReceived, this, [this, socket](const QByteArray& frame) { onBinaryFrame(socket, frame); });
+        connect(socket, &QWebSocket::disconnected, this, [this, socket]() { onDisconnected(socket); });
+    }
+}
+
+void MockServer::onTextFrame(QWebSocket* socket, const QString& text)
+{
+    auto it = m_sessions.find(socket);
+    const QJsonDocument doc = QJsonDocument::fromJson(text.toUtf8());
+    if (it == m_sessions.end() || !doc.isObject()) {
+        return;
+    }
+    handleFrame(*it, doc.object());
+}
+
+void MockServer::onBinaryFrame(QWebSocket* socket, const QByteArray& frame)
+{
+    auto it = m_sessions.find(socket);
+    if (it == m_sessions.end() || frame.isEmpty()) {
+        return;
+    }
+    relayVoice(*it, frame);
+}
+
+void MockServer::onDisconnected(QWebSocket* socket)
+{
+    const Session session = m_sessions.take(socket);
+    socket->deleteLater();
+    if (!session.voiceChatId.isEmpty()) {
+        broadcastVoiceState();
+    }
+}
+
+void MockServer::handleFrame(Session& session, const QJsonObject& frame)
+{
+    const QString type = frame.value(QStringLiteral("type")).toString();
+    if (type == QStringLiteral("login_with_password") || type == QStringLiteral("register")) {
+        handleLogin(session, frame, QStringLiteral("me_") + frame.value(QStringLiteral("username")).toString());
+    } else if (type == QStringLiteral("reconnect")) {
+        handleLogin(session, frame, frame.value(QStringLiteral("userId")).toString());
+    } else if (session.userId.isEmpty()) {
+        sendFrame(session, QJsonObject{
+            {QStringLiteral("type"), QStringLiteral("error")},
+            {QStringLiteral("message"), QStringLiteral("Not authenticated.")},
+        });
+    } else if (type == QStringLiteral("message")) {
+        handleMessage(session, frame);
+    } else if (type == QStringLiteral("get_history")) {
+        handleHistoryRequest(session, frame);
+    } else if (type == QStringLiteral("message_seen") || type == QStringLiteral("message_seen_batch")) {
+        QJsonArray ids = frame.value(QStringLiteral("messageIds")).toArray();
+        if (ids.isEmpty()) {
+            ids.append(frame.value(QStringLiteral("messageId")));
+        }
+        for (const QJsonValue& id : ids) {
+            broadcast(QJsonObject{
+                {QStringLiteral("type"), QStringLiteral("message_seen_update")},
+                {QStringLiteral("chatId"), frame.value(QStringLiteral("chatId"))},
+                {QStringLiteral("messageId"), id},
+                {QStringLiteral("userId"), session.userId},
+            });
+        }
+    } else if (type == QStringLiteral("edit_message")) {
+        broadcast(QJsonObject{
+            {QStringLiteral("type"), QStringLiteral("message_updated")},
+            {QStringLiteral("chatId"), frame.value(QStringLiteral("chatId"))},
+            {QStringLiteral("messageId"), frame.value(QStringLiteral("messageId"))},
+            {QStringLiteral("newContent"), frame.value(QStringLiteral("newContent"))},
+            {QStringLiteral("editedAt"), static_cast<double>(nowSecs())},
+            {QStringLiteral("clientMessageId"), frame.value(QStringLiteral("clientMessageId"))},
+        });
+    } else if (type == QStringLiteral("delete_message")) {
+        broadcast(QJsonObject{
+            {QStringLiteral("type"), QStringLiteral("message_deleted")},
+            {QStringLiteral("chatId"), frame.value(QStringLiteral("chatId"))},
+            {QStringLiteral("messageId"), frame.value(QStringLiteral("messageId"))},
+            {QStringLiteral("clientMessageId"), frame.value(QStringLiteral("clientMessageId"))},
+        });
+    } else if (type == QStringLiteral("voice_start") || type == QStringLiteral("voice_join") || type == QStringLiteral("voice_leave")) {
+        handleVoice(session, type, frame.value(QStringLiteral("chatId")).toString());
+    }
+    // typing, pins, channels and account management are accepted and ignored.
+}
+
+void MockServer::handleLogin(Session& session, const QJsonObject& frame, const QString& userId)
+{
+    if (userId.isEmpty()) {
+        sendFrame(session, QJsonObject{
+            {QStringLiteral("type"), QStringLiteral("auth_failed")},
+            {QStringLiteral("message"), QStringLiteral("Missing user.")},
+        });
+        return;
+    }
+    session.userId = userId;
+    if (!m_userIds.contains(userId)) {
+        m_userIds.prepend(userId);
+        for (MockChat& chat : m_chats) {
+            chat.members.prepend(userId);
+        }
+    }
+    m_onlineUsers.insert(userId);
+
+    const QJsonArray features{QStringLiteral("message_seen_batch"), QStringLiteral("client_message_id")};
+    sendFrame(session, QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("login_success")},
+        {QStringLiteral("user"), QJsonObject{
+            {QStringLiteral("userId"), userId},
+            {QStringLiteral("username"), userId},
+            {QStringLiteral("online"), true},
+        }},
+        {QStringLiteral("token"), QStringLiteral("mock-token-") + userId},
+        {QStringLiteral("expiresAt"), static_cast<double>(nowSecs() + 30 * 24 * 3600)},
+        {QStringLiteral("features"), features},
+    });
+
+    sendFrame(session, QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("user_list_update")},
+        {QStringLiteral("users"), usersJson()},
+        {QStringLiteral("online"), onlineJson()},
+    });
+
+    const QJsonObject since = frame.value(QStringLiteral("since")).toObject();
+    QJsonArray chats;
+    for (const MockChat& chat : m_chats) {
+        if (since.isEmpty()) {
+            chats.append(chatJson(chat, 0, kInitialMessagesPerChat));
+        } else if (since.contains(chat.chatId)) {
+            chats.append(chatJson(chat, static_cast<qint64>(since.value(chat.chatId).toDouble()), -1));
+        } else {
+            chats.append(chatJson(chat, 0, kInitialMessagesPerChat));
+        }
+    }
+    QJsonObject history{
+        {QStringLiteral("type"), QStringLiteral("chat_history")},
+        {QStringLiteral("chats"), chats},
+    };
+    if (!since.isEmpty()) {
+        history.insert(QStringLiteral("delta"), true);
+    }
+    sendFrame(session, history);
+}
+
+void MockServer::handleMessage(Session& session, const QJsonObject& frame)
+{
+    const QString chatId = frame.value(QStringLiteral("chatId")).toString();
+    const auto index = m_chatIndexById.constFind(chatId);
+    if (index == m_chatIndexById.constEnd()) {
+        sendFrame(session, QJsonObject{
+            {QStringLiteral("type"), QStringLiteral("error")},
+            {QStringLiteral("message"), QStringLiteral("Unknown chat.")},
+            {QStringLiteral("clientMessageId"), frame.value(QStringLiteral("clientMessageId"))},
+        });
+        return;
+    }
+    const QJsonObject content = frame.value(QStringLiteral("content")).toObject();
+    MockMessage message;
+    message.messageId = nextMessageId();
+    message.senderId = session.userId;
+    message.text = content.value(QStringLiteral("text")).toString();
+    message.timestamp = nowSecs();
+    m_chats[*index].messages.push_back(message);
+
+    QJsonObject echo = messageJson(chatId, message, frame.value(QStringLiteral("clientMessageId")).toString());
+    // Attachments and replies are echoed back as sent.
+    echo.insert(QStringLiteral("content"), content);
+    echo.insert(QStringLiteral("replyToId"), frame.value(QStringLiteral("replyToId")));
+    broadcast(echo);
+}
+
+void MockServer::handleHistoryRequest(Session& session, const QJsonObject& frame)
+{
+    const auto index = m_chatIndexById.constFind(frame.value(QStringLiteral("chatId")).toString());
+    if (index == m_chatIndexById.constEnd()) {
+        return;
+    }
+    const MockChat& chat = m_chats.at(*index);
+    const qint64 before = static_cast<qint64>(frame.value(QStringLiteral("before")).toDouble());
+    const auto end = before <= 0 ? chat.messages.end()
+                                 : std::lower_bound(chat.messages.begin(), chat.messages.end(), before, [](const MockMessage& m, qint64 ts) {
+                                       return m.timestamp < ts;
+                                   });
+    const auto begin = (end - chat.messages.begin() > kHistoryPageSize) ? end - kHistoryPageSize : chat.messages.begin();
+
+    QJsonArray messages;
+    for (auto it = begin; it != end; ++it) {
+        messages.append(messageJson(chat.chatId, *it));
+    }
+    // A page is a chat stub without metadata, like the real server sends.
+    sendFrame(session, QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("chat_history")},
+        {QStringLiteral("chats"), QJsonArray{QJsonObject{
+            {QStringLiteral("chatId"), chat.chatId},
+            {QStringLiteral("messages"), messages},
+        }}},
+    });
+}
+
+void MockServer::handleVoice(Session& session, const QString& type, const QString& chatId)
+{
+    session.voiceChatId = (type == QStringLiteral("voice_leave")) ? QString() : chatId;
+    broadcastVoiceState();
+}
+
+void MockServer::relayVoice(Session& from, const QByteArray& pcm)
+{
+    if (pcm.isEmpty() || from.voiceChatId.isEmpty()) {
+        return;
+    }
+    const auto frameFor = [&pcm](const QString& userId) {
+        const QByteArray id = userId.toUtf8().left(255);
+        QByteArray frame;
+        frame.reserve(1 + id.size() + pcm.size());
+        frame.append(static_cast<char>(id.size()));
+        frame.append(id);
+        frame.append(pcm);
+        return frame;
+    };
+    const QByteArray relayed = frameFor(from.userId);
+    for (Session& session : m_sessions) {
+        if (session.socket != from.socket && session.voiceChatId == from.voiceChatId) {
+            session.socket->sendBinaryMessage(relayed);
+        }
+    }
+    if (m_workload.voiceEcho) {
+        from.socket->sendBinaryMessage(frameFor(QStringLiteral("echo_bot")));
+    }
+}
+
+void MockServer::sendFrame(Session& session, const QJsonObject& frame)
+{
+    session.socket->sendTextMessage(QString::fromUtf8(QJsonDocument(frame).toJson(QJsonDocument::Compact)));
+}
+
+void MockServer::broadcast(const QJsonObject& frame)
+{
+    for (Session& session : m_sessions) {
+        if (!session.userId.isEmpty()) {
+            sendFrame(session, frame);
+        }
+    }
+}
+
+void MockServer::broadcastVoiceState()
+{
+    QHash<QString, QJsonArray> participantsByChat;
+    for (const Session& session : m_sessions) {
+        if (!session.voiceChatId.isEmpty()) {
+            participantsByChat[session.voiceChatId].append(session.userId);
+        }
+    }
+    QJsonObject active;
+    for (auto it = participantsByChat.constBegin(); it != participantsByChat.constEnd(); ++it) {
+        active.insert(it.key(), QJsonObject{{QStringLiteral("participants"), it.value()}});
+    }
+    broadcast(QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("voice_chat_update")},
+        {QStringLiteral("activeVoiceChats"), active},
+    });
+}
+
+void MockServer::emitBurstMessage()
+{
+    if (m_chats.isEmpty()) {
+        return;
+    }
+    MockChat& chat = m_chats[static_cast<int>(m_random.bounded(m_chats.size()))];
+    if (chat.members.isEmpty()) {
+        return;
+    }
+    MockMessage message;
+    message.messageId = nextMessageId();
+    message.senderId = chat.members.at(static_cast<int>(m_random.bounded(chat.members.size())));
+    message.text = kWords.at(static_cast<int>(m_random.bounded(kWords.size())));
+    message.timestamp = nowSecs();
+    chat.messages.push_back(message);
+    broadcast(messageJson(chat.chatId, message));
+}
+
+void MockServer::emitPresenceChange()
+{
+    if (m_userIds.isEmpty()) {
+        return;
+    }
+    const QString& userId = m_userIds.at(static_cast<int>(m_random.bounded(m_userIds.size())));
+    const bool online = !m_onlineUsers.contains(userId);
+    if (online) {
+        m_onlineUsers.insert(userId);
+    } else {
+        m_onlineUsers.remove(userId);
+    }
+    broadcast(QJsonObject{
+        {QStringLiteral("type"), QStringLiteral("presence_update")},
+        {QStringLiteral("userId"), userId},
+        {QStringLiteral("online"), online},
+    });
+}
+
+QJsonObject MockServer::messageJson(const QString& chatId, const MockMessage& message, const QString& clientMessageId) const
+{
+    QJsonObject obj{
+        {QStringLiteral("type"), QStringLiteral("message")},
+        {QStringLiteral("messageId"), message.messageId},
+        {QStringLiteral("chatId"), chatId},
+        {QStringLiteral("senderId"), message.senderId},
+        {QStringLiteral("senderName"), message.senderId},
+        {QStringLiteral("content"), QJsonObject{
+            {QStringLiteral("text"), message.text},
+            {QStringLiteral("file"), QJsonValue::Null},
+            {QStringLiteral("theme"), QJsonValue::Null},
+        }},
+        {QStringLiteral("timestamp"), static_cast<double>(message.timestamp)},
+    };
+    if (!clientMessageId.isEmpty()) {
+        obj.insert(QStringLiteral("clientMessageId"), clientMessageId);
+    }
+    return obj;
+}
+
+QJsonObject MockServer::chatJson(const MockChat& chat, qint64 since, int limit) const
+{
+    // Inclusive: the cursor is a whole second, and messages sharing it may
+    // not all have reached the client.
+    auto begin = std::lower_bound(chat.messages.begin(), chat.messages.end(), since, [](const MockMessage& m, qint64 ts) {
+        return m.timestamp < ts;
+    });
+    if (limit >= 0 && chat.messages.end() - begin > limit) {
+        begin = chat.messages.end() - limit;
+    }
+    QJsonArray messages;
+    for (auto it = begin; it != chat.messages.end(); ++it) {
+        messages.append(messageJson(chat.chatId, *it));
+    }
+    return QJsonObject{
+        {QStringLiteral("chatId"), chat.chatId},
+        {QStringLiteral("chatName"), chat.chatName},
+        {QStringLiteral("chatType"), chat.chatType},
+        {QStringLiteral("members"), QJsonArray::fromStringList(chat.members)},
+        {QStringLiteral("messages"), messages},
+    };
+}
+
+QJsonArray MockServer::usersJson() const
+{
+    QJsonArray users;
+    for (const QString& userId : m_userIds) {
+        users.append(QJsonObject{
+            {QStringLiteral("userId"), userId},
+            {QStringLiteral("username"), userId},
+        });
+    }
+    return users;
+}
+
+QJsonArray MockServer::onlineJson() const
+{
+    QJsonArray online;
+    for (const QString& userId : m_onlineUsers) {
+        online.append(userId);
+    }
+    return online;
+}
+
+QString MockServer::nextMessageId()
+{
+    return QStringLiteral("m%1").arg(m_nextMessageId++);
+}
+
+qint64 MockServer::nowSecs()
+{
+    return QDateTime::currentSecsSinceEpoch();
+}
@@ -0,0 +1,102 @@
+#ifndef MOCKSERVER_H
+#define MOCKSERVER_H
+
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QRandomGenerator>
+#include <QSet>
+#include <QStringList>
+
+#include <vector>
+
+class QTimer;
+class QWebSocket;
+class QWebSocketServer;
+
+// Headless stand-in for the Noveo websocket endpoint. Implements the subset
+// of the protocol the desktop client uses, over JSON text frames. All data
+// is synthetic and generated from a fixed seed so runs are reproducible.
+class MockServer : public QObject
+{
+    Q_OBJECT
+public:
+    struct Workload {
+        int chats = 50;
+        int messagesPerChat = 200;
+        int users = 100;
+        double burstMessagesPerSec = 0.0; // Messages from synthetic users.
+        double presenceChangesPerSec = 0.0;
+        bool voiceEcho = false; // Loop voice frames back to the sender.
+        quint32 seed = 1;
+    };
+
+    explicit MockServer(const Workload& workload, QObject* parent = nullptr);
+
+    bool listen(quint16 port);
+
+private:
+    struct Session {
+        QWebSocket* socket = nullptr;
+        QString userId;
+        QString voiceChatId;
+    };
+
+    struct MockMessage {
+        QString messageId;
+        QString senderId;
+        QString text;
+        qint64 timestamp = 0;
+    };
+
+    struct MockChat {
+        QString chatId;
+        QString chatName;
+        QString chatType;
+        QStringList members;
+        std::vector<MockMessage> messages; // Oldest first.
+    };
+
+    void generateCorpus();
+    void onNewConnection();
+    void onTextFrame(QWebSocket* socket, const QString& text);
+    void onBinaryFrame(QWebSocket* socket, const QByteArray& frame);
+    void handleFrame(Session& session, const QJsonObject& frame);
+    void onDisconnected(QWebSocket* socket);
+
+    void handleLogin(Session& session, const QJsonObject& frame, const QString& userId);
+    void handleMessage(Session& session, const QJsonObject& frame);
+    void handleHistoryRequest(Session& session, const QJsonObject& frame);
+    void handleVoice(Session& session, const QString& type, const QString& chatId);
+    void relayVoice(Session& from, const QByteArray& pcm);
+
+    void sendFrame(Session& session, const QJsonObject& frame);
+    void broadcast(const QJsonObject& frame);
+    void broadcastVoiceState();
+
+    void emitBurstMessage();
+    void emitPresenceChange();
+
+    QJsonObject messageJson(const QString& chatId, const MockMessage& message, const QString& clientMessageId = QString()) const;
+    QJsonObject chatJson(const MockChat& chat, qint64 since, int limit) const;
+    QJsonArray usersJson() const;
+    QJsonArray onlineJson() const;
+    QString nextMessageId();
+    static qint64 nowSecs();
+
+    Workload m_workload;
+    QRandomGenerator m_random;
+    QWebSocketServer* m_server = nullptr;
+    QTimer* m_burstTimer = nullptr;
+    QTimer* m_presenceTimer = nullptr;
+    QHash<QWebSocket*, Session> m_sessions;
+    QList<MockChat> m_chats;
+    QHash<QString, int> m_chatIndexById;
+    QStringList m_userIds;
+    QSet<QString> m_onlineUsers;
+    quint64 m_nextMessageId = 1;
+};
+
+#endif // MOCKSERVER_H
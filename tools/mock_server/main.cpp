@@ -0,0 +1,57 @@
+#include "MockHttpServer.h"
+#include "MockServer.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTextStream>
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("noveo-mock-server"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Headless Noveo server for load and regression runs."));
+    parser.addHelpOption();
+    const QCommandLineOption portOption(QStringLiteral("port"), QStringLiteral("WebSocket port."), QStringLiteral("port"), QStringLiteral("8090"));
+    const QCommandLineOption httpPortOption(QStringLiteral("http-port"), QStringLiteral("HTTP upload port."), QStringLiteral("port"), QStringLiteral("8091"));
+    const QCommandLineOption chatsOption(QStringLiteral("chats"), QStringLiteral("Number of chats."), QStringLiteral("n"), QStringLiteral("50"));
+    const QCommandLineOption messagesOption(QStringLiteral("messages"), QStringLiteral("Messages per chat."), QStringLiteral("n"), QStringLiteral("200"));
+    const QCommandLineOption usersOption(QStringLiteral("users"), QStringLiteral("Number of synthetic users."), QStringLiteral("n"), QStringLiteral("100"));
+    const QCommandLineOption burstOption(QStringLiteral("burst-rate"), QStringLiteral("Incoming messages per second."), QStringLiteral("rate"), QStringLiteral("0"));
+    const QCommandLineOption presenceOption(QStringLiteral("presence-rate"), QStringLiteral("Presence changes per second."), QStringLiteral("rate"), QStringLiteral("0"));
+    const QCommandLineOption seedOption(QStringLiteral("seed"), QStringLiteral("Corpus random seed."), QStringLiteral("seed"), QStringLiteral("1"));
+    const QCommandLineOption voiceEchoOption(QStringLiteral("voice-echo"), QStringLiteral("Echo voice frames back to the sender."));
+    parser.addOptions({portOption, httpPortOption, chatsOption, messagesOption, usersOption, burstOption,
+                       presenceOption, seedOption, voiceEchoOption});
+    parser.process(app);
+
+    MockServer::Workload workload;
+    workload.chats = qMax(0, parser.value(chatsOption).toInt());
+    workload.messagesPerChat = qMax(0, parser.value(messagesOption).toInt());
+    workload.users = qMax(1, parser.value(usersOption).toInt());
+    workload.burstMessagesPerSec = parser.value(burstOption).toDouble();
+    workload.presenceChangesPerSec = parser.value(presenceOption).toDouble();
+    workload.seed = parser.value(seedOption).toUInt();
+    workload.voiceEcho = parser.isSet(voiceEchoOption);
+
+    QTextStream out(stdout);
+    MockServer server(workload);
+    const quint16 port = static_cast<quint16>(parser.value(portOption).toUInt());
+    if (!server.listen(port)) {
+        out << "Could not listen on WebSocket port " << port << "\n";
+        return 1;
+    }
+    MockHttpServer http;
+    const quint16 httpPort = static_cast<quint16>(parser.value(httpPortOption).toUInt());
+    if (!http.listen(httpPort)) {
+        out << "Could not listen on HTTP port " << httpPort << "\n";
+        return 1;
+    }
+
+    out << "Mock server ready. Point the client at it with:\n"
+        << "  NOVEO_API_BASE_URL=http://127.0.0.1:" << httpPort
+        << " NOVEO_WS_URL=ws://127.0.0.1:" << port << "\n";
+    out.flush();
+    return app.exec();
+}